@@ -0,0 +1,165 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file Benchmarks.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_BENCHMARKS_H
+#define GMIC_QT_BENCHMARKS_H
+
+#include <iosfwd>
+
+class FiltersModel;
+class QBuffer;
+class QByteArray;
+class QString;
+class QStringList;
+
+/*
+ * Each benchmark prints the timings of a component of the plugin. Checks
+ * compare the results of a component with a reference implementation and
+ * return the number of differences.
+ */
+
+class CimgzDecoderBenchmark {
+public:
+  /**
+   * @brief Print the time needed to decompress the bundled stdlib, 100 times
+   */
+  static void run(std::ostream & out);
+};
+
+class FiltersSearchIndexBenchmark {
+public:
+  /**
+   * @brief Print the latency of each keystroke while typing a few queries,
+   *        with the index and with FiltersModel::Filter::matchKeywords()
+   */
+  static void run(std::ostream & out);
+
+  /**
+   * @brief Compare the filters found by the index with the ones matching
+   *        the same keywords, for each keystroke of a few queries
+   */
+  static int check(std::ostream & out);
+
+private:
+  static const QStringList & queries();
+};
+
+class FiltersViewBenchmark {
+public:
+  /**
+   * @brief Print the time needed to update the filters tree on each keystroke
+   *        of a few queries, by rebuilding it and by hiding rows
+   */
+  static void run(std::ostream & out);
+};
+
+class GmicInterpreterPoolBenchmark {
+public:
+  /**
+   * @brief Print the latency of a few cheap filters run by a FilterSyncRunner,
+   *        with a new interpreter for each run and with the interpreters pool
+   */
+  static void run(std::ostream & out);
+};
+
+class HtmlTranslatorBenchmark {
+public:
+  /**
+   * @brief Print the time needed to compute the plain texts of the names and
+   *        labels of the stdlib filters, with and without QTextDocument
+   */
+  static void run(std::ostream & out);
+
+  /**
+   * @brief Compare the plain texts decoded without QTextDocument with the
+   *        ones given by QTextDocument
+   */
+  static int check(std::ostream & out);
+
+private:
+  static QStringList stdlibTexts(int & lineCount);
+};
+
+class ImageConverterBenchmark {
+public:
+  /**
+   * @brief Print the throughput of every kernel set supported by the CPU, for each pixel format,
+   *        then the scaling of whole image conversions from 1 to 32 threads
+   */
+  static void run(std::ostream & out);
+
+  /**
+   * @brief Compare the bytes given by every kernel set with the ones of the scalar
+   *        kernels, for values needing clamping, infinities and NaN
+   */
+  static int check(std::ostream & out);
+};
+
+class FilterParametersWidgetBenchmark {
+public:
+  /**
+   * @brief Print the time needed to build the parameters of each filter of the
+   *        stdlib, the first time and once the parsed parameters are cached
+   */
+  static void run(std::ostream & out);
+};
+
+class FiltersModelReaderBenchmark {
+public:
+  /**
+   * @brief Print the time needed to load the filters definitions, by both parsers,
+   *        with and without index
+   */
+  static void run(std::ostream & out);
+
+  /**
+   * @brief Compare the filters read by the parser with the ones read by the
+   *        previous, regexps based, parser
+   */
+  static int check(std::ostream & out);
+
+private:
+  static void parseFiltersSourceWithRegExps(FiltersModel & model, QByteArray & stdlibArray);
+  static int countDifferences(const FiltersModel & reference, const FiltersModel & model, std::ostream & out);
+  static QString readBufferLine(QBuffer & buffer);
+};
+
+class ParametersCacheBenchmark {
+public:
+  /**
+   * @brief Print the time needed to load and save the parameters of 1000 and
+   *        10000 filters, from a legacy file, then with the journal
+   */
+  static void run(std::ostream & out);
+};
+
+class PreviewImageBenchmark {
+public:
+  /**
+   * @brief Print the time taken to compose 2, 3, 4 and more outputs, natively and by gui_preview
+   */
+  static void run(std::ostream & out);
+};
+
+#endif // GMIC_QT_BENCHMARKS_H
@@ -0,0 +1,64 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file CimgzDecoderBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <ostream>
+#include "CimgzDecoder.h"
+#include "gmic.h"
+
+void CimgzDecoderBenchmark::run(std::ostream & out)
+{
+  gmic_image<char> stdlib = gmic::decompress_stdlib();
+  cimg_library::CImg<unsigned char> bytes(reinterpret_cast<unsigned char *>(stdlib.data()), stdlib.size(), 1, 1, 1, true);
+  cimg_library::CImg<unsigned char> serialized = bytes.get_serialize(true);
+  const QByteArray cimgz(reinterpret_cast<const char *>(serialized.data()), int(serialized.size()));
+  const int Runs = 100;
+  out << "Bundled stdlib: " << stdlib.size() / 1024 << " KiB, " << cimgz.size() / 1024 << " KiB compressed, " << Runs << " runs\n";
+
+  QElapsedTimer timer;
+  timer.start();
+  bool ok = true;
+  for (int run = 0; run < Runs; ++run) {
+    ok = ok && (CimgzDecoder::decompress(cimgz).size() == int(stdlib.size()));
+  }
+  out << "  CimgzDecoder::decompress()    " << timer.nsecsElapsed() / (1000000.0 * Runs) << " ms" << (ok ? "" : " (FAILED)") << "\n";
+
+  timer.start();
+  for (int run = 0; run < Runs; ++run) {
+    CimgzDecoder decoder;
+    for (int offset = 0; offset < cimgz.size(); offset += 16 * 1024) {
+      decoder.feed(cimgz.constData() + offset, qMin(16 * 1024, cimgz.size() - offset));
+    }
+    ok = ok && (decoder.takeResult().size() == int(stdlib.size()));
+  }
+  out << "  CimgzDecoder, 16 KiB chunks   " << timer.nsecsElapsed() / (1000000.0 * Runs) << " ms" << (ok ? "" : " (FAILED)") << "\n";
+
+  timer.start();
+  for (int run = 0; run < Runs; ++run) {
+    cimg_library::CImgList<unsigned char>::get_unserialize(serialized);
+  }
+  out << "  CImgList<>::get_unserialize() " << timer.nsecsElapsed() / (1000000.0 * Runs) << " ms" << std::endl;
+}
@@ -0,0 +1,68 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FilterParametersWidgetBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <QWidget>
+#include <algorithm>
+#include <ostream>
+#include "FilterParameters/FilterParametersWidget.h"
+#include "FilterParameters/ParameterWidgetPool.h"
+#include "FilterSelector/FiltersModel.h"
+#include "FilterSelector/FiltersModelReader.h"
+#include "GmicStdlib.h"
+
+void FilterParametersWidgetBenchmark::run(std::ostream & out)
+{
+  if (GmicStdLib::Array.isEmpty()) {
+    GmicStdLib::loadStdLib();
+  }
+  FiltersModel model;
+  FiltersModelReader(model).parseFiltersDefinitions(GmicStdLib::Array, GmicStdLib::Key);
+  QWidget window; // Never shown
+  FilterParametersWidget widget(&window);
+  QElapsedTimer timer;
+  const char * passes[] = {"first build", "parameters cached"};
+  for (const char * pass : passes) {
+    qint64 total = 0;
+    qint64 longest = 0;
+    QString longestFilter;
+    for (const FiltersModel::Filter & filter : model) {
+      timer.start();
+      widget.build(filter.name(), filter.hash(), filter.parameters(), QList<QString>(), QList<int>());
+      const qint64 elapsed = timer.nsecsElapsed();
+      total += elapsed;
+      if (elapsed > longest) {
+        longest = elapsed;
+        longestFilter = filter.plainText();
+      }
+    }
+    out << "Parameters widget, " << pass << ": " << total / 1000000.0 / std::max<size_t>(1, model.filterCount()) << " ms per filter, " << longest / 1000000.0
+        << " ms max (" << longestFilter.toStdString() << ")\n";
+  }
+  const ParameterWidgetPool * pool = ParameterWidgetPool::get(&widget);
+  out << "  " << model.filterCount() << " filters, " << pool->createdWidgetCount() << " pooled widgets created, " << pool->reusedWidgetCount() << " reused" << std::endl;
+}
@@ -0,0 +1,308 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersModelReaderBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegExp>
+#include <QString>
+#include <QVector>
+#include <cstdlib>
+#include <ostream>
+#include "FilterSelector/FiltersModel.h"
+#include "FilterSelector/FiltersModelReader.h"
+#include "Globals.h"
+#include "GmicStdlib.h"
+#include "LanguageSettings.h"
+#include "Utils.h"
+
+void FiltersModelReaderBenchmark::run(std::ostream & out)
+{
+  if (GmicStdLib::Array.isEmpty()) {
+    GmicStdLib::loadStdLib();
+  }
+  // The rc directory of the benchmarks is a temporary one
+  QFile::remove(QString("%1%2").arg(GmicQt::path_rc(true), FILTERS_INDEX_FILENAME));
+  FiltersModel model;
+  FiltersModelReader reader(model);
+  QElapsedTimer timer;
+
+  FiltersModel referenceModel;
+  timer.start();
+  parseFiltersSourceWithRegExps(referenceModel, GmicStdLib::Array);
+  const qint64 regexpParsing = timer.nsecsElapsed();
+
+  timer.start();
+  reader.parseFiltersSource(GmicStdLib::Array);
+  const qint64 parsing = timer.nsecsElapsed();
+  model.clear();
+
+  timer.start();
+  reader.parseFiltersDefinitions(GmicStdLib::Array, GmicStdLib::Key);
+  const qint64 cold = timer.nsecsElapsed();
+  model.clear();
+
+  timer.start();
+  reader.parseFiltersDefinitions(GmicStdLib::Array, GmicStdLib::Key);
+  const qint64 warm = timer.nsecsElapsed();
+
+  out << "Filters definitions: " << GmicStdLib::Array.size() / 1024 << " KiB, " << model.filterCount() << " filters\n";
+  out << "  parsing (regexps)        " << regexpParsing / 1000000.0 << " ms\n";
+  out << "  parsing (scanner)        " << parsing / 1000000.0 << " ms\n";
+  out << "  cold (parsing + index)   " << cold / 1000000.0 << " ms\n";
+  out << "  warm (mapped index)      " << warm / 1000000.0 << " ms" << std::endl;
+}
+
+int FiltersModelReaderBenchmark::check(std::ostream & out)
+{
+  if (GmicStdLib::Array.isEmpty()) {
+    GmicStdLib::loadStdLib();
+  }
+  FiltersModel referenceModel;
+  parseFiltersSourceWithRegExps(referenceModel, GmicStdLib::Array);
+  FiltersModel model;
+  FiltersModelReader(model).parseFiltersSource(GmicStdLib::Array);
+  const int differences = countDifferences(referenceModel, model, out);
+  out << "Filters definitions: " << referenceModel.filterCount() << " filters, " << differences << " filter(s) differ from regexps parsing" << std::endl;
+  return differences;
+}
+
+/*
+ * The parser used before the single-pass scanner of FiltersModelReader, as a reference
+ */
+void FiltersModelReaderBenchmark::parseFiltersSourceWithRegExps(FiltersModel & model, QByteArray & stdlibArray)
+{
+  FiltersModelReader reader(model);
+  QBuffer stdlib(&stdlibArray);
+  stdlib.open(QBuffer::ReadOnly | QBuffer::Text);
+  QList<QString> filterPath;
+
+  QString language = LanguageSettings::configuredTranslator();
+  if (language.isEmpty()) {
+    language = "void";
+  }
+
+  // Use _en locale if no localization for the language is found.
+  QByteArray localePrefix = QString("#@gui_%1").arg(language).toLocal8Bit();
+  if (!FiltersModelReader::textIsPrecededBySpacesInSomeLineOfArray(localePrefix, stdlibArray)) {
+    language = "en";
+  }
+
+  QString buffer = readBufferLine(stdlib);
+  QString line;
+
+  QRegExp folderRegexpNoLanguage("^\\s*#@gui[ ][^:]+$");
+  QRegExp folderRegexpLanguage(QString("^\\s*#@gui_%1[ ][^:]+$").arg(language));
+
+  QRegExp filterRegexpNoLanguage("^\\s*#@gui[ ][^:]+[ ]*:.*");
+  QRegExp filterRegexpLanguage(QString("^\\s*#@gui_%1[ ][^:]+[ ]*:.*").arg(language));
+
+  QRegExp hideCommandRegExp(QString("^\\s*#@gui_%1[ ]+hide\\((.*)\\)").arg(language));
+  QRegExp guiComment("^\\s*#@gui");
+  // Filter declared as tile-safe, with an optional halo (in pixels): #@gui_tiles(8)
+  QRegExp tilesRegExp("^\\s*#@gui_tiles(\\((\\d*)\\))?\\s*$");
+  QVector<QString> hiddenPaths;
+
+  const QChar WarningPrefix('!');
+  do {
+    line = buffer.trimmed();
+    if (guiComment.indexIn(line) == 0) {
+      if (hideCommandRegExp.exactMatch(line)) {
+        QString path = hideCommandRegExp.cap(1);
+        hiddenPaths.push_back(path);
+        buffer = readBufferLine(stdlib);
+      } else if (folderRegexpNoLanguage.exactMatch(line) || folderRegexpLanguage.exactMatch(line)) {
+        //
+        // A folder
+        //
+        QString folderName = line;
+        folderName.replace(QRegExp("^\\s*#@gui[_a-zA-Z]{0,3}[ ]"), "");
+
+        while (folderName.startsWith("_") && !filterPath.isEmpty()) {
+          folderName.remove(0, 1);
+          filterPath.pop_back();
+        }
+        while (folderName.startsWith("_")) {
+          folderName.remove(0, 1);
+        }
+        if (!folderName.isEmpty()) {
+          filterPath.push_back(folderName);
+        }
+        buffer = readBufferLine(stdlib);
+      } else if (filterRegexpNoLanguage.exactMatch(line) || filterRegexpLanguage.exactMatch(line)) {
+        //
+        // A filter
+        //
+        QString filterName = line;
+        filterName.replace(QRegExp("[ ]*:.*$"), "");
+        filterName.replace(QRegExp("^\\s*#@gui[_a-zA-Z]{0,3}[ ]"), "");
+        const bool warning = filterName.startsWith(WarningPrefix);
+        if (warning) {
+          filterName.remove(0, 1);
+        }
+
+        QString filterCommands = line;
+        filterCommands.replace(QRegExp("^\\s*#@gui[_a-zA-Z]{0,3}[ ][^:]+[ ]*:[ ]*"), "");
+
+        // Extract default input mode
+        GmicQt::InputMode defaultInputMode = GmicQt::UnspecifiedInputMode;
+        QRegExp reInputMode("\\s*:\\s*([xX.*+vViI-])\\s*$");
+        if (reInputMode.indexIn(filterCommands) != -1) {
+          QString mode = reInputMode.cap(1);
+          filterCommands.remove(reInputMode);
+          defaultInputMode = FiltersModelReader::symbolToInputMode(mode);
+        }
+
+        QList<QString> commands = filterCommands.split(",");
+        QString filterCommand = commands[0].trimmed();
+        if (commands.isEmpty()) {
+          commands.push_back("_none_");
+        }
+        if (commands.size() == 1) {
+          commands.push_back(commands.front());
+        }
+        QList<QString> preview = commands[1].trimmed().split("(");
+        float previewFactor = GmicQt::PreviewFactorAny;
+        bool accurateIfZoomed = true;
+        if (preview.size() >= 2) {
+          if (preview[1].endsWith("+")) {
+            accurateIfZoomed = true;
+            preview[1].chop(1);
+          } else {
+            accurateIfZoomed = false;
+          }
+          previewFactor = preview[1].replace(QRegExp("\\).*"), "").toFloat();
+        }
+        QString filterPreviewCommand = preview[0].trimmed();
+
+        //        FiltersTreeFilterItem * filterItem = new FiltersTreeFilterItem(filterName,
+        //                                                                       filterCommand,
+        //                                                                       filterPreviewCommand,
+        //                                                                       previewFactor,
+        //                                                                       accurateIfZoomed);
+        // filterItem->setWarningFlag(warning);
+
+        QString start = line;
+        start.replace(QRegExp("^\\s*"), "");
+        start.replace(QRegExp(" .*"), " :");
+        QRegExp startRegexp(QString("^\\s*%1").arg(start));
+
+        // Read parameters
+        QString parameters;
+        int tileHalo = -1;
+        do {
+          buffer = readBufferLine(stdlib);
+          if (startRegexp.indexIn(buffer) == 0) {
+            QString parameterLine = buffer;
+            parameterLine.replace(QRegExp("^\\s*#@gui[_a-zA-Z]{0,3}[ ]*:[ ]*"), "");
+            parameters += parameterLine;
+          } else if (tilesRegExp.exactMatch(buffer)) {
+            tileHalo = tilesRegExp.cap(2).toInt();
+          }
+        } while (!stdlib.atEnd()                               //
+                 && !folderRegexpNoLanguage.exactMatch(buffer) //
+                 && !folderRegexpLanguage.exactMatch(buffer)   //
+                 && !filterRegexpNoLanguage.exactMatch(buffer) //
+                 && !filterRegexpLanguage.exactMatch(buffer));
+
+        FiltersModel::Filter filter;
+        filter.setName(filterName);
+        filter.setCommand(filterCommand);
+        filter.setPreviewCommand(filterPreviewCommand);
+        filter.setDefaultInputMode(defaultInputMode);
+        filter.setPreviewFactor(previewFactor);
+        filter.setAccurateIfZoomed(accurateIfZoomed);
+        filter.setParameters(parameters);
+        filter.setPath(filterPath);
+        filter.setWarningFlag(warning);
+        filter.setTileHalo(tileHalo);
+        filter.build();
+        model.addFilter(filter);
+      } else {
+        buffer = readBufferLine(stdlib);
+      }
+    } else {
+      buffer = readBufferLine(stdlib);
+    }
+  } while (!buffer.isEmpty());
+
+  reader.removeHiddenPaths(hiddenPaths);
+}
+
+int FiltersModelReaderBenchmark::countDifferences(const FiltersModel & reference, const FiltersModel & model, std::ostream & out)
+{
+  int result = std::abs((int)reference.filterCount() - (int)model.filterCount());
+  for (const FiltersModel::Filter & filter : reference) {
+    if (!model.contains(filter.hash())) {
+      ++result;
+      continue;
+    }
+    const FiltersModel::Filter & other = model.getFilterFromHash(filter.hash());
+    if ((filter.path() != other.path()) || (filter.parameters() != other.parameters()) || (filter.previewFactor() != other.previewFactor()) ||
+        (filter.isAccurateIfZoomed() != other.isAccurateIfZoomed()) || (filter.isWarning() != other.isWarning()) || (filter.defaultInputMode() != other.defaultInputMode()) ||
+        (filter.tileHalo() != other.tileHalo())) {
+      out << "Filters parsers disagree on filter " << filter.name().toStdString() << "\n";
+      ++result;
+    }
+  }
+  return result;
+}
+
+QString FiltersModelReaderBenchmark::readBufferLine(QBuffer & buffer)
+{
+  // QBuffer::readline(max_size) may be very slow, in debug mode, when max_size
+  // is too big (e.g. 1MB). We read large lines in multiple calls.
+  QString result;
+  QString text;
+  QRegExp commentStart("^\\s*#");
+  do {
+    text = buffer.readLine(1024);
+    result.append(text);
+  } while (!text.isEmpty() && !text.endsWith("\n"));
+
+  // Merge comment lines ending with '\'
+  if (commentStart.indexIn(result) == 0) {
+    while (result.endsWith("\\\n")) {
+      QString nextLinePeek = buffer.peek(1024);
+      if (commentStart.indexIn(nextLinePeek) == -1) {
+        return result;
+      }
+      const QString nextCommentPrefix = commentStart.cap(0);
+      result.chop(2);
+      QString nextLine;
+      do {
+        text = buffer.readLine(1024);
+        nextLine.append(text);
+      } while (!text.isEmpty() && !text.endsWith("\n"));
+      int ignoreCount = nextCommentPrefix.length();
+      const int limit = nextLine.length() - nextLine.endsWith("\n");
+      while (ignoreCount < limit && nextLine[ignoreCount] <= ' ') {
+        ++ignoreCount;
+      }
+      result.append(nextLine.rightRef(nextLine.length() - ignoreCount));
+    }
+  }
+  return result;
+}
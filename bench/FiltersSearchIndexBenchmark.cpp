@@ -0,0 +1,118 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersSearchIndexBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <algorithm>
+#include <ostream>
+#include "Common.h"
+#include "FilterSelector/FavesModel.h"
+#include "FilterSelector/FiltersModel.h"
+#include "FilterSelector/FiltersModelReader.h"
+#include "FilterSelector/FiltersSearchIndex.h"
+#include "GmicStdlib.h"
+
+const QStringList & FiltersSearchIndexBenchmark::queries()
+{
+  static const QStringList result = {"blur", "sharpen", "black white", "colors curves", "deform", "frame", "noise", "lines", "xyz"};
+  return result;
+}
+
+void FiltersSearchIndexBenchmark::run(std::ostream & out)
+{
+  if (GmicStdLib::Array.isEmpty()) {
+    GmicStdLib::loadStdLib();
+  }
+  FiltersModel model;
+  FiltersModelReader(model).parseFiltersDefinitions(GmicStdLib::Array, GmicStdLib::Key);
+  FavesModel faves;
+  FiltersSearchIndex index;
+  QElapsedTimer timer;
+  timer.start();
+  index.build(model, faves);
+  const qint64 building = timer.nsecsElapsed();
+
+  int keystrokes = 0;
+  int differences = 0;
+  qint64 scanTotal = 0;
+  qint64 scanMax = 0;
+  qint64 indexTotal = 0;
+  qint64 indexMax = 0;
+  for (const QString & query : queries()) {
+    for (int length = 1; length <= query.size(); ++length) {
+      const QList<QString> keywords = query.left(length).split(QChar(' '), QT_SKIP_EMPTY_PARTS);
+      timer.start();
+      size_t scanCount = 0;
+      for (const FiltersModel::Filter & filter : model) {
+        scanCount += filter.matchKeywords(keywords);
+      }
+      const qint64 scan = timer.nsecsElapsed();
+      timer.start();
+      const size_t indexCount = index.search(keywords).size();
+      const qint64 indexed = timer.nsecsElapsed();
+      scanTotal += scan;
+      scanMax = std::max(scanMax, scan);
+      indexTotal += indexed;
+      indexMax = std::max(indexMax, indexed);
+      differences += (scanCount != indexCount);
+      ++keystrokes;
+    }
+  }
+  out << "Filters search: " << model.filterCount() << " filters, " << index._postings.size() << " trigrams, " << keystrokes << " keystrokes\n";
+  out << "  index building           " << building / 1000000.0 << " ms\n";
+  out << "  scan (matchKeywords)     " << scanTotal / 1000.0 / keystrokes << " us per keystroke, " << scanMax / 1000.0 << " us max\n";
+  out << "  trigram index            " << indexTotal / 1000.0 / keystrokes << " us per keystroke, " << indexMax / 1000.0 << " us max, " << differences
+      << " keystroke(s) with different matches" << std::endl;
+}
+
+int FiltersSearchIndexBenchmark::check(std::ostream & out)
+{
+  if (GmicStdLib::Array.isEmpty()) {
+    GmicStdLib::loadStdLib();
+  }
+  FiltersModel model;
+  FiltersModelReader(model).parseFiltersDefinitions(GmicStdLib::Array, GmicStdLib::Key);
+  FiltersSearchIndex index;
+  index.build(model, FavesModel());
+  int differences = 0;
+  for (const QString & query : queries()) {
+    for (int length = 1; length <= query.size(); ++length) {
+      const QList<QString> keywords = query.left(length).split(QChar(' '), QT_SKIP_EMPTY_PARTS);
+      std::vector<int> expected;
+      int entry = 0;
+      for (const FiltersModel::Filter & filter : model) {
+        if (filter.matchKeywords(keywords)) {
+          expected.push_back(entry);
+        }
+        ++entry;
+      }
+      if (index.search(keywords) != expected) {
+        out << "Search index and matchKeywords() disagree on \"" << query.left(length).toStdString() << "\"\n";
+        ++differences;
+      }
+    }
+  }
+  return differences;
+}
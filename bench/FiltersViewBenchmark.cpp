@@ -0,0 +1,117 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersViewBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QElapsedTimer>
+#include <QList>
+#include <QSet>
+#include <QStringList>
+#include <algorithm>
+#include <ostream>
+#include "Common.h"
+#include "FilterSelector/FavesModel.h"
+#include "FilterSelector/FiltersModel.h"
+#include "FilterSelector/FiltersModelReader.h"
+#include "FilterSelector/FiltersSearchIndex.h"
+#include "FilterSelector/FiltersView/FiltersView.h"
+#include "GmicStdlib.h"
+
+void FiltersViewBenchmark::run(std::ostream & out)
+{
+  if (GmicStdLib::Array.isEmpty()) {
+    GmicStdLib::loadStdLib();
+  }
+  FiltersModel model;
+  FiltersModelReader(model).parseFiltersDefinitions(GmicStdLib::Array, GmicStdLib::Key);
+  FiltersSearchIndex index;
+  index.build(model, FavesModel());
+  FiltersView view(nullptr);
+  QElapsedTimer timer;
+
+  const QStringList queries = {"blur", "sharpen", "black white", "colors curves", "deform", "frame", "noise", "lines", "xyz"};
+  QList<QList<QString>> keystrokes;
+  for (const QString & query : queries) {
+    for (int length = 1; length <= query.size(); ++length) {
+      keystrokes.push_back(query.left(length).split(QChar(' '), QT_SKIP_EMPTY_PARTS));
+    }
+    keystrokes.push_back(QList<QString>());
+  }
+
+  // Previous approach: clear the tree and add the matching filters
+  qint64 rebuildTotal = 0;
+  qint64 rebuildMax = 0;
+  qint64 rebuildItems = 0;
+  for (const QList<QString> & keywords : keystrokes) {
+    const std::vector<int> matches = index.search(keywords);
+    timer.start();
+    view.clear();
+    view.disableModel();
+    for (int entry : matches) {
+      const FiltersModel::Filter & filter = model.getFilterFromHash(index.hash(entry));
+      view.addFilter(filter.name(), filter.hash(), filter.path(), filter.isWarning());
+    }
+    view.sort();
+    view.enableModel();
+    if (!keywords.isEmpty()) {
+      view.expandAll();
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+    rebuildTotal += elapsed;
+    rebuildMax = std::max(rebuildMax, elapsed);
+    rebuildItems += view.itemCount();
+  }
+
+  // Persistent tree, hiding rows
+  view.clear();
+  view.disableModel();
+  for (const FiltersModel::Filter & filter : model) {
+    view.addFilter(filter.name(), filter.hash(), filter.path(), filter.isWarning());
+  }
+  view.sort();
+  view.enableModel();
+  qint64 hidingTotal = 0;
+  qint64 hidingMax = 0;
+  for (const QList<QString> & keywords : keystrokes) {
+    QSet<QString> hashes;
+    for (int entry : index.search(keywords)) {
+      hashes.insert(index.hash(entry));
+    }
+    timer.start();
+    if (keywords.isEmpty()) {
+      view.showAllFilters();
+    } else {
+      view.showOnlyFilters(hashes);
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+    hidingTotal += elapsed;
+    hidingMax = std::max(hidingMax, elapsed);
+  }
+
+  const int count = keystrokes.size();
+  out << "Filters view update: " << model.filterCount() << " filters, " << view.itemCount() << " tree items, " << count << " keystrokes\n";
+  out << "  rebuilding the tree      " << rebuildTotal / 1000000.0 / count << " ms per keystroke, " << rebuildMax / 1000000.0 << " ms max, " << rebuildItems / count
+      << " items created per keystroke\n";
+  out << "  hiding rows              " << hidingTotal / 1000000.0 / count << " ms per keystroke, " << hidingMax / 1000000.0 << " ms max, 0 items created per keystroke"
+      << std::endl;
+}
@@ -0,0 +1,87 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file GmicInterpreterPoolBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QElapsedTimer>
+#include <QString>
+#include <ostream>
+#include "FilterSyncRunner.h"
+#include "GmicInterpreterPool.h"
+#include "GmicStdlib.h"
+#include "gmic.h"
+
+namespace
+{
+qint64 averageRunDuration(const QString & command, const QString & arguments, bool pooled, int runs)
+{
+  const cimg_library::CImg<float> image(256, 256, 1, 4, 128.0f);
+  qint64 total = 0;
+  for (int run = 0; run < runs; ++run) {
+    if (!pooled) {
+      GmicInterpreterPool::clear(); // Each run builds its own interpreter
+    }
+    cimg_library::CImgList<float> images(image);
+    cimg_library::CImgList<char> imageNames(1);
+    cimg_library::CImg<char>::string("[Layer]").move_to(imageNames[0]);
+    FilterSyncRunner runner(nullptr, command, command, arguments, QString(), GmicQt::Quiet);
+    runner.swapImages(images);
+    runner.setImageNames(imageNames);
+    QElapsedTimer timer;
+    timer.start();
+    runner.run();
+    total += timer.nsecsElapsed();
+    if (runner.failed()) {
+      return -1;
+    }
+  }
+  return total / runs;
+}
+} // namespace
+
+void GmicInterpreterPoolBenchmark::run(std::ostream & out)
+{
+  if (GmicStdLib::Array.isEmpty()) {
+    GmicStdLib::loadStdLib();
+  }
+  if (!GmicInterpreterPool::isEnabled()) {
+    out << "Interpreter pool disabled by GMIC_QT_NO_INTERPRETER_POOL" << std::endl;
+    return;
+  }
+  const int Runs = 10;
+  const char * commands[][2] = {{"blur", "2"}, {"mirror", "x"}, {"sharpen", "100"}};
+  out << "Filter latency (ms), 256x256 RGBA image, " << Runs << " runs: command, without pool, with pool\n";
+  for (const auto & command : commands) {
+    const qint64 fresh = averageRunDuration(command[0], command[1], false, Runs);
+    averageRunDuration(command[0], command[1], true, 1); // Leaves an idle interpreter for the command
+    const qint64 pooled = averageRunDuration(command[0], command[1], true, Runs);
+    out << "  " << command[0] << " " << command[1] << "\t";
+    if ((fresh < 0) || (pooled < 0)) {
+      out << "FAILED\n";
+    } else {
+      out << fresh / 1e6 << "\t" << pooled / 1e6 << "\n";
+    }
+  }
+  out << "Interpreters created: " << GmicInterpreterPool::createdInterpreterCount() << std::endl;
+  GmicInterpreterPool::clear();
+}
@@ -0,0 +1,115 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file HtmlTranslatorBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QStringList>
+#include <ostream>
+#include "FilterTextTranslator.h"
+#include "GmicStdlib.h"
+#include "HtmlTranslator.h"
+
+void HtmlTranslatorBenchmark::run(std::ostream & out)
+{
+  int lineCount;
+  const QStringList texts = stdlibTexts(lineCount);
+  QElapsedTimer timer;
+  timer.start();
+  for (const QString & html : texts) {
+    HtmlTranslator::fromUtf8Escapes(HtmlTranslator::documentPlainText(html));
+  }
+  const qint64 textDocument = timer.nsecsElapsed();
+  HtmlTranslator::plainTexts().clear();
+  timer.start();
+  for (const QString & html : texts) {
+    HtmlTranslator::html2txt(html, true);
+  }
+  const qint64 cold = timer.nsecsElapsed();
+  timer.start();
+  for (int i = 0; i < lineCount; ++i) {
+    HtmlTranslator::html2txt(texts[i % texts.size()], true);
+  }
+  const qint64 memoized = timer.nsecsElapsed();
+
+  out << "Html to text: " << texts.size() << " distinct texts from " << lineCount << " #@gui lines\n";
+  out << "  QTextDocument                  " << textDocument / 1000000.0 << " ms\n";
+  out << "  html2txt()                     " << cold / 1000000.0 << " ms\n";
+  out << "  html2txt(), memoized           " << memoized / 1000000.0 << " ms for " << lineCount << " conversions" << std::endl;
+}
+
+int HtmlTranslatorBenchmark::check(std::ostream & out)
+{
+  int lineCount;
+  const QStringList texts = stdlibTexts(lineCount);
+  int decoded = 0;
+  int differences = 0;
+  for (const QString & html : texts) {
+    QString text;
+    if (HtmlTranslator::decodeInlineHtml(html, text)) {
+      ++decoded;
+      const QString reference = HtmlTranslator::documentPlainText(html);
+      if (text != reference) {
+        out << "Plain text of '" << html.toStdString() << "' is '" << text.toStdString() << "', QTextDocument gives '" << reference.toStdString() << "'\n";
+        ++differences;
+      }
+    }
+  }
+  out << "Html to text: " << texts.size() << " distinct texts, " << decoded << " decoded without QTextDocument, " << differences << " differ from QTextDocument" << std::endl;
+  return differences;
+}
+
+/*
+ * Names of filters and folders, and labels of parameters (original and translated)
+ */
+QStringList HtmlTranslatorBenchmark::stdlibTexts(int & lineCount)
+{
+  if (GmicStdLib::Array.isEmpty()) {
+    GmicStdLib::loadStdLib();
+  }
+  QSet<QString> uniqueTexts;
+  lineCount = 0;
+  for (const QByteArray & line : GmicStdLib::Array.split('\n')) {
+    if (!line.startsWith("#@gui")) {
+      continue;
+    }
+    const int space = line.indexOf(' ');
+    if (space == -1) {
+      continue;
+    }
+    QString text = QString::fromUtf8(line.mid(space + 1)).trimmed();
+    if (text.startsWith(QChar(':'))) {
+      text = text.mid(1).section(QChar('='), 0, 0).trimmed();
+    } else {
+      text = text.section(QChar(':'), 0, 0).trimmed();
+    }
+    if (!text.isEmpty()) {
+      uniqueTexts.insert(text);
+      uniqueTexts.insert(FilterTextTranslator::translate(text));
+      ++lineCount;
+    }
+  }
+  return uniqueTexts.values();
+}
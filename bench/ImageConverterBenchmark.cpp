@@ -0,0 +1,153 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file ImageConverterBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QElapsedTimer>
+#include <QImage>
+#include <algorithm>
+#include <limits>
+#include <ostream>
+#include <vector>
+#include "ImageConverter.h"
+#include "ImageTools.h"
+#include "Utils.h"
+#include "gmic.h"
+
+void ImageConverterBenchmark::run(std::ostream & out)
+{
+  const int width = 4000;
+  const int height = 3000;
+  const int repeat = 10;
+  const double megaPixels = (double(width) * height * repeat) / 1e6;
+  cimg_library::CImg<float> planar(width, height, 1, 4);
+  planar.rand(-10.0f, 265.0f); // Some values need clamping
+  std::vector<unsigned char> interleaved(static_cast<size_t>(width) * height * 4);
+  const float * c0 = planar.data(0, 0, 0, 0);
+  float * c1 = planar.data(0, 0, 0, 1);
+  float * c2 = planar.data(0, 0, 0, 2);
+  float * c3 = planar.data(0, 0, 0, 3);
+  const int n = width * height;
+  out << "Image conversion throughput (MPix/s), " << width << "x" << height << " image\n";
+  for (const ImageConverter::ConversionKernels & k : ImageConverter::availableKernels()) {
+    QElapsedTimer timer;
+    out << "  " << k.name << ":";
+    timer.start();
+    for (int i = 0; i < repeat; ++i) {
+      k.planarToInterleaved4(c0, c1, c2, c3, interleaved.data(), n);
+    }
+    out << " float4->ARGB32 " << megaPixels / std::max<qint64>(1, timer.elapsed()) * 1000.0;
+    timer.start();
+    for (int i = 0; i < repeat; ++i) {
+      k.planarToInterleaved3(c0, c1, c2, interleaved.data(), n);
+    }
+    out << ", float3->RGB888 " << megaPixels / std::max<qint64>(1, timer.elapsed()) * 1000.0;
+    timer.start();
+    for (int i = 0; i < repeat; ++i) {
+      k.planarToGray(c0, interleaved.data(), n);
+    }
+    out << ", float1->Gray8 " << megaPixels / std::max<qint64>(1, timer.elapsed()) * 1000.0;
+    timer.start();
+    for (int i = 0; i < repeat; ++i) {
+      k.interleaved4ToPlanar(interleaved.data(), c1, c2, c3, c1, n);
+    }
+    out << ", ARGB32->float4 " << megaPixels / std::max<qint64>(1, timer.elapsed()) * 1000.0;
+    timer.start();
+    for (int i = 0; i < repeat; ++i) {
+      k.interleaved3ToPlanar(interleaved.data(), c1, c2, c3, n);
+    }
+    out << ", RGB888->float3 " << megaPixels / std::max<qint64>(1, timer.elapsed()) * 1000.0 << "\n";
+  }
+  out << "Selected: " << ImageConverter::kernelsName() << "\n";
+
+  // Scaling of the whole conversions (and of preview calibration) with the number of threads
+  QImage image;
+  cimg_library::CImg<float> back;
+  cimg_library::CImg<float> calibrated;
+  out << "Threads scaling (MPix/s): threads, float4->ARGB32, ARGB32->float4, calibrate RGBA->RGB (preview)\n";
+  for (int threads = 1; threads <= 32; threads *= 2) {
+    GmicQt::setParallelRowsThreadCount(threads);
+    QElapsedTimer timer;
+    out << "  " << threads;
+    timer.start();
+    for (int i = 0; i < repeat; ++i) {
+      ImageConverter::convert(planar, image);
+    }
+    out << ", " << megaPixels / std::max<qint64>(1, timer.elapsed()) * 1000.0;
+    timer.start();
+    for (int i = 0; i < repeat; ++i) {
+      ImageConverter::convert(image, back);
+    }
+    out << ", " << megaPixels / std::max<qint64>(1, timer.elapsed()) * 1000.0;
+    qint64 elapsed = 0;
+    for (int i = 0; i < repeat; ++i) {
+      calibrated = planar;
+      timer.start();
+      GmicQt::calibrate_image(calibrated, 3, true);
+      elapsed += timer.elapsed();
+    }
+    out << ", " << megaPixels / std::max<qint64>(1, elapsed) * 1000.0 << "\n";
+  }
+  GmicQt::setParallelRowsThreadCount(0);
+  out.flush();
+}
+
+int ImageConverterBenchmark::check(std::ostream & out)
+{
+  const float specialValues[] = {-1.0f, -0.5f, 0.0f, 0.5f, 127.9f, 254.5f, 255.0f, 255.5f, 1e10f, -1e10f, //
+                                 std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()};
+  const int count = sizeof(specialValues) / sizeof(specialValues[0]);
+  const int n = 1000; // Long enough for the vectorized loops, not a multiple of their width
+  std::vector<float> planar(4 * n);
+  for (int i = 0; i < 4 * n; ++i) {
+    planar[i] = specialValues[(i * 7) % count];
+  }
+  const float * c0 = planar.data();
+  const float * c1 = c0 + n;
+  const float * c2 = c1 + n;
+  const float * c3 = c2 + n;
+  const std::vector<ImageConverter::ConversionKernels> kernels = ImageConverter::availableKernels();
+  std::vector<unsigned char> expected[3];
+  int differences = 0;
+  for (const ImageConverter::ConversionKernels & k : kernels) {
+    std::vector<unsigned char> bytes[3] = {std::vector<unsigned char>(4 * n), std::vector<unsigned char>(3 * n), std::vector<unsigned char>(n)};
+    k.planarToInterleaved4(c0, c1, c2, c3, bytes[0].data(), n);
+    k.planarToInterleaved3(c0, c1, c2, bytes[1].data(), n);
+    k.planarToGray(c0, bytes[2].data(), n);
+    if (&k == &kernels.front()) {
+      for (int format = 0; format < 3; ++format) {
+        expected[format] = bytes[format];
+      }
+      continue;
+    }
+    const char * formats[3] = {"float4->ARGB32", "float3->RGB888", "float1->Gray8"};
+    for (int format = 0; format < 3; ++format) {
+      if (bytes[format] != expected[format]) {
+        out << "Kernels " << k.name << " differ from " << kernels.front().name << " for " << formats[format] << "\n";
+        ++differences;
+      }
+    }
+  }
+  out << kernels.size() << " kernel set(s) compared, " << differences << " difference(s)" << std::endl;
+  return differences;
+}
@@ -0,0 +1,136 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file ParametersCacheBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <ostream>
+#include "Globals.h"
+#include "ParametersCache.h"
+#include "Utils.h"
+
+void ParametersCacheBenchmark::run(std::ostream & out)
+{
+  // The rc directory of the benchmarks is a temporary one
+  const QString & directory = GmicQt::path_rc(true);
+  const int counts[] = {1000, 10000};
+  for (const int count : counts) {
+    QFile::remove(ParametersCache::journalFilename());
+    QHash<QString, QList<QString>> expected;
+    QJsonObject documentObject;
+    for (int i = 0; i < count; ++i) {
+      const QString hash = QString("%1").arg(i, 32, 16, QChar('0'));
+      QList<QString> values;
+      QJsonArray array;
+      for (int k = 0; k < 8; ++k) {
+        values.push_back(QString::number(i * 0.25 + k));
+        array.push_back(values.back());
+      }
+      expected[hash] = values;
+      QJsonObject filterObject;
+      filterObject.insert("parameters", array);
+      documentObject.insert(hash, filterObject);
+    }
+    QFile jsonFile(directory + PARAMETERS_CACHE_FILENAME);
+    if (!jsonFile.open(QFile::WriteOnly) || (jsonFile.write(qCompress(QJsonDocument(documentObject).toJson(QJsonDocument::Compact))) == -1)) {
+      out << "Parameters cache: cannot write " << jsonFile.fileName().toStdString() << std::endl;
+      break;
+    }
+    jsonFile.close();
+    const QString firstHash = expected.begin().key();
+
+    QElapsedTimer timer;
+    timer.start();
+    ParametersCache::load(true);
+    const qint64 legacyLoad = timer.nsecsElapsed();
+    timer.start();
+    ParametersCache::save();
+    const qint64 rewrite = timer.nsecsElapsed();
+    timer.start();
+    ParametersCache::load(true);
+    const qint64 journalLoad = timer.nsecsElapsed();
+    timer.start();
+    ParametersCache::getValues(firstHash);
+    const qint64 firstAccess = timer.nsecsElapsed();
+
+    expected[firstHash][0] = "0.5";
+    ParametersCache::setValues(firstHash, expected[firstHash]);
+    timer.start();
+    ParametersCache::save();
+    const qint64 append = timer.nsecsElapsed();
+
+    // Two sessions modifying every filter leave enough superseded records to trigger a compaction
+    for (int session = 0; session < 2; ++session) {
+      ParametersCache::load(true);
+      for (QHash<QString, QList<QString>>::iterator it = expected.begin(); it != expected.end(); ++it) {
+        it.value()[1] = QString::number(session);
+        ParametersCache::setValues(it.key(), it.value());
+      }
+      ParametersCache::save();
+    }
+    const qint64 sizeBeforeCompaction = QFileInfo(ParametersCache::journalFilename()).size();
+    timer.start();
+    ParametersCache::load(true);
+    const qint64 compactionLoad = timer.nsecsElapsed();
+    const bool compactionStarted = (ParametersCache::_compactionThread != nullptr);
+    expected[firstHash][2] = "1.5";
+    ParametersCache::setValues(firstHash, expected[firstHash]);
+    timer.start();
+    ParametersCache::save();
+    const qint64 compactionSave = timer.nsecsElapsed();
+    const qint64 sizeAfterCompaction = QFileInfo(ParametersCache::journalFilename()).size();
+
+    ParametersCache::load(true);
+    int differences = 0;
+    timer.start();
+    for (QHash<QString, QList<QString>>::const_iterator it = expected.constBegin(); it != expected.constEnd(); ++it) {
+      differences += (ParametersCache::getValues(it.key()) != it.value());
+    }
+    const qint64 decoding = timer.nsecsElapsed();
+
+    out << "Parameters cache: " << count << " filters\n";
+    out << "  legacy JSON load             " << legacyLoad / 1000000.0 << " ms\n";
+    out << "  journal rewrite              " << rewrite / 1000000.0 << " ms\n";
+    out << "  journal load (index only)    " << journalLoad / 1000000.0 << " ms\n";
+    out << "  first getValues()            " << firstAccess / 1000.0 << " us\n";
+    out << "  save, one modified filter    " << append / 1000000.0 << " ms\n";
+    out << "  load, compaction " << (compactionStarted ? "started    " : "not started") << " " << compactionLoad / 1000000.0 << " ms, " << sizeBeforeCompaction / 1024 << " KiB\n";
+    out << "  save, compaction finished    " << compactionSave / 1000000.0 << " ms, " << sizeAfterCompaction / 1024 << " KiB\n";
+    out << "  decoding all entries         " << decoding / 1000000.0 << " ms, " << differences << " filter(s) with different values" << std::endl;
+  }
+  ParametersCache::discardCompaction();
+  ParametersCache::_parametersCache.clear();
+  ParametersCache::_inOutPanelStates.clear();
+  ParametersCache::_visibilityStates.clear();
+  ParametersCache::_journal.clear();
+  ParametersCache::_journalIndex.clear();
+  ParametersCache::_modifiedHashes.clear();
+}
@@ -0,0 +1,59 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file PreviewImageBenchmark.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "Benchmarks.h"
+#include <QElapsedTimer>
+#include <ostream>
+#include "Globals.h"
+#include "GmicStdlib.h"
+#include "ImageTools.h"
+#include "gmic.h"
+
+void PreviewImageBenchmark::run(std::ostream & out)
+{
+  if (GmicStdLib::Array.isEmpty()) {
+    GmicStdLib::loadStdLib(); // Required by gui_preview
+  }
+  const int width = 800;
+  const int height = 600;
+  const int repeat = 5;
+  const int counts[] = {2, 3, 4, 6, 9, PREVIEW_GRID_MAX_OUTPUTS};
+  out << "Preview composition (ms), " << width << "x" << height << " RGBA outputs: outputs, native, gui_preview\n";
+  for (int count : counts) {
+    cimg_library::CImgList<float> outputs(static_cast<unsigned int>(count), width, height, 1, 4);
+    cimglist_for(outputs, l) { outputs[l].rand(0.0f, 255.0f); }
+    cimg_library::CImg<float> result;
+    qint64 durations[2] = {0, 0};
+    for (int native = 0; native < 2; ++native) {
+      for (int i = 0; i < repeat; ++i) {
+        cimg_library::CImgList<float> images(outputs); // Consumed by the composition, not timed
+        QElapsedTimer timer;
+        timer.start();
+        GmicQt::composePreviewImage(images, result, width, height, native == 0);
+        durations[native] += timer.elapsed();
+      }
+    }
+    out << "  " << count << ", " << durations[0] / double(repeat) << ", " << durations[1] / double(repeat) << "\n";
+  }
+}
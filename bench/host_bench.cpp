@@ -0,0 +1,67 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file host_bench.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <QString>
+#include <iostream>
+#include "Common.h"
+#include "Host/host.h"
+#include "gmic.h"
+
+/*
+ * The benchmarks never run the plugin, so the host has no image.
+ */
+
+namespace GmicQt
+{
+const QString HostApplicationName;
+const char * HostApplicationShortname = "bench";
+const bool DarkThemeIsDefault = false;
+} // namespace GmicQt
+
+void gmic_qt_get_image_size(int * width, int * height)
+{
+  *width = 0;
+  *height = 0;
+}
+
+void gmic_qt_get_layers_extent(int * width, int * height, GmicQt::InputMode)
+{
+  *width = 0;
+  *height = 0;
+}
+
+void gmic_qt_get_cropped_images(cimg_library::CImgList<gmic_pixel_type> & images, cimg_library::CImgList<char> & imageNames, double, double, double, double, GmicQt::InputMode)
+{
+  images.assign();
+  imageNames.assign();
+}
+
+void gmic_qt_output_images(cimg_library::CImgList<gmic_pixel_type> &, const cimg_library::CImgList<char> &, GmicQt::OutputMode, const char *) {}
+
+void gmic_qt_apply_color_profile(cimg_library::CImg<gmic_pixel_type> &) {}
+
+void gmic_qt_show_message(const char * message)
+{
+  std::cout << message << std::endl;
+}
@@ -0,0 +1,143 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file main.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <QApplication>
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <iostream>
+#include <vector>
+#include "Benchmarks.h"
+#include "Globals.h"
+#include "LanguageSettings.h"
+#include "Utils.h"
+
+namespace
+{
+struct Benchmark {
+  const char * name;
+  void (*run)(std::ostream & out);
+};
+
+struct Check {
+  const char * name;
+  int (*run)(std::ostream & out); // Returns the number of differences
+};
+
+const std::vector<Benchmark> & benchmarks()
+{
+  static const std::vector<Benchmark> result = {
+      {"cimgz", CimgzDecoderBenchmark::run},
+      {"converter", ImageConverterBenchmark::run},
+      {"filters", FiltersModelReaderBenchmark::run},
+      {"html", HtmlTranslatorBenchmark::run},
+      {"parameters", FilterParametersWidgetBenchmark::run},
+      {"parameters-cache", ParametersCacheBenchmark::run},
+      {"pool", GmicInterpreterPoolBenchmark::run},
+      {"preview", PreviewImageBenchmark::run},
+      {"search", FiltersSearchIndexBenchmark::run},
+      {"view", FiltersViewBenchmark::run},
+  };
+  return result;
+}
+
+const std::vector<Check> & checks()
+{
+  static const std::vector<Check> result = {
+      {"converter", ImageConverterBenchmark::check},
+      {"filters", FiltersModelReaderBenchmark::check},
+      {"html", HtmlTranslatorBenchmark::check},
+      {"search", FiltersSearchIndexBenchmark::check},
+  };
+  return result;
+}
+
+void usage()
+{
+  std::cout << "Usage: gmic_qt_bench [name...]          Run the given benchmarks (all by default)\n"
+               "       gmic_qt_bench --check [name...]  Run the given checks (all by default)\n"
+               "Benchmarks:";
+  for (const Benchmark & benchmark : benchmarks()) {
+    std::cout << " " << benchmark.name;
+  }
+  std::cout << "\nChecks:";
+  for (const Check & check : checks()) {
+    std::cout << " " << check.name;
+  }
+  std::cout << std::endl;
+}
+} // namespace
+
+/*
+ * gmic_qt_bench runs in a temporary rc directory, with its own settings, so that
+ * the filters index, the parameters and the sources of the user are left untouched.
+ */
+int main(int argc, char * argv[])
+{
+  QTemporaryDir rcDirectory;
+  if (!rcDirectory.isValid()) {
+    std::cerr << "Cannot create a temporary directory" << std::endl;
+    return 1;
+  }
+  qputenv("GMIC_PATH", QFile::encodeName(rcDirectory.path()));
+  QApplication app(argc, argv);
+  GmicQt::setupApplication();
+  QCoreApplication::setApplicationName(QString("%1_bench").arg(GMIC_QT_APPLICATION_NAME));
+  LanguageSettings::installTranslators();
+
+  QStringList names = QCoreApplication::arguments().mid(1);
+  if (names.contains("--help") || names.contains("-h")) {
+    usage();
+    return 0;
+  }
+  const bool checking = !names.isEmpty() && (names.front() == "--check");
+  if (checking) {
+    names.pop_front();
+  }
+
+  int failures = 0;
+  int runs = 0;
+  if (checking) {
+    for (const Check & check : checks()) {
+      if (names.isEmpty() || names.contains(check.name)) {
+        const int differences = check.run(std::cout);
+        std::cout << check.name << ": " << (differences ? "FAILED" : "passed") << std::endl;
+        failures += (differences != 0);
+        ++runs;
+      }
+    }
+  } else {
+    for (const Benchmark & benchmark : benchmarks()) {
+      if (names.isEmpty() || names.contains(benchmark.name)) {
+        benchmark.run(std::cout);
+        ++runs;
+      }
+    }
+  }
+  if (!runs) {
+    usage();
+    return 1;
+  }
+  return failures ? 1 : 0;
+}
@@ -258,23 +258,31 @@ HEADERS +=  \
   src/FilterParameters/LinkParameter.h \
   src/FilterParameters/MultilineTextParameterWidget.h \
   src/FilterParameters/NoteParameter.h \
+  src/FilterParameters/ParameterWidgetPool.h \
   src/FilterParameters/PointParameter.h \
   src/FilterParameters/SeparatorParameter.h \
   src/FilterParameters/TextParameter.h \
   src/FilterSelector/FiltersModel.h \
+  src/FilterSelector/FiltersModelBinaryReader.h \
+  src/FilterSelector/FiltersModelBinaryWriter.h \
   src/FilterSelector/FiltersModelReader.h \
   src/FilterSelector/FiltersPresenter.h \
+  src/FilterSelector/FiltersSearchIndex.h \
   src/FilterSelector/FiltersView/FiltersView.h \
   src/FilterSelector/FiltersView/TreeView.h \
   src/FilterSelector/FiltersVisibilityMap.h \
+  src/CimgzDecoder.h \
   src/CroppedImageListProxy.h \
   src/CroppedActiveLayerProxy.h \
+  src/EventLoopMonitor.h \
   src/FilterSyncRunner.h \
   src/FilterThread.h \
+  src/FiltersUpdateThread.h \
   src/gmic_qt.h \
   src/FilterTextTranslator.h \
   src/Globals.h \
   src/GmicStdlib.h \
+  src/GmicInterpreterPool.h \
   src/GmicProcessor.h \
   src/HeadlessProcessor.h \
   src/Host/host.h \
@@ -289,9 +297,16 @@ HEADERS +=  \
   src/LanguageSettings.h \
   src/MainWindow.h \
   src/ParametersCache.h \
+  src/PreviewFrame.h \
+  src/PreviewResolutionController.h \
+  src/PreviewScheduler.h \
+  src/PreviewTileCache.h \
+  src/TiledFilterThread.h \
   src/TimeLogger.h \
   src/Updater.h \
   src/Utils.h \
+  src/WorkerPool.h \
+  src/WorkerProcess.h \
   src/ZoomConstraint.h \
   src/FilterSelector/FiltersView/FilterTreeFolder.h \
   src/FilterSelector/FiltersView/FilterTreeItem.h \
@@ -333,23 +348,31 @@ SOURCES += \
   src/FilterParameters/LinkParameter.cpp \
   src/FilterParameters/MultilineTextParameterWidget.cpp \
   src/FilterParameters/NoteParameter.cpp \
+  src/FilterParameters/ParameterWidgetPool.cpp \
   src/FilterParameters/PointParameter.cpp \
   src/FilterParameters/SeparatorParameter.cpp \
   src/FilterParameters/TextParameter.cpp \
   src/FilterSelector/FiltersModel.cpp \
+  src/FilterSelector/FiltersModelBinaryReader.cpp \
+  src/FilterSelector/FiltersModelBinaryWriter.cpp \
   src/FilterSelector/FiltersModelReader.cpp \
   src/FilterSelector/FiltersPresenter.cpp \
+  src/FilterSelector/FiltersSearchIndex.cpp \
   src/FilterSelector/FiltersView/FiltersView.cpp \
   src/FilterSelector/FiltersView/TreeView.cpp \
   src/FilterSelector/FiltersVisibilityMap.cpp \
+  src/CimgzDecoder.cpp \
   src/CroppedImageListProxy.cpp \
   src/CroppedActiveLayerProxy.cpp \
+  src/EventLoopMonitor.cpp \
   src/FilterSyncRunner.cpp \
   src/FilterThread.cpp \
+  src/FiltersUpdateThread.cpp \
   src/gmic_qt.cpp \
   src/FilterTextTranslator.cpp \
   src/Globals.cpp \
   src/GmicStdlib.cpp \
+  src/GmicInterpreterPool.cpp \
   src/GmicProcessor.cpp \
   src/HeadlessProcessor.cpp \
   src/HtmlTranslator.cpp \
@@ -363,9 +386,16 @@ SOURCES += \
   src/Logger.cpp \
   src/MainWindow.cpp \
   src/ParametersCache.cpp \
+  src/PreviewFrame.cpp \
+  src/PreviewResolutionController.cpp \
+  src/PreviewScheduler.cpp \
+  src/PreviewTileCache.cpp \
+  src/TiledFilterThread.cpp \
   src/TimeLogger.cpp \
   src/Updater.cpp \
   src/Utils.cpp \
+  src/WorkerPool.cpp \
+  src/WorkerProcess.cpp \
   src/FilterSelector/FiltersView/FilterTreeItem.cpp \
   src/FilterSelector/FiltersView/FilterTreeFolder.cpp \
   src/FilterSelector/FavesModel.cpp \
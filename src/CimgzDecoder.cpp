@@ -0,0 +1,255 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file CimgzDecoder.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "CimgzDecoder.h"
+#include <QList>
+#include <cstring>
+#include <limits>
+#include <zlib.h>
+#include "Common.h"
+
+namespace
+{
+const int MaxLineLength = 1024;
+}
+
+struct CimgzDecoder::ZStream {
+  z_stream stream;
+  bool initialized = false;
+};
+
+CimgzDecoder::CimgzDecoder() : _state(State::Header), _imageCount(0), _currentImage(0), _remainingInput(0), _outputStart(0), _outputSize(0), _zstream(new ZStream) {}
+
+CimgzDecoder::~CimgzDecoder()
+{
+  if (_zstream->initialized) {
+    inflateEnd(&_zstream->stream);
+  }
+}
+
+bool CimgzDecoder::feed(const QByteArray & data)
+{
+  return feed(data.constData(), data.size());
+}
+
+bool CimgzDecoder::feed(const char * data, qint64 size)
+{
+  while ((size > 0) && (_state != State::Finished) && (_state != State::Failed)) {
+    switch (_state) {
+    case State::Header:
+      if (readLine(data, size) && parseHeader()) {
+        _line.clear();
+      }
+      break;
+    case State::ImageHeader:
+      if (readLine(data, size) && parseImageHeader()) {
+        _line.clear();
+      }
+      break;
+    case State::CompressedData:
+      inflateData(data, size);
+      break;
+    case State::RawData:
+      copyData(data, size);
+      break;
+    default:
+      break;
+    }
+  }
+  return _state != State::Failed;
+}
+
+bool CimgzDecoder::isFinished() const
+{
+  return _state == State::Finished;
+}
+
+bool CimgzDecoder::hasFailed() const
+{
+  return _state == State::Failed;
+}
+
+QByteArray CimgzDecoder::takeResult()
+{
+  QByteArray result;
+  if (_state == State::Finished) {
+    result.swap(_result);
+  }
+  return result;
+}
+
+QByteArray CimgzDecoder::decompress(const QByteArray & array)
+{
+  CimgzDecoder decoder;
+  decoder.feed(array);
+  return decoder.takeResult();
+}
+
+bool CimgzDecoder::readLine(const char *& data, qint64 & size)
+{
+  const char * eol = static_cast<const char *>(std::memchr(data, '\n', size));
+  const qint64 length = eol ? (eol - data) : size;
+  _line.append(data, int(length));
+  data += length + (eol ? 1 : 0);
+  size -= length + (eol ? 1 : 0);
+  if (_line.size() > MaxLineLength) {
+    fail();
+    return false;
+  }
+  return eol;
+}
+
+bool CimgzDecoder::parseHeader()
+{
+  // Optional comment lines, then "N pixel_type endianness"
+  if (_line.startsWith('#')) {
+    return true;
+  }
+  const QList<QByteArray> fields = _line.simplified().split(' ');
+  bool ok = false;
+  _imageCount = fields.front().toUInt(&ok);
+  static const QList<QByteArray> BytePixelTypes = {"uint8", "int8", "uchar", "char", "unsigned_char", "signed_char", "bool"};
+  if (!ok || (fields.size() < 2) || !BytePixelTypes.contains(fields[1].toLower())) {
+    fail();
+    return false;
+  }
+  _currentImage = 0;
+  _state = _imageCount ? State::ImageHeader : State::Finished;
+  return true;
+}
+
+bool CimgzDecoder::parseImageHeader()
+{
+  // "W H D C" for raw data, or "W H D C #compressed_size"
+  const QList<QByteArray> fields = _line.simplified().split(' ');
+  if (fields.size() < 4) {
+    fail();
+    return false;
+  }
+  quint64 pixels = 1;
+  for (int i = 0; i < 4; ++i) {
+    bool ok = false;
+    pixels *= fields[i].toUInt(&ok);
+    if (!ok) {
+      fail();
+      return false;
+    }
+  }
+  if (pixels > quint64(std::numeric_limits<int>::max() - _result.size())) {
+    fail();
+    return false;
+  }
+  if (!pixels) {
+    nextImage();
+    return true;
+  }
+  _outputStart = _result.size();
+  _outputSize = qint64(pixels);
+  _result.resize(int(_outputStart + _outputSize));
+  if ((fields.size() > 4) && fields[4].startsWith('#')) {
+    bool ok = false;
+    _remainingInput = fields[4].mid(1).toULongLong(&ok);
+    if (!ok) {
+      fail();
+      return false;
+    }
+    if (_zstream->initialized) {
+      inflateReset(&_zstream->stream);
+    } else {
+      std::memset(&_zstream->stream, 0, sizeof(z_stream));
+      if (inflateInit(&_zstream->stream) != Z_OK) {
+        fail();
+        return false;
+      }
+      _zstream->initialized = true;
+    }
+    _zstream->stream.next_out = reinterpret_cast<Bytef *>(_result.data() + _outputStart);
+    _zstream->stream.avail_out = uInt(_outputSize);
+    _state = State::CompressedData;
+  } else {
+    _remainingInput = quint64(_outputSize);
+    _state = State::RawData;
+  }
+  return true;
+}
+
+void CimgzDecoder::inflateData(const char *& data, qint64 & size)
+{
+  const qint64 available = qMin<qint64>(size, qint64(_remainingInput));
+  z_stream & stream = _zstream->stream;
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+  stream.avail_in = uInt(available);
+  // Output buffer may have moved since the previous chunk
+  stream.next_out = reinterpret_cast<Bytef *>(_result.data() + _outputStart + (_outputSize - stream.avail_out));
+  int status = Z_OK;
+  while ((stream.avail_in > 0) && (status == Z_OK)) {
+    status = inflate(&stream, Z_NO_FLUSH);
+  }
+  const qint64 consumed = available - stream.avail_in;
+  data += consumed;
+  size -= consumed;
+  _remainingInput -= quint64(consumed);
+  if ((status != Z_OK) && (status != Z_STREAM_END)) {
+    fail();
+    return;
+  }
+  if ((status == Z_STREAM_END) || !_remainingInput) {
+    if (stream.avail_out) { // Truncated image
+      fail();
+      return;
+    }
+    // Skip any compressed bytes beyond the end of the zlib stream
+    const qint64 skipped = qMin<qint64>(size, qint64(_remainingInput));
+    data += skipped;
+    size -= skipped;
+    _remainingInput -= quint64(skipped);
+    if (!_remainingInput) {
+      nextImage();
+    }
+  }
+}
+
+void CimgzDecoder::copyData(const char *& data, qint64 & size)
+{
+  const qint64 count = qMin<qint64>(size, qint64(_remainingInput));
+  std::memcpy(_result.data() + _outputStart + (_outputSize - qint64(_remainingInput)), data, size_t(count));
+  data += count;
+  size -= count;
+  _remainingInput -= quint64(count);
+  if (!_remainingInput) {
+    nextImage();
+  }
+}
+
+void CimgzDecoder::nextImage()
+{
+  ++_currentImage;
+  _state = (_currentImage < _imageCount) ? State::ImageHeader : State::Finished;
+}
+
+void CimgzDecoder::fail()
+{
+  _state = State::Failed;
+  _result.clear();
+}
@@ -0,0 +1,85 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file CimgzDecoder.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_CIMGZDECODER_H
+#define GMIC_QT_CIMGZDECODER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <memory>
+
+/*
+ * Incremental decoder for 8-bit .cimg/.cimgz data (as saved by CImg<T>::save_cimg()
+ * or CImg<T>::get_serialize()). Data may be fed in chunks of any size, e.g. as it
+ * is received from the network. The pixels of all images are concatenated.
+ */
+class CimgzDecoder {
+public:
+  CimgzDecoder();
+  ~CimgzDecoder();
+  CimgzDecoder(const CimgzDecoder &) = delete;
+  CimgzDecoder & operator=(const CimgzDecoder &) = delete;
+
+  /**
+   * @brief Decode the next bytes of the stream
+   * @return false if the data is not valid 8-bit cimg(z) data
+   */
+  bool feed(const char * data, qint64 size);
+  bool feed(const QByteArray & data);
+  bool isFinished() const;
+  bool hasFailed() const;
+  QByteArray takeResult();
+
+  static QByteArray decompress(const QByteArray & array);
+
+private:
+  enum class State
+  {
+    Header,
+    ImageHeader,
+    CompressedData,
+    RawData,
+    Finished,
+    Failed
+  };
+  bool readLine(const char *& data, qint64 & size);
+  bool parseHeader();
+  bool parseImageHeader();
+  void inflateData(const char *& data, qint64 & size);
+  void copyData(const char *& data, qint64 & size);
+  void nextImage();
+  void fail();
+  State _state;
+  QByteArray _line;
+  unsigned int _imageCount;
+  unsigned int _currentImage;
+  quint64 _remainingInput;
+  qint64 _outputStart;
+  qint64 _outputSize;
+  QByteArray _result;
+  struct ZStream;
+  std::unique_ptr<ZStream> _zstream;
+};
+
+#endif // GMIC_QT_CIMGZDECODER_H
@@ -25,7 +25,13 @@
 
 #include "CroppedImageListProxy.h"
 #include <QDebug>
+#include <QSize>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <vector>
 #include "Common.h"
 #include "Host/host.h"
 #include "gmic.h"
@@ -36,16 +42,44 @@ double CroppedImageListProxy::_width = -1.0;
 double CroppedImageListProxy::_height = -1.0;
 double CroppedImageListProxy::_zoom = 0.0;
 GmicQt::InputMode CroppedImageListProxy::_inputMode = GmicQt::UnspecifiedInputMode;
-std::unique_ptr<cimg_library::CImgList<gmic_pixel_type>> CroppedImageListProxy::_cachedImageList(new cimg_library::CImgList<gmic_pixel_type>);
+std::shared_ptr<const cimg_library::CImgList<gmic_pixel_type>> CroppedImageListProxy::_cachedImageList(new cimg_library::CImgList<gmic_pixel_type>);
 std::unique_ptr<cimg_library::CImgList<char>> CroppedImageListProxy::_cachedImageNames(new cimg_library::CImgList<char>);
+std::shared_ptr<CroppedImageListProxy::Pyramid> CroppedImageListProxy::_pyramid;
 
-void CroppedImageListProxy::get(cimg_library::CImgList<gmic_pixel_type> & images, cimg_library::CImgList<char> & imageNames, double x, double y, double width, double height, GmicQt::InputMode mode,
-                                double zoom)
+struct CroppedImageListProxy::Pyramid {
+  GmicQt::InputMode inputMode;
+  cimg_library::CImgList<char> imageNames;
+  QVector<QSize> fullSizes;
+  std::vector<std::unique_ptr<cimg_library::CImgList<gmic_pixel_type>>> levels; // Level i has scale 1/2^(i+1)
+  std::atomic<bool> ready{false};    // Levels are set, and never modified afterwards
+  std::atomic<bool> canceled{false}; // Nobody waits for the levels anymore
+};
+
+namespace
+{
+// Reductions stop once every layer fits in this size
+const int PyramidSmallestLevelSize = 64;
+} // namespace
+
+class CroppedImageListProxy::PyramidBuilderThread : public QThread {
+public:
+  PyramidBuilderThread(std::shared_ptr<Pyramid> pyramid, cimg_library::CImgList<gmic_pixel_type> & images) : _pyramid(pyramid) { _images.swap(images); }
+
+protected:
+  void run() override;
+
+private:
+  std::shared_ptr<Pyramid> _pyramid;
+  cimg_library::CImgList<gmic_pixel_type> _images;
+};
+
+void CroppedImageListProxy::get(std::shared_ptr<const cimg_library::CImgList<gmic_pixel_type>> & images, cimg_library::CImgList<char> & imageNames, double x, double y, double width, double height,
+                                GmicQt::InputMode mode, double zoom)
 {
   if ((x != _x) || (y != _y) || (width != _width) || (height != _height) || (mode != _inputMode) || (zoom != _zoom)) {
     update(x, y, width, height, mode, zoom);
   }
-  images = *_cachedImageList;
+  images = _cachedImageList;
   imageNames = *_cachedImageNames;
 }
 
@@ -57,20 +91,153 @@ void CroppedImageListProxy::update(double x, double y, double width, double heig
   _height = height;
   _inputMode = mode;
   _zoom = zoom;
-  gmic_qt_get_cropped_images(*_cachedImageList, *_cachedImageNames, _x, _y, _width, _height, _inputMode);
+  // Lists already handed out may still be in use: never modify them, build a new one
+  std::shared_ptr<cimg_library::CImgList<gmic_pixel_type>> images(new cimg_library::CImgList<gmic_pixel_type>);
+  const bool usesPyramid = (zoom < 0.5) && pyramidIsEnabled();
+  if (usesPyramid && pyramidIsReady(mode)) {
+    getFromPyramid(*images, _x, _y, _width, _height, _zoom);
+    *_cachedImageNames = _pyramid->imageNames;
+    _cachedImageList = images;
+    return;
+  }
+  // Until the pyramid is ready, zoomed-out previews are cropped and resized directly
+  gmic_qt_get_cropped_images(*images, *_cachedImageNames, _x, _y, _width, _height, _inputMode);
   if (zoom < 1.0) {
-    for (unsigned int i = 0; i < _cachedImageList->size(); ++i) {
-      gmic_image<float> & image = (*_cachedImageList)[i];
-      image.resize(std::round(image.width() * zoom), std::round(image.height() * zoom), 1, -100, 1);
+    std::shared_ptr<cimg_library::CImgList<gmic_pixel_type>> resized(new cimg_library::CImgList<gmic_pixel_type>(images->size()));
+    for (unsigned int i = 0; i < images->size(); ++i) {
+      const gmic_image<float> & image = (*images)[i];
+      image.get_resize(std::round(image.width() * zoom), std::round(image.height() * zoom), 1, -100, 1).move_to((*resized)[i]);
+    }
+    // Whole layers, as fetched when the preview shows all the image, are all the pyramid needs
+    if (usesPyramid && !_pyramid && (x <= 0.0) && (y <= 0.0) && (x + width >= 1.0) && (y + height >= 1.0)) {
+      startPyramid(mode, *images, *_cachedImageNames);
     }
+    images = resized;
+  }
+  _cachedImageList = images;
+}
+
+bool CroppedImageListProxy::pyramidIsReady(GmicQt::InputMode mode)
+{
+  if (_pyramid && (_pyramid->inputMode != mode)) {
+    _pyramid->canceled = true;
+    _pyramid.reset();
+  }
+  return _pyramid && _pyramid->ready;
+}
+
+void CroppedImageListProxy::startPyramid(GmicQt::InputMode mode, cimg_library::CImgList<gmic_pixel_type> & images, const cimg_library::CImgList<char> & imageNames)
+{
+  _pyramid = std::make_shared<Pyramid>();
+  _pyramid->inputMode = mode;
+  _pyramid->imageNames = imageNames;
+  for (unsigned int i = 0; i < images.size(); ++i) {
+    _pyramid->fullSizes.push_back(QSize(images[i].width(), images[i].height()));
   }
+  QThread * thread = new PyramidBuilderThread(_pyramid, images);
+  QObject::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+  thread->start(QThread::LowPriority);
+}
+
+void CroppedImageListProxy::PyramidBuilderThread::run()
+{
+  TIMING;
+  std::vector<std::unique_ptr<cimg_library::CImgList<gmic_pixel_type>>> levels;
+  const cimg_library::CImgList<gmic_pixel_type> * previous = &_images;
+  bool reduced = true;
+  while (reduced) {
+    if (_pyramid->canceled) {
+      return;
+    }
+    std::unique_ptr<cimg_library::CImgList<gmic_pixel_type>> level(new cimg_library::CImgList<gmic_pixel_type>(previous->size()));
+    reduced = false;
+    for (unsigned int i = 0; i < previous->size(); ++i) {
+      const gmic_image<float> & image = (*previous)[i];
+      if (image.is_empty()) {
+        continue;
+      }
+      // Moving average: each pixel of a level is the mean of a 2x2 block of the previous one
+      image.get_resize((image.width() + 1) / 2, (image.height() + 1) / 2, 1, -100, 2).move_to((*level)[i]);
+      reduced = reduced || (std::max((*level)[i].width(), (*level)[i].height()) > PyramidSmallestLevelSize);
+    }
+    levels.push_back(std::move(level));
+    if (previous == &_images) {
+      _images.assign(); // Full resolution data is not kept
+    }
+    previous = levels.back().get();
+  }
+  _pyramid->levels.swap(levels);
+  _pyramid->ready = true;
+  TIMING;
+}
+
+void CroppedImageListProxy::getFromPyramid(cimg_library::CImgList<gmic_pixel_type> & images, double x, double y, double width, double height, double zoom)
+{
+  // Smallest level whose scale is still at or above the zoom factor
+  const int wanted = static_cast<int>(std::floor(std::log2(1.0 / zoom))) - 1;
+  const std::vector<std::unique_ptr<cimg_library::CImgList<gmic_pixel_type>>> & levels = _pyramid->levels;
+  const cimg_library::CImgList<gmic_pixel_type> & level = *levels[std::max(0, std::min(wanted, static_cast<int>(levels.size()) - 1))];
+  images.assign(level.size());
+  for (unsigned int i = 0; i < level.size(); ++i) {
+    const gmic_image<float> & source = level[i];
+    const QSize & fullSize = _pyramid->fullSizes[i];
+    if (source.is_empty()) {
+      continue;
+    }
+    // Crop rectangle in full resolution coordinates, computed as hosts do
+    const int ix = static_cast<int>(x * fullSize.width());
+    const int iy = static_cast<int>(y * fullSize.height());
+    const int iw = std::min(fullSize.width() - ix, static_cast<int>(1 + std::ceil(fullSize.width() * width)));
+    const int ih = std::min(fullSize.height() - iy, static_cast<int>(1 + std::ceil(fullSize.height() * height)));
+    if ((iw <= 0) || (ih <= 0)) {
+      continue;
+    }
+    const double sx = source.width() / static_cast<double>(fullSize.width());
+    const double sy = source.height() / static_cast<double>(fullSize.height());
+    const int x0 = static_cast<int>(std::floor(ix * sx));
+    const int y0 = static_cast<int>(std::floor(iy * sy));
+    const int x1 = std::min(source.width(), static_cast<int>(std::ceil((ix + iw) * sx))) - 1;
+    const int y1 = std::min(source.height(), static_cast<int>(std::ceil((iy + ih) * sy))) - 1;
+    source.get_crop(x0, y0, x1, y1).move_to(images[i]);
+    images[i].resize(std::max(1, static_cast<int>(std::round(iw * zoom))), std::max(1, static_cast<int>(std::round(ih * zoom))), 1, -100, 1);
+  }
+}
+
+bool CroppedImageListProxy::pyramidIsEnabled()
+{
+  static const bool enabled = qgetenv("GMIC_QT_NO_PREVIEW_PYRAMID").isEmpty();
+  return enabled;
+}
+
+std::size_t CroppedImageListProxy::detach(std::shared_ptr<const cimg_library::CImgList<gmic_pixel_type>> & shared, cimg_library::CImgList<gmic_pixel_type> & images)
+{
+  std::size_t bytes = 0;
+  if (!shared) {
+    images.assign();
+    return bytes;
+  }
+  if (shared.use_count() == 1) {
+    // Nobody else can reach this list any more (lists are created non-const in update())
+    images.swap(const_cast<cimg_library::CImgList<gmic_pixel_type> &>(*shared));
+  } else {
+    images = *shared;
+    for (unsigned int i = 0; i < images.size(); ++i) {
+      bytes += images[i].size() * sizeof(gmic_pixel_type);
+    }
+  }
+  shared.reset();
+  return bytes;
 }
 
 void CroppedImageListProxy::clear()
 {
-  _cachedImageList->assign();
+  _cachedImageList.reset(new cimg_library::CImgList<gmic_pixel_type>);
   _cachedImageNames->assign();
   _x = _y = _width = _height = -1.0;
   _inputMode = GmicQt::UnspecifiedInputMode;
   _zoom = 0.0;
+  if (_pyramid) {
+    _pyramid->canceled = true;
+    _pyramid.reset();
+  }
 }
@@ -25,6 +25,7 @@
 #ifndef GMIC_QT_CROPPEDIMAGELISTPROXY_H
 #define GMIC_QT_CROPPEDIMAGELISTPROXY_H
 
+#include <cstddef>
 #include <memory>
 #include "gmic_qt.h"
 
@@ -38,12 +39,41 @@ class CroppedImageListProxy {
 public:
   CroppedImageListProxy() = delete;
 
-  static void get(cimg_library::CImgList<gmic_pixel_type> & images, cimg_library::CImgList<char> & imageNames, double x, double y, double width, double height, GmicQt::InputMode mode, double zoom);
+  /**
+   * @brief Get the (cached) cropped images, without copying pixel data.
+   *        The returned list is shared with the cache and must be considered read-only:
+   *        the cache never modifies a list once handed out, it replaces it by a new one.
+   */
+  static void get(std::shared_ptr<const cimg_library::CImgList<gmic_pixel_type>> & images, cimg_library::CImgList<char> & imageNames, double x, double y, double width, double height,
+                  GmicQt::InputMode mode, double zoom);
   static void update(double x, double y, double width, double height, GmicQt::InputMode mode, double zoom);
+
+  /**
+   * @brief Turn a shared list returned by get() into a private, modifiable one.
+   *        Pixel data is copied only if the list is still referenced elsewhere
+   *        (e.g. by the cache), otherwise buffers are simply moved.
+   * @return Number of bytes copied
+   */
+  static std::size_t detach(std::shared_ptr<const cimg_library::CImgList<gmic_pixel_type>> & shared, cimg_library::CImgList<gmic_pixel_type> & images);
   static void clear();
 
 private:
-  static std::unique_ptr<cimg_library::CImgList<float>> _cachedImageList;
+  /**
+   * Successive half-size reductions of the whole input layers. Zoomed-out previews
+   * are cropped from the nearest level instead of the host images, once built.
+   */
+  struct Pyramid;
+  class PyramidBuilderThread;
+
+  /**
+   * @brief Build the levels in a background thread, from whole layers already fetched
+   *        from the host (host functions are only called by the GUI thread)
+   */
+  static void startPyramid(GmicQt::InputMode mode, cimg_library::CImgList<gmic_pixel_type> & images, const cimg_library::CImgList<char> & imageNames);
+  static bool pyramidIsReady(GmicQt::InputMode mode);
+  static void getFromPyramid(cimg_library::CImgList<gmic_pixel_type> & images, double x, double y, double width, double height, double zoom);
+  static bool pyramidIsEnabled();
+  static std::shared_ptr<const cimg_library::CImgList<float>> _cachedImageList;
   static std::unique_ptr<cimg_library::CImgList<char>> _cachedImageNames;
   static double _x;
   static double _y;
@@ -51,6 +81,8 @@ private:
   static double _height;
   static GmicQt::InputMode _inputMode;
   static double _zoom;
+
+  static std::shared_ptr<Pyramid> _pyramid; // Shared with the thread building it
 };
 
 #endif // GMIC_QT_CROPPEDIMAGELISTPROXY_H
@@ -43,6 +43,8 @@ int DialogSettings::_updatePeriodicity;
 GmicQt::OutputMessageMode DialogSettings::_outputMessageMode;
 bool DialogSettings::_previewZoomAlwaysEnabled = false;
 bool DialogSettings::_notifyFailedStartupUpdate = true;
+bool DialogSettings::_tiledPreviewEnabled = false;
+int DialogSettings::_previewTileCacheSize = PREVIEW_TILE_CACHE_DEFAULT_SIZE;
 
 const QColor DialogSettings::CheckBoxBaseColor(83, 83, 83);
 const QColor DialogSettings::CheckBoxTextColor(255, 255, 255);
@@ -98,6 +100,7 @@ DialogSettings::DialogSettings(QWidget * parent) : QDialog(parent), ui(new Ui::D
   }
 
   ui->sbPreviewTimeout->setRange(0, 999);
+  ui->sbTileCacheSize->setRange(16, 4096);
 
   ui->rbLeftPreview->setChecked(_previewPosition == MainWindow::PreviewOnLeft);
   ui->rbRightPreview->setChecked(_previewPosition == MainWindow::PreviewOnRight);
@@ -110,6 +113,9 @@ DialogSettings::DialogSettings(QWidget * parent) : QDialog(parent), ui(new Ui::D
   ui->sbPreviewTimeout->setValue(_previewTimeout);
   ui->cbPreviewZoom->setChecked(_previewZoomAlwaysEnabled);
   ui->cbNotifyFailedUpdate->setChecked(_notifyFailedStartupUpdate);
+  ui->cbTiledPreview->setChecked(_tiledPreviewEnabled);
+  ui->sbTileCacheSize->setValue(_previewTileCacheSize);
+  ui->sbTileCacheSize->setEnabled(_tiledPreviewEnabled);
 
   connect(ui->pbOk, SIGNAL(clicked()), this, SLOT(onOk()));
   connect(ui->rbLeftPreview, SIGNAL(toggled(bool)), this, SLOT(onRadioLeftPreviewToggled(bool)));
@@ -136,6 +142,10 @@ DialogSettings::DialogSettings(QWidget * parent) : QDialog(parent), ui(new Ui::D
 
   connect(ui->cbNotifyFailedUpdate, SIGNAL(toggled(bool)), this, SLOT(onNotifyStartupUpdateFailedToggle(bool)));
 
+  connect(ui->cbTiledPreview, SIGNAL(toggled(bool)), this, SLOT(onTiledPreviewToggled(bool)));
+
+  connect(ui->sbTileCacheSize, SIGNAL(valueChanged(int)), this, SLOT(onTileCacheSizeChanged(int)));
+
   ui->languageSelector->selectLanguage(_languageCode);
   if (_darkThemeEnabled) {
     QPalette p = ui->cbNativeColorDialogs->palette();
@@ -150,6 +160,7 @@ DialogSettings::DialogSettings(QWidget * parent) : QDialog(parent), ui(new Ui::D
     ui->rbRightPreview->setPalette(p);
     ui->cbShowLogos->setPalette(p);
     ui->cbNotifyFailedUpdate->setPalette(p);
+    ui->cbTiledPreview->setPalette(p);
   }
   ui->pbOk->setFocus();
   ui->tabWidget->setCurrentIndex(0);
@@ -179,6 +190,8 @@ void DialogSettings::loadSettings(GmicQt::ApplicationType applicationType)
   _previewZoomAlwaysEnabled = settings.value("AlwaysEnablePreviewZoom", false).toBool();
   _outputMessageMode = static_cast<GmicQt::OutputMessageMode>(settings.value("OutputMessageMode", GmicQt::DefaultOutputMessageMode).toInt());
   _notifyFailedStartupUpdate = settings.value("Config/NotifyIfStartupUpdateFails", true).toBool();
+  _tiledPreviewEnabled = settings.value("Config/TiledPreview", false).toBool();
+  _previewTileCacheSize = settings.value("Config/PreviewTileCacheSize", PREVIEW_TILE_CACHE_DEFAULT_SIZE).toInt();
   if (applicationType == GmicQt::GuiApplication) {
     AddIcon = LOAD_ICON("list-add");
     RemoveIcon = LOAD_ICON("list-remove");
@@ -200,6 +213,16 @@ int DialogSettings::previewTimeout()
   return _previewTimeout;
 }
 
+bool DialogSettings::tiledPreviewEnabled()
+{
+  return _tiledPreviewEnabled;
+}
+
+int DialogSettings::previewTileCacheSize()
+{
+  return _previewTileCacheSize;
+}
+
 GmicQt::OutputMessageMode DialogSettings::outputMessageMode()
 {
   return _outputMessageMode;
@@ -222,6 +245,8 @@ void DialogSettings::saveSettings(QSettings & settings)
   settings.remove("Config/UseFaveOutputMessages");
   settings.remove("Config/UseFavePreviewMode");
   settings.setValue("Config/NotifyIfStartupUpdateFails", _notifyFailedStartupUpdate);
+  settings.setValue("Config/TiledPreview", _tiledPreviewEnabled);
+  settings.setValue("Config/PreviewTileCacheSize", _previewTileCacheSize);
 }
 
 MainWindow::PreviewPosition DialogSettings::previewPosition()
@@ -274,6 +299,17 @@ void DialogSettings::onNotifyStartupUpdateFailedToggle(bool on)
   _notifyFailedStartupUpdate = on;
 }
 
+void DialogSettings::onTiledPreviewToggled(bool on)
+{
+  _tiledPreviewEnabled = on;
+  ui->sbTileCacheSize->setEnabled(on);
+}
+
+void DialogSettings::onTileCacheSizeChanged(int value)
+{
+  _previewTileCacheSize = value;
+}
+
 void DialogSettings::enableUpdateButton()
 {
   ui->pbUpdate->setEnabled(true);
@@ -69,6 +69,8 @@ public:
   static QString FolderParameterDefaultValue;
   static QString FileParameterDefaultPath;
   static int previewTimeout();
+  static bool tiledPreviewEnabled();
+  static int previewTileCacheSize();
   static GmicQt::OutputMessageMode outputMessageMode();
   static QIcon AddIcon;
   static QIcon RemoveIcon;
@@ -87,6 +89,8 @@ public slots:
   void onOutputMessageModeChanged(int);
   void onPreviewZoomToggled(bool);
   void onNotifyStartupUpdateFailedToggle(bool);
+  void onTiledPreviewToggled(bool);
+  void onTileCacheSizeChanged(int);
 
 private:
   Ui::DialogSettings * ui;
@@ -100,6 +104,8 @@ private:
   static GmicQt::OutputMessageMode _outputMessageMode;
   static bool _previewZoomAlwaysEnabled;
   static bool _notifyFailedStartupUpdate;
+  static bool _tiledPreviewEnabled;
+  static int _previewTileCacheSize;
 };
 
 #endif // GMIC_QT_DIALOGSETTINGS_H
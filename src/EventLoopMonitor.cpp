@@ -0,0 +1,57 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file EventLoopMonitor.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "EventLoopMonitor.h"
+#include <algorithm>
+#include "Globals.h"
+
+EventLoopMonitor::EventLoopMonitor(QObject * parent) : QObject(parent), _longest(0)
+{
+  _bounds << 4 << 8 << 16 << 33 << 50 << 100 << 200 << 500;
+  _counts.fill(0, _bounds.size() + 1);
+  _timer.setTimerType(Qt::PreciseTimer);
+  _timer.setInterval(EVENT_LOOP_MONITOR_INTERVAL_MS);
+  connect(&_timer, &QTimer::timeout, this, &EventLoopMonitor::onTimeout);
+  _lastTick.start();
+  _timer.start();
+}
+
+QString EventLoopMonitor::histogram() const
+{
+  QString text = QString("Event loop stalls (ms):");
+  for (int i = 0; i < _counts.size(); ++i) {
+    const QString bin = (i < _bounds.size()) ? QString("<%1").arg(_bounds[i]) : QString(">=%1").arg(_bounds.back());
+    text += QString(" %1: %2").arg(bin).arg(_counts[i]);
+  }
+  text += QString(", longest: %1").arg(_longest);
+  return text;
+}
+
+void EventLoopMonitor::onTimeout()
+{
+  const qint64 stall = std::max<qint64>(0, _lastTick.restart() - EVENT_LOOP_MONITOR_INTERVAL_MS);
+  const int bin = static_cast<int>(std::upper_bound(_bounds.begin(), _bounds.end(), static_cast<int>(stall)) - _bounds.begin());
+  ++_counts[bin];
+  _longest = std::max(_longest, stall);
+}
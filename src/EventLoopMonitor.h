@@ -0,0 +1,57 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file EventLoopMonitor.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_EVENTLOOPMONITOR_H
+#define GMIC_QT_EVENTLOOPMONITOR_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * @brief Histogram of the stalls of the event loop of the thread it lives in.
+ *
+ * A precise timer ticks every few milliseconds; the delay of each tick beyond
+ * its interval is the time the event loop was kept busy.
+ */
+class EventLoopMonitor : public QObject {
+  Q_OBJECT
+public:
+  EventLoopMonitor(QObject * parent);
+  QString histogram() const;
+
+private slots:
+  void onTimeout();
+
+private:
+  QTimer _timer;
+  QElapsedTimer _lastTick;
+  QVector<int> _bounds; // Upper bounds (ms) of the bins, the last bin being unbounded
+  QVector<quint64> _counts;
+  qint64 _longest;
+};
+
+#endif // GMIC_QT_EVENTLOOPMONITOR_H
@@ -81,48 +81,35 @@ void AbstractParameter::addToKeypointList(KeypointList &) const {}
 
 void AbstractParameter::extractPositionFromKeypointList(KeypointList &) {}
 
-AbstractParameter * AbstractParameter::createFromText(const char * text, int & length, QString & error, QWidget * parent)
+namespace
+{
+// Tested in this order, as prefixes of the type in the definition (e.g. "file" for "filein")
+const char * const ParameterTypes[] = {"int", "float", "bool", "choice", "color", "separator", "note", "file", "folder", "text", "link", "value", "button", "point"};
+const int ParameterTypeCount = sizeof(ParameterTypes) / sizeof(ParameterTypes[0]);
+} // namespace
+
+AbstractParameter * AbstractParameter::createFromText(const char * text, int & length, QString & error, QWidget * parent, Descriptor * descriptor)
 {
   AbstractParameter * result = nullptr;
-  QString line = text;
   error.clear();
 
-#define IS_OF_TYPE(ptype) (QRegExp("^[^=]*\\s*=\\s*_?" ptype, Qt::CaseInsensitive).indexIn(line) == 0)
-
-#define PREFIX "^[^=]*\\s*=\\s*_?"
-  if (IS_OF_TYPE("int")) {
-    result = new IntParameter(parent);
-  } else if (IS_OF_TYPE("float")) {
-    result = new FloatParameter(parent);
-  } else if (IS_OF_TYPE("bool")) {
-    result = new BoolParameter(parent);
-  } else if (IS_OF_TYPE("choice")) {
-    result = new ChoiceParameter(parent);
-  } else if (IS_OF_TYPE("color")) {
-    result = new ColorParameter(parent);
-  } else if (IS_OF_TYPE("separator")) {
-    result = new SeparatorParameter(parent);
-  } else if (IS_OF_TYPE("note")) {
-    result = new NoteParameter(parent);
-  } else if (IS_OF_TYPE("file") || IS_OF_TYPE("filein") || IS_OF_TYPE("fileout")) {
-    result = new FileParameter(parent);
-  } else if (IS_OF_TYPE("folder")) {
-    result = new FolderParameter(parent);
-  } else if (IS_OF_TYPE("text")) {
-    result = new TextParameter(parent);
-  } else if (IS_OF_TYPE("link")) {
-    result = new LinkParameter(parent);
-  } else if (IS_OF_TYPE("value")) {
-    result = new ConstParameter(parent);
-  } else if (IS_OF_TYPE("button")) {
-    result = new ButtonParameter(parent);
-  } else if (IS_OF_TYPE("point")) {
-    result = new PointParameter(parent);
+  int type = -1;
+  const char * name = typeName(text);
+  if (name) {
+    for (int t = 0; (t < ParameterTypeCount) && (type == -1); ++t) {
+      if (startsWithType(name, ParameterTypes[t])) {
+        type = t;
+      }
+    }
+  }
+  if (type != -1) {
+    result = create(type, parent);
   }
   if (result) {
     if (!result->initFromText(text, length)) {
       delete result;
       result = nullptr;
+      const QString line = text;
       if (!line.isEmpty()) {
         QRegExp nameRegExp("^[^=]*\\s*=");
         if (nameRegExp.indexIn(line) == 0) {
@@ -130,8 +117,12 @@ AbstractParameter * AbstractParameter::createFromText(const char * text, int & l
           error = "Parameter name: " + name + "\n" + error;
         }
       }
+    } else if (descriptor) {
+      descriptor->type = type;
+      descriptor->text = QByteArray(text, length);
     }
   } else {
+    const QString line = text;
     if (!line.isEmpty()) {
       QRegExp nameRegExp("^[^=]*\\s*=");
       if (nameRegExp.indexIn(line) == 0) {
@@ -148,6 +139,53 @@ AbstractParameter * AbstractParameter::createFromText(const char * text, int & l
   return result;
 }
 
+AbstractParameter * AbstractParameter::createFromDescriptor(const Descriptor & descriptor, QWidget * parent)
+{
+  AbstractParameter * result = create(descriptor.type, parent);
+  int length;
+  if (result && !result->initFromText(descriptor.text.constData(), length)) {
+    delete result;
+    result = nullptr;
+  }
+  return result;
+}
+
+AbstractParameter * AbstractParameter::create(int type, QWidget * parent)
+{
+  switch (type) {
+  case 0:
+    return new IntParameter(parent);
+  case 1:
+    return new FloatParameter(parent);
+  case 2:
+    return new BoolParameter(parent);
+  case 3:
+    return new ChoiceParameter(parent);
+  case 4:
+    return new ColorParameter(parent);
+  case 5:
+    return new SeparatorParameter(parent);
+  case 6:
+    return new NoteParameter(parent);
+  case 7:
+    return new FileParameter(parent);
+  case 8:
+    return new FolderParameter(parent);
+  case 9:
+    return new TextParameter(parent);
+  case 10:
+    return new LinkParameter(parent);
+  case 11:
+    return new ConstParameter(parent);
+  case 12:
+    return new ButtonParameter(parent);
+  case 13:
+    return new PointParameter(parent);
+  default:
+    return nullptr;
+  }
+}
+
 AbstractParameter::VisibilityState AbstractParameter::defaultVisibilityState() const
 {
   return _defaultVisibilityState;
@@ -200,21 +238,32 @@ AbstractParameter::VisibilityPropagation AbstractParameter::visibilityPropagatio
 QStringList AbstractParameter::parseText(const QString & type, const char * text, int & length)
 {
   QStringList result;
-  const QString str = text;
-  result << str.left(str.indexOf("=")).trimmed();
+  const char * equal = strchr(text, '=');
+  result << (equal ? QString::fromUtf8(text, int(equal - text)) : QString::fromUtf8(text)).trimmed();
 #ifdef _GMIC_QT_DEBUG_
   _debugName = result.back();
 #endif
 
-  QRegExp re(QString("^[^=]*\\s*=\\s*(_?)%1\\s*(.)").arg(type), Qt::CaseInsensitive);
-  re.indexIn(str);
-  const int prefixLength = re.cap(0).toUtf8().size();
-
-  if (re.cap(1) == "_") {
-    _update = false;
+  // Same as matching "^[^=]*\\s*=\\s*(_?)<type>\\s*(.)", case insensitively
+  bool underscore = false;
+  const QByteArray typeArray = type.toLatin1();
+  const char * name = typeName(text, &underscore);
+  int prefixLength = 0;
+  QString open;
+  if (name && startsWithType(name, typeArray)) {
+    const char * p = name + typeArray.size();
+    while (*p && isspace(static_cast<unsigned char>(*p))) {
+      ++p;
+    }
+    if (*p) {
+      open = QString::fromUtf8(p, 1);
+      prefixLength = int(p + 1 - text);
+      if (underscore) {
+        _update = false;
+      }
+    }
   }
 
-  QString open = re.cap(2);
   const char * end = nullptr;
   const char * closing = (open == "(") ? ")" : (open == "{") ? "}" : (open == "[") ? "]" : nullptr;
   if (!closing) {
@@ -268,7 +317,38 @@ QStringList AbstractParameter::parseText(const QString & type, const char * text
 
 bool AbstractParameter::matchType(const QString & type, const char * text) const
 {
-  return QString(text).contains(QRegExp(QString("^[^=]*\\s*=\\s*_?%1\\s*.").arg(type), Qt::CaseInsensitive));
+  const QByteArray typeArray = type.toLatin1();
+  const char * name = typeName(text);
+  if (!name || !startsWithType(name, typeArray)) {
+    return false;
+  }
+  const char * p = name + typeArray.size();
+  while (*p && isspace(static_cast<unsigned char>(*p))) {
+    ++p;
+  }
+  return *p; // The type must be followed by some character
+}
+
+const char * AbstractParameter::typeName(const char * text, bool * underscore)
+{
+  // "name = _type(...)", the name cannot contain '='
+  const char * p = strchr(text, '=');
+  if (!p) {
+    return nullptr;
+  }
+  ++p;
+  while (*p && isspace(static_cast<unsigned char>(*p))) {
+    ++p;
+  }
+  if (underscore) {
+    *underscore = (*p == '_');
+  }
+  return (*p == '_') ? (p + 1) : p;
+}
+
+bool AbstractParameter::startsWithType(const char * text, const QByteArray & type)
+{
+  return !qstrnicmp(text, type.constData(), uint(type.size()));
 }
 
 void AbstractParameter::notifyIfRelevant()
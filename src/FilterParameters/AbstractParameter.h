@@ -25,6 +25,7 @@
 #ifndef GMIC_QT_ABSTRACTPARAMETER_H
 #define GMIC_QT_ABSTRACTPARAMETER_H
 
+#include <QByteArray>
 #include <QObject>
 #include <QStringList>
 
@@ -49,7 +50,16 @@ public:
   virtual void addToKeypointList(KeypointList &) const;
   virtual void extractPositionFromKeypointList(KeypointList &);
 
-  static AbstractParameter * createFromText(const char * text, int & length, QString & error, QWidget * parent = nullptr);
+  /**
+   * @brief Type and definition of a parameter, as recognized by createFromText()
+   */
+  struct Descriptor {
+    int type;
+    QByteArray text;
+  };
+
+  static AbstractParameter * createFromText(const char * text, int & length, QString & error, QWidget * parent = nullptr, Descriptor * descriptor = nullptr);
+  static AbstractParameter * createFromDescriptor(const Descriptor & descriptor, QWidget * parent = nullptr);
   virtual bool initFromText(const char * text, int & textLength) = 0;
 
   enum VisibilityState
@@ -80,6 +90,9 @@ signals:
 protected:
   QStringList parseText(const QString & type, const char * text, int & length);
   bool matchType(const QString & type, const char * text) const;
+  static const char * typeName(const char * text, bool * underscore = nullptr);
+  static bool startsWithType(const char * text, const QByteArray & type);
+  static AbstractParameter * create(int type, QWidget * parent);
   void notifyIfRelevant();
   const bool _actualParameter;
   VisibilityState _defaultVisibilityState;
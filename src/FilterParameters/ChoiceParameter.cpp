@@ -29,6 +29,7 @@
 #include <QStringList>
 #include <QWidget>
 #include "Common.h"
+#include "FilterParameters/ParameterWidgetPool.h"
 #include "FilterTextTranslator.h"
 #include "HtmlTranslator.h"
 #include "Logger.h"
@@ -37,8 +38,8 @@ ChoiceParameter::ChoiceParameter(QObject * parent) : AbstractParameter(parent, t
 
 ChoiceParameter::~ChoiceParameter()
 {
-  delete _comboBox;
-  delete _label;
+  ParameterWidgetPool::recycle(_comboBox, this);
+  ParameterWidgetPool::recycle(_label, this);
 }
 
 bool ChoiceParameter::addTo(QWidget * widget, int row)
@@ -46,14 +47,16 @@ bool ChoiceParameter::addTo(QWidget * widget, int row)
   _grid = dynamic_cast<QGridLayout *>(widget->layout());
   Q_ASSERT_X(_grid, __PRETTY_FUNCTION__, "No grid layout in widget");
   _row = row;
-  delete _comboBox;
-  delete _label;
+  disconnectComboBox();
+  ParameterWidgetPool::recycle(_comboBox, this);
+  ParameterWidgetPool::recycle(_label, this);
 
-  _comboBox = new QComboBox(widget);
+  ParameterWidgetPool * pool = ParameterWidgetPool::get(widget);
+  _comboBox = pool->comboBox();
   _comboBox->addItems(_choices);
   _comboBox->setCurrentIndex(_value);
 
-  _grid->addWidget(_label = new QLabel(_name, widget), row, 0, 1, 1);
+  _grid->addWidget(_label = pool->label(_name), row, 0, 1, 1);
   _grid->addWidget(_comboBox, row, 1, 1, 2);
   connectComboBox();
   return true;
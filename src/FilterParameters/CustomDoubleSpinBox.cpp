@@ -36,6 +36,13 @@
 CustomDoubleSpinBox::CustomDoubleSpinBox(QWidget * parent, float min, float max) : QDoubleSpinBox(parent)
 {
   setSizePolicy(QSizePolicy::Preferred, QSizePolicy::Fixed);
+  setBounds(min, max);
+}
+
+CustomDoubleSpinBox::~CustomDoubleSpinBox() {}
+
+void CustomDoubleSpinBox::setBounds(float min, float max)
+{
   const int decimals = std::max(2, MAX_DIGITS - std::max(integerPartDigitCount(min), integerPartDigitCount(max)));
   setDecimals(decimals);
   setRange(min, max);
@@ -47,10 +54,9 @@ CustomDoubleSpinBox::CustomDoubleSpinBox(QWidget * parent, float min, float max)
   _sizeHint = dummy->sizeHint();
   _minimumSizeHint = dummy->minimumSizeHint();
   delete dummy;
+  updateGeometry();
 }
 
-CustomDoubleSpinBox::~CustomDoubleSpinBox() {}
-
 QString CustomDoubleSpinBox::textFromValue(double value) const
 {
   QString text = QString::number(value, 'g', MAX_DIGITS);
@@ -36,6 +36,7 @@ public:
   CustomDoubleSpinBox(QWidget * parent, float min, float max);
   ~CustomDoubleSpinBox() override;
   QString textFromValue(double value) const override;
+  void setBounds(float min, float max);
 
 protected:
   QSize sizeHint() const override;
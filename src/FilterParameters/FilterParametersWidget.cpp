@@ -29,8 +29,11 @@
 #include <QVBoxLayout>
 #include "Common.h"
 #include "FilterParameters/AbstractParameter.h"
+#include "FilterParameters/ParameterWidgetPool.h"
 #include "FilterParameters/PointParameter.h"
 
+QHash<QString, FilterParametersWidget::CachedDescriptors> FilterParametersWidget::_descriptorsCache;
+
 FilterParametersWidget::FilterParametersWidget(QWidget * parent) : QWidget(parent), _valueString(""), _labelNoParams(nullptr), _paddingWidget(nullptr)
 {
   delete layout();
@@ -54,28 +57,37 @@ bool FilterParametersWidget::build(const QString & name, const QString & hash, c
   auto grid = new QGridLayout(this);
   grid->setRowStretch(1, 2);
 
-  QByteArray rawText = parameters.toUtf8();
-  const char * cstr = rawText.constData();
-  int length;
-
   PointParameter::resetDefaultColorIndex();
 
   // Build parameters and count actual ones
   _actualParametersCount = 0;
   _quotedParameters.clear();
   QString error;
-  AbstractParameter * parameter;
-  do {
-    parameter = AbstractParameter::createFromText(cstr, length, error, this);
-    if (parameter) {
-      _presetParameters.push_back(parameter);
-      if (parameter->isActualParameter()) {
-        _actualParametersCount += 1;
-        _quotedParameters += (parameter->isQuoted() ? QString("1") : QString("0"));
+  QHash<QString, CachedDescriptors>::const_iterator itCache = _descriptorsCache.constFind(hash);
+  if ((itCache != _descriptorsCache.constEnd()) && (itCache->parameters == parameters)) {
+    for (const AbstractParameter::Descriptor & descriptor : itCache->descriptors) {
+      addParameter(AbstractParameter::createFromDescriptor(descriptor, this));
+    }
+  } else {
+    QByteArray rawText = parameters.toUtf8();
+    const char * cstr = rawText.constData();
+    int length;
+    CachedDescriptors cache;
+    cache.parameters = parameters;
+    AbstractParameter::Descriptor descriptor;
+    AbstractParameter * parameter;
+    do {
+      parameter = AbstractParameter::createFromText(cstr, length, error, this, &descriptor);
+      if (parameter) {
+        addParameter(parameter);
+        cache.descriptors.push_back(descriptor);
       }
+      cstr += length;
+    } while (parameter && error.isEmpty());
+    if (error.isEmpty() && !hash.isEmpty()) {
+      _descriptorsCache[hash] = cache;
     }
-    cstr += length;
-  } while (parameter && error.isEmpty());
+  }
 
   if (!error.isEmpty()) {
     for (AbstractParameter * p : _presetParameters) {
@@ -356,6 +368,18 @@ void FilterParametersWidget::clear()
   _paddingWidget = nullptr;
 }
 
+void FilterParametersWidget::addParameter(AbstractParameter * parameter)
+{
+  if (!parameter) {
+    return;
+  }
+  _presetParameters.push_back(parameter);
+  if (parameter->isActualParameter()) {
+    _actualParametersCount += 1;
+    _quotedParameters += (parameter->isQuoted() ? QString("1") : QString("0"));
+  }
+}
+
 void FilterParametersWidget::applyDefaultVisibilityStates()
 {
   setVisibilityStates(defaultVisibilityStates()); // Will propagate
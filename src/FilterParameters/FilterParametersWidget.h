@@ -26,14 +26,15 @@
 #define GMIC_QT_FILTERPARAMSWIDGET_H
 
 #include <QGroupBox>
+#include <QHash>
 #include <QList>
 #include <QModelIndex>
 #include <QPushButton>
 #include <QStringList>
 #include <QVector>
 #include <QWidget>
+#include "FilterParameters/AbstractParameter.h"
 #include "KeypointList.h"
-class AbstractParameter;
 class QLabel;
 
 class FilterParametersWidget : public QWidget {
@@ -81,6 +82,14 @@ protected:
   QString _filterHash;
   bool _hasKeypoints;
   QString _quotedParameters;
+
+private:
+  void addParameter(AbstractParameter * parameter);
+  struct CachedDescriptors {
+    QString parameters;
+    QVector<AbstractParameter::Descriptor> descriptors;
+  };
+  static QHash<QString, CachedDescriptors> _descriptorsCache; // Filter hash -> parsed parameters
 };
 
 #endif // GMIC_QT_FILTERPARAMSWIDGET_H
@@ -34,6 +34,7 @@
 #include <QWidget>
 #include "DialogSettings.h"
 #include "FilterParameters/CustomDoubleSpinBox.h"
+#include "FilterParameters/ParameterWidgetPool.h"
 #include "FilterTextTranslator.h"
 #include "Globals.h"
 #include "HtmlTranslator.h"
@@ -46,9 +47,9 @@ FloatParameter::FloatParameter(QObject * parent) : AbstractParameter(parent, tru
 
 FloatParameter::~FloatParameter()
 {
-  delete _spinBox;
-  delete _slider;
-  delete _label;
+  ParameterWidgetPool::recycle(_spinBox, this);
+  ParameterWidgetPool::recycle(_slider, this);
+  ParameterWidgetPool::recycle(_label, this);
 }
 
 bool FloatParameter::addTo(QWidget * widget, int row)
@@ -56,10 +57,12 @@ bool FloatParameter::addTo(QWidget * widget, int row)
   _grid = dynamic_cast<QGridLayout *>(widget->layout());
   Q_ASSERT_X(_grid, __PRETTY_FUNCTION__, "No grid layout in widget");
   _row = row;
-  delete _spinBox;
-  delete _slider;
-  delete _label;
-  _slider = new QSlider(Qt::Horizontal, widget);
+  disconnectSliderSpinBox();
+  ParameterWidgetPool::recycle(_spinBox, this);
+  ParameterWidgetPool::recycle(_slider, this);
+  ParameterWidgetPool::recycle(_label, this);
+  ParameterWidgetPool * pool = ParameterWidgetPool::get(widget);
+  _slider = pool->slider();
   _slider->setMinimumWidth(SLIDER_MIN_WIDTH);
   _slider->setRange(0, SLIDER_MAX_RANGE);
   _slider->setValue(static_cast<int>(SLIDER_MAX_RANGE * (_value - _min) / (_max - _min)));
@@ -70,10 +73,10 @@ bool FloatParameter::addTo(QWidget * widget, int row)
     _slider->setPalette(p);
   }
 
-  _spinBox = new CustomDoubleSpinBox(widget, _min, _max);
+  _spinBox = pool->doubleSpinBox(_min, _max);
   _spinBox->setSingleStep((_max - _min) / 100.0f);
   _spinBox->setValue(_value);
-  _grid->addWidget(_label = new QLabel(_name, widget), row, 0, 1, 1);
+  _grid->addWidget(_label = pool->label(_name), row, 0, 1, 1);
   _grid->addWidget(_slider, row, 1, 1, 1);
   _grid->addWidget(_spinBox, row, 2, 1, 1);
 
@@ -31,6 +31,7 @@
 #include <QTimerEvent>
 #include <QWidget>
 #include "DialogSettings.h"
+#include "FilterParameters/ParameterWidgetPool.h"
 #include "FilterTextTranslator.h"
 #include "Globals.h"
 #include "HtmlTranslator.h"
@@ -43,9 +44,9 @@ IntParameter::IntParameter(QObject * parent) : AbstractParameter(parent, true),
 
 IntParameter::~IntParameter()
 {
-  delete _spinBox;
-  delete _slider;
-  delete _label;
+  ParameterWidgetPool::recycle(_spinBox, this);
+  ParameterWidgetPool::recycle(_slider, this);
+  ParameterWidgetPool::recycle(_label, this);
 }
 
 bool IntParameter::addTo(QWidget * widget, int row)
@@ -53,10 +54,12 @@ bool IntParameter::addTo(QWidget * widget, int row)
   _grid = dynamic_cast<QGridLayout *>(widget->layout());
   Q_ASSERT_X(_grid, __PRETTY_FUNCTION__, "No grid layout in widget");
   _row = row;
-  delete _spinBox;
-  delete _slider;
-  delete _label;
-  _slider = new QSlider(Qt::Horizontal, widget);
+  disconnectSliderSpinBox();
+  ParameterWidgetPool::recycle(_spinBox, this);
+  ParameterWidgetPool::recycle(_slider, this);
+  ParameterWidgetPool::recycle(_label, this);
+  ParameterWidgetPool * pool = ParameterWidgetPool::get(widget);
+  _slider = pool->slider();
   _slider->setMinimumWidth(SLIDER_MIN_WIDTH);
   _slider->setRange(_min, _max);
   _slider->setValue(_value);
@@ -69,7 +72,7 @@ bool IntParameter::addTo(QWidget * widget, int row)
     _slider->setPageStep(fact * (delta / fact) / 10);
   }
 
-  _spinBox = new QSpinBox(widget);
+  _spinBox = pool->spinBox();
   _spinBox->setRange(_min, _max);
   _spinBox->setValue(_value);
   if (DialogSettings::darkThemeEnabled()) {
@@ -78,7 +81,7 @@ bool IntParameter::addTo(QWidget * widget, int row)
     p.setColor(QPalette::Highlight, QColor(130, 130, 130));
     _slider->setPalette(p);
   }
-  _grid->addWidget(_label = new QLabel(_name, widget), row, 0, 1, 1);
+  _grid->addWidget(_label = pool->label(_name), row, 0, 1, 1);
   _grid->addWidget(_slider, row, 1, 1, 1);
   _grid->addWidget(_spinBox, row, 2, 1, 1);
   connectSliderSpinBox();
@@ -0,0 +1,150 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file CustomDoubleSpinBox.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "FilterParameters/ParameterWidgetPool.h"
+#include <QComboBox>
+#include <QLabel>
+#include <QLayout>
+#include <QPalette>
+#include <QSlider>
+#include <QSpinBox>
+#include "FilterParameters/CustomDoubleSpinBox.h"
+#include "Globals.h"
+
+ParameterWidgetPool::ParameterWidgetPool(QWidget * widget) : QObject(widget), _widget(widget), _createdWidgetCount(0), _reusedWidgetCount(0) {}
+
+ParameterWidgetPool * ParameterWidgetPool::get(QWidget * widget)
+{
+  auto pool = widget->findChild<ParameterWidgetPool *>(QString(), Qt::FindDirectChildrenOnly);
+  return pool ? pool : new ParameterWidgetPool(widget);
+}
+
+template <typename T> T * ParameterWidgetPool::take()
+{
+  QMultiHash<const QMetaObject *, QPointer<QWidget>>::iterator it = _widgets.find(&T::staticMetaObject);
+  while (it != _widgets.end() && it.key() == &T::staticMetaObject) {
+    QWidget * widget = it.value();
+    it = _widgets.erase(it);
+    if (widget) {
+      // Properties a parameter may have set on the widget, other than the ones set by the accessors below
+      widget->setPalette(QPalette());
+      widget->setMinimumWidth(0);
+      widget->setToolTip(QString());
+      widget->show(); // Actually shown with the parameters widget
+      ++_reusedWidgetCount;
+      return static_cast<T *>(widget);
+    }
+  }
+  return nullptr;
+}
+
+QLabel * ParameterWidgetPool::label(const QString & text)
+{
+  QLabel * label = take<QLabel>();
+  if (label) {
+    label->setText(text);
+    return label;
+  }
+  ++_createdWidgetCount;
+  return new QLabel(text, _widget);
+}
+
+QSlider * ParameterWidgetPool::slider()
+{
+  QSlider * slider = take<QSlider>();
+  if (slider) {
+    slider->setSingleStep(1);
+    slider->setPageStep(10);
+    return slider;
+  }
+  ++_createdWidgetCount;
+  return new QSlider(Qt::Horizontal, _widget);
+}
+
+QSpinBox * ParameterWidgetPool::spinBox()
+{
+  QSpinBox * spinBox = take<QSpinBox>();
+  if (spinBox) {
+    spinBox->setRange(0, 99);
+    spinBox->setSingleStep(1);
+    spinBox->setKeyboardTracking(true);
+    return spinBox;
+  }
+  ++_createdWidgetCount;
+  return new QSpinBox(_widget);
+}
+
+CustomDoubleSpinBox * ParameterWidgetPool::doubleSpinBox(float min, float max)
+{
+  CustomDoubleSpinBox * spinBox = take<CustomDoubleSpinBox>();
+  if (spinBox) {
+    spinBox->setBounds(min, max);
+    spinBox->setSingleStep(1.0);
+    spinBox->setKeyboardTracking(true);
+    return spinBox;
+  }
+  ++_createdWidgetCount;
+  return new CustomDoubleSpinBox(_widget, min, max);
+}
+
+QComboBox * ParameterWidgetPool::comboBox()
+{
+  QComboBox * comboBox = take<QComboBox>();
+  if (comboBox) {
+    comboBox->clear();
+    return comboBox;
+  }
+  ++_createdWidgetCount;
+  return new QComboBox(_widget);
+}
+
+void ParameterWidgetPool::recycle(QWidget * widget, QObject * parameter)
+{
+  if (!widget) {
+    return;
+  }
+  QWidget * parent = widget->parentWidget();
+  ParameterWidgetPool * pool = parent ? get(parent) : nullptr;
+  if (!pool || (pool->_widgets.count(widget->metaObject()) >= PARAMETER_WIDGET_POOL_SIZE)) {
+    delete widget;
+    return;
+  }
+  widget->disconnect(parameter);
+  if (parent->layout()) {
+    parent->layout()->removeWidget(widget);
+  }
+  widget->hide();
+  widget->setEnabled(true);
+  pool->_widgets.insert(widget->metaObject(), widget);
+}
+
+int ParameterWidgetPool::createdWidgetCount() const
+{
+  return _createdWidgetCount;
+}
+
+int ParameterWidgetPool::reusedWidgetCount() const
+{
+  return _reusedWidgetCount;
+}
@@ -0,0 +1,74 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file ParameterWidgetPool.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_PARAMETERWIDGETPOOL_H
+#define GMIC_QT_PARAMETERWIDGETPOOL_H
+
+#include <QMultiHash>
+#include <QObject>
+#include <QPointer>
+#include <QWidget>
+class CustomDoubleSpinBox;
+class QComboBox;
+class QLabel;
+class QSlider;
+class QSpinBox;
+
+/*
+ * Hidden widgets left by the parameters of the previous filter, to be reused by
+ * the parameters of the next one instead of being deleted and allocated again.
+ * Each FilterParametersWidget has its own pool, created on demand as a child.
+ */
+class ParameterWidgetPool : public QObject {
+  Q_OBJECT
+public:
+  static ParameterWidgetPool * get(QWidget * widget);
+
+  QLabel * label(const QString & text);
+  QSlider * slider();
+  QSpinBox * spinBox();
+  CustomDoubleSpinBox * doubleSpinBox(float min, float max);
+  QComboBox * comboBox();
+
+  /**
+   * @brief Disconnect a widget from a parameter, remove it from its layout, hide it
+   *        and keep it for a later use (a null widget is ignored).
+   *        A reused widget gets back the palette, minimum width, tooltip, and for
+   *        spin boxes the single step and keyboard tracking of a new one.
+   */
+  static void recycle(QWidget * widget, QObject * parameter);
+
+  int createdWidgetCount() const;
+  int reusedWidgetCount() const;
+
+private:
+  ParameterWidgetPool(QWidget * widget);
+  template <typename T> T * take();
+  QWidget * _widget;
+  QMultiHash<const QMetaObject *, QPointer<QWidget>> _widgets;
+  int _createdWidgetCount;
+  int _reusedWidgetCount;
+};
+
+#endif // GMIC_QT_PARAMETERWIDGETPOOL_H
@@ -101,6 +101,7 @@ FiltersModel::Filter::Filter()
   _previewFactor = GmicQt::PreviewFactorAny;
   _isAccurateIfZoomed = false;
   _isWarning = false;
+  _tileHalo = -1;
 }
 
 FiltersModel::Filter & FiltersModel::Filter::setName(const QString & name)
@@ -159,6 +160,12 @@ FiltersModel::Filter & FiltersModel::Filter::setWarningFlag(bool flag)
   return *this;
 }
 
+FiltersModel::Filter & FiltersModel::Filter::setTileHalo(int halo)
+{
+  _tileHalo = halo;
+  return *this;
+}
+
 FiltersModel::Filter & FiltersModel::Filter::setDefaultInputMode(GmicQt::InputMode mode)
 {
   _defaultInputMode = mode;
@@ -199,6 +206,11 @@ const QList<QString> & FiltersModel::Filter::path() const
   return _path;
 }
 
+const QList<QString> & FiltersModel::Filter::translatedPlainPath() const
+{
+  return _translatedPlainPath;
+}
+
 const QString & FiltersModel::Filter::hash() const
 {
   return _hash;
@@ -250,6 +262,16 @@ GmicQt::InputMode FiltersModel::Filter::defaultInputMode() const
   return _defaultInputMode;
 }
 
+int FiltersModel::Filter::tileHalo() const
+{
+  return _tileHalo;
+}
+
+bool FiltersModel::Filter::isTileSafe() const
+{
+  return _tileHalo >= 0;
+}
+
 bool FiltersModel::Filter::matchKeywords(const QList<QString> & keywords) const
 {
   QList<QString>::const_iterator itKeyword = keywords.cbegin();
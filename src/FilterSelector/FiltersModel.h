@@ -45,12 +45,14 @@ public:
     Filter & setPath(const QList<QString> & path);
     Filter & setWarningFlag(bool flag);
     Filter & setDefaultInputMode(GmicQt::InputMode);
+    Filter & setTileHalo(int halo);
     Filter & build();
 
     const QString & name() const;
     const QString & plainText() const;
     const QString & translatedPlainText() const;
     const QList<QString> & path() const;
+    const QList<QString> & translatedPlainPath() const;
     const QString & hash() const;
     QString hash236() const;
     const QString & command() const;
@@ -60,11 +62,15 @@ public:
     bool isAccurateIfZoomed() const;
     bool isWarning() const;
     GmicQt::InputMode defaultInputMode() const;
+    int tileHalo() const;
+    bool isTileSafe() const;
 
     bool matchKeywords(const QList<QString> & keywords) const;
     bool matchFullPath(const QList<QString> & path) const;
 
   private:
+    friend class FiltersModelBinaryReader;
+    friend class FiltersModelBinaryWriter;
     QString _name;
     QString _plainText;
     QString _translatedPlainText;
@@ -79,6 +85,7 @@ public:
     bool _isAccurateIfZoomed;
     QString _hash;
     bool _isWarning;
+    int _tileHalo; // -1 if the filter is not tile-safe
   };
 
   FiltersModel() = default;
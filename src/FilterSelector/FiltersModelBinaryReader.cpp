@@ -0,0 +1,179 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersModelBinaryReader.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "FilterSelector/FiltersModelBinaryReader.h"
+#include <QFile>
+#include <QList>
+#include <cstring>
+#include "Common.h"
+#include "Logger.h"
+
+const char FiltersModelBinaryReader::Magic[8] = {'G', 'M', 'I', 'C', 'Q', 'T', 'F', 'I'};
+const quint32 FiltersModelBinaryReader::ByteOrderMark = 0x01020304;
+const quint32 FiltersModelBinaryReader::Version = 1;
+const int FiltersModelBinaryReader::KeySize = 16;
+const int FiltersModelBinaryReader::HeaderSize = 8 + 4 + 4 + 16 + 4 + 4;
+
+namespace
+{
+class Cursor {
+public:
+  Cursor(const char * data, qint64 size) : _position(data), _end(data + size), _ok(true) {}
+  bool ok() const { return _ok; }
+  bool atEnd() const { return _position == _end; }
+
+  qint32 readInt()
+  {
+    qint32 value = 0;
+    if (_end - _position < 4) {
+      _ok = false;
+      return 0;
+    }
+    std::memcpy(&value, _position, 4);
+    _position += 4;
+    return value;
+  }
+
+  float readFloat()
+  {
+    float value = 0.0f;
+    if (_end - _position < 4) {
+      _ok = false;
+      return 0.0f;
+    }
+    std::memcpy(&value, _position, 4);
+    _position += 4;
+    return value;
+  }
+
+  QString readString()
+  {
+    const qint32 length = readInt();
+    const qint64 bytes = 2 * (qint64)length;
+    const qint64 paddedBytes = (bytes + 3) & ~qint64(3);
+    if (!_ok || (length < 0) || (_end - _position < paddedBytes)) {
+      _ok = false;
+      return QString();
+    }
+    // Strings are 4-bytes aligned in the (page aligned) mapped file
+    QString result(reinterpret_cast<const QChar *>(_position), length);
+    _position += paddedBytes;
+    return result;
+  }
+
+  bool skip(qint64 bytes)
+  {
+    if (_end - _position < bytes) {
+      _ok = false;
+      return false;
+    }
+    _position += bytes;
+    return true;
+  }
+  const char * position() const { return _position; }
+
+private:
+  const char * _position;
+  const char * _end;
+  bool _ok;
+};
+} // namespace
+
+FiltersModelBinaryReader::FiltersModelBinaryReader(FiltersModel & model) : _model(model) {}
+
+bool FiltersModelBinaryReader::read(const QString & filename, const QByteArray & key)
+{
+  QFile file(filename);
+  if (!file.open(QFile::ReadOnly)) {
+    return false;
+  }
+  const qint64 size = file.size();
+  if (size < HeaderSize) {
+    return false;
+  }
+  uchar * data = file.map(0, size);
+  bool ok;
+  if (data) {
+    ok = readFilters(reinterpret_cast<const char *>(data), size, key);
+    file.unmap(data);
+  } else {
+    QByteArray array = file.readAll();
+    ok = readFilters(array.constData(), array.size(), key);
+  }
+  if (!ok) {
+    _model.clear();
+  }
+  return ok;
+}
+
+bool FiltersModelBinaryReader::readFilters(const char * data, qint64 size, const QByteArray & key)
+{
+  TIMING;
+  Cursor cursor(data, size);
+  if (std::memcmp(cursor.position(), Magic, sizeof(Magic))) {
+    return false;
+  }
+  cursor.skip(sizeof(Magic));
+  if (((quint32)cursor.readInt() != ByteOrderMark) || ((quint32)cursor.readInt() != Version)) {
+    return false;
+  }
+  if ((key.size() != KeySize) || std::memcmp(cursor.position(), key.constData(), KeySize)) {
+    return false;
+  }
+  cursor.skip(KeySize);
+  const qint32 filterCount = cursor.readInt();
+  cursor.readInt(); // Reserved
+  if (!cursor.ok() || (filterCount < 0)) {
+    return false;
+  }
+  for (qint32 n = 0; n < filterCount; ++n) {
+    FiltersModel::Filter filter;
+    filter._name = cursor.readString();
+    filter._plainText = cursor.readString();
+    filter._translatedPlainText = cursor.readString();
+    filter._command = cursor.readString();
+    filter._previewCommand = cursor.readString();
+    filter._parameters = cursor.readString();
+    filter._hash = cursor.readString();
+    const qint32 pathLength = cursor.readInt();
+    for (qint32 i = 0; (i < pathLength) && cursor.ok(); ++i) {
+      filter._path.push_back(cursor.readString());
+      filter._plainPath.push_back(cursor.readString());
+      filter._translatedPlainPath.push_back(cursor.readString());
+    }
+    filter._defaultInputMode = static_cast<GmicQt::InputMode>(cursor.readInt());
+    filter._previewFactor = cursor.readFloat();
+    const qint32 flags = cursor.readInt();
+    filter._isAccurateIfZoomed = flags & AccurateIfZoomedFlag;
+    filter._isWarning = flags & WarningFlag;
+    filter._tileHalo = cursor.readInt();
+    if (!cursor.ok()) {
+      Logger::warning("Filters index is truncated, it will be rebuilt");
+      return false;
+    }
+    _model.addFilter(filter);
+  }
+  TIMING;
+  return cursor.atEnd();
+}
@@ -0,0 +1,63 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersModelBinaryReader.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_FILTERSMODELBINARYREADER_H
+#define GMIC_QT_FILTERSMODELBINARYREADER_H
+#include <QByteArray>
+#include <QString>
+#include "FilterSelector/FiltersModel.h"
+
+/*
+ * Binary index of the filters definitions, stored in the rc directory.
+ * All integers are 32 bits, in native byte order. Strings are stored as a
+ * length (in QChars) followed by their UTF-16 data, padded to 4 bytes, so
+ * that they can be copied directly from the memory-mapped file.
+ *
+ * Header : magic[8], byteOrderMark, version, key[16], filterCount, reserved
+ * Filter : name, plainText, translatedPlainText, command, previewCommand,
+ *          parameters, hash, pathLength, (path, plainPath, translatedPlainPath)*,
+ *          defaultInputMode, previewFactor, flags, tileHalo
+ */
+class FiltersModelBinaryReader {
+public:
+  FiltersModelBinaryReader(FiltersModel & model);
+  bool read(const QString & filename, const QByteArray & key);
+
+  static const char Magic[8];
+  static const quint32 ByteOrderMark;
+  static const quint32 Version;
+  static const int KeySize;
+  static const int HeaderSize;
+  enum FilterFlags
+  {
+    AccurateIfZoomedFlag = 1,
+    WarningFlag = 2
+  };
+
+private:
+  bool readFilters(const char * data, qint64 size, const QByteArray & key);
+  FiltersModel & _model;
+};
+
+#endif // GMIC_QT_FILTERSMODELBINARYREADER_H
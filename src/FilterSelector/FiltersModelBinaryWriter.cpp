@@ -0,0 +1,90 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersModelBinaryWriter.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "FilterSelector/FiltersModelBinaryWriter.h"
+#include <QSaveFile>
+#include <cstring>
+#include "Common.h"
+#include "FilterSelector/FiltersModelBinaryReader.h"
+#include "Logger.h"
+
+FiltersModelBinaryWriter::FiltersModelBinaryWriter(const FiltersModel & model) : _model(model) {}
+
+bool FiltersModelBinaryWriter::write(const QString & filename, const QByteArray & key)
+{
+  TIMING;
+  Q_ASSERT_X(key.size() == FiltersModelBinaryReader::KeySize, "FiltersModelBinaryWriter::write()", "Bad key size");
+  QByteArray array;
+  array.reserve(4 * 1024 * 1024);
+  array.append(FiltersModelBinaryReader::Magic, sizeof(FiltersModelBinaryReader::Magic));
+  appendInt(array, (qint32)FiltersModelBinaryReader::ByteOrderMark);
+  appendInt(array, (qint32)FiltersModelBinaryReader::Version);
+  array.append(key);
+  appendInt(array, (qint32)_model.filterCount());
+  appendInt(array, 0); // Reserved
+  for (const FiltersModel::Filter & filter : _model) {
+    appendString(array, filter._name);
+    appendString(array, filter._plainText);
+    appendString(array, filter._translatedPlainText);
+    appendString(array, filter._command);
+    appendString(array, filter._previewCommand);
+    appendString(array, filter._parameters);
+    appendString(array, filter._hash);
+    appendInt(array, filter._path.size());
+    for (int i = 0; i < filter._path.size(); ++i) {
+      appendString(array, filter._path[i]);
+      appendString(array, filter._plainPath[i]);
+      appendString(array, filter._translatedPlainPath[i]);
+    }
+    appendInt(array, (qint32)filter._defaultInputMode);
+    qint32 factor;
+    static_assert(sizeof(factor) == sizeof(filter._previewFactor), "float is expected to be 32 bits");
+    std::memcpy(&factor, &filter._previewFactor, sizeof(factor));
+    appendInt(array, factor);
+    appendInt(array, (filter._isAccurateIfZoomed ? FiltersModelBinaryReader::AccurateIfZoomedFlag : 0) | (filter._isWarning ? FiltersModelBinaryReader::WarningFlag : 0));
+    appendInt(array, filter._tileHalo);
+  }
+
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly) || (file.write(array) != array.size()) || !file.commit()) {
+    Logger::warning("Cannot write filters index " + filename);
+    return false;
+  }
+  TIMING;
+  return true;
+}
+
+void FiltersModelBinaryWriter::appendInt(QByteArray & array, qint32 value)
+{
+  array.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void FiltersModelBinaryWriter::appendString(QByteArray & array, const QString & str)
+{
+  appendInt(array, str.size());
+  array.append(reinterpret_cast<const char *>(str.constData()), 2 * str.size());
+  if (str.size() & 1) {
+    array.append(2, '\0');
+  }
+}
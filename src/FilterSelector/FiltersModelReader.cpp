@@ -24,6 +24,7 @@
  */
 #include "FilterSelector/FiltersModelReader.h"
 #include <QBuffer>
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QFileInfo>
 #include <QList>
@@ -31,8 +32,12 @@
 #include <QRegularExpression>
 #include <QSettings>
 #include <QString>
+#include <QVector>
+#include <cstring>
 #include "Common.h"
 #include "FilterSelector/FiltersModel.h"
+#include "FilterSelector/FiltersModelBinaryReader.h"
+#include "FilterSelector/FiltersModelBinaryWriter.h"
 #include "Globals.h"
 #include "LanguageSettings.h"
 #include "Logger.h"
@@ -42,11 +47,217 @@
 
 FiltersModelReader::FiltersModelReader(FiltersModel & model) : _model(model) {}
 
-void FiltersModelReader::parseFiltersDefinitions(QByteArray & stdlibArray)
+void FiltersModelReader::parseFiltersDefinitions(QByteArray & stdlibArray, const QByteArray & stdlibKey)
+{
+  static const bool useIndex = qgetenv("GMIC_QT_NO_FILTERS_INDEX").isEmpty();
+  if (!useIndex || stdlibKey.isEmpty()) {
+    parseFiltersSource(stdlibArray);
+    return;
+  }
+  const QByteArray key = indexKey(stdlibArray, stdlibKey);
+  const QString filename = QString("%1%2").arg(GmicQt::path_rc(true), FILTERS_INDEX_FILENAME);
+  if (FiltersModelBinaryReader(_model).read(filename, key)) {
+    return;
+  }
+  parseFiltersSource(stdlibArray);
+  FiltersModelBinaryWriter(_model).write(filename, key);
+}
+
+QByteArray FiltersModelReader::indexKey(const QByteArray & stdlibArray, const QByteArray & stdlibKey)
+{
+  // Translated texts are stored in the index, so the language is part of the key
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  hash.addData(stdlibKey);
+  hash.addData(QByteArray::number(stdlibArray.size()));
+  hash.addData(LanguageSettings::configuredTranslator().toLocal8Bit());
+  hash.addData(QByteArray::number(gmic_version));
+  return hash.result();
+}
+
+namespace
+{
+inline bool isSpace(char c)
+{
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') || (c == '\v') || (c == '\f');
+}
+
+inline const char * skipSpaces(const char * begin, const char * end)
+{
+  while ((begin < end) && isSpace(*begin)) {
+    ++begin;
+  }
+  return begin;
+}
+
+inline const char * chopSpaces(const char * begin, const char * end)
+{
+  while ((end > begin) && isSpace(end[-1])) {
+    --end;
+  }
+  return end;
+}
+
+inline bool startsWith(const char * begin, const char * end, const char * text, int length)
+{
+  return ((end - begin) >= length) && !std::memcmp(begin, text, length);
+}
+
+/*
+ * Reads the lines of a filters definitions buffer. Comment lines ending with
+ * a '\' are merged with the following comment line. Returned lines include
+ * their trailing '\n' and remain valid until the next call to nextLine().
+ */
+class LineScanner {
+public:
+  LineScanner(const QByteArray & array) : _position(array.constData()), _end(array.constData() + array.size()) {}
+  bool atEnd() const { return _position >= _end; }
+  bool nextLine(const char *& begin, const char *& end)
+  {
+    if (!readRawLine(begin, end)) {
+      return false;
+    }
+    const bool crlf = ((end - begin) >= 2) && (end[-2] == '\r') && (end[-1] == '\n');
+    const bool comment = (skipSpaces(begin, end) < end) && (*skipSpaces(begin, end) == '#');
+    if (!crlf && !(comment && endsWithContinuation(begin, end))) {
+      return true;
+    }
+    _merged.clear();
+    appendLine(begin, end);
+    while (comment && _merged.endsWith("\\\n")) {
+      const char * next = skipSpaces(_position, _end);
+      if ((next >= _end) || (*next != '#')) {
+        break;
+      }
+      const int prefixLength = int(next - _position) + 1;
+      _merged.chop(2);
+      readRawLine(begin, end);
+      const char * text = begin + prefixLength;
+      if (text > end) {
+        text = begin; // Comment prefix spans several lines, keep this one as is
+      } else {
+        const char * limit = (end[-1] == '\n') ? (end - 1) : end;
+        while ((text < limit) && (static_cast<unsigned char>(*text) <= ' ')) {
+          ++text;
+        }
+      }
+      appendLine(text, end);
+    }
+    begin = _merged.constData();
+    end = begin + _merged.size();
+    return true;
+  }
+
+private:
+  bool readRawLine(const char *& begin, const char *& end)
+  {
+    if (_position >= _end) {
+      return false;
+    }
+    begin = _position;
+    const char * eol = static_cast<const char *>(std::memchr(_position, '\n', _end - _position));
+    end = eol ? (eol + 1) : _end;
+    _position = end;
+    return true;
+  }
+  static bool endsWithContinuation(const char * begin, const char * end) { return ((end - begin) >= 2) && (end[-2] == '\\') && (end[-1] == '\n'); }
+  void appendLine(const char * begin, const char * end)
+  {
+    if (((end - begin) >= 2) && (end[-2] == '\r') && (end[-1] == '\n')) {
+      _merged.append(begin, int(end - begin - 2));
+      _merged.append('\n');
+    } else {
+      _merged.append(begin, int(end - begin));
+    }
+  }
+  const char * _position;
+  const char * _end;
+  QByteArray _merged;
+};
+
+struct GuiLine {
+  enum Type
+  {
+    Other,
+    Hide,
+    Folder,
+    Filter
+  } type = Other;
+  const char * prefixEnd = nullptr; // After "#@gui[_xx] "
+  const char * colon = nullptr;     // Filter only
+  bool localized = false;
+};
+
+/*
+ * Classify a line starting with its first non-space character:
+ *   #@gui_xx hide(path)
+ *   #@gui[_xx] Folder name
+ *   #@gui[_xx] Filter name : command, preview_command(factor) : mode
+ */
+GuiLine classifyGuiLine(const char * begin, const char * end, const QByteArray & languageSuffix)
+{
+  GuiLine line;
+  if (!startsWith(begin, end, "#@gui", 5)) {
+    return line;
+  }
+  const char * p = begin + 5;
+  if ((p < end) && (*p == ' ')) {
+    ++p;
+  } else if (startsWith(p, end, languageSuffix.constData(), languageSuffix.size()) && ((p + languageSuffix.size()) < end) && (p[languageSuffix.size()] == ' ')) {
+    p += languageSuffix.size() + 1;
+    line.localized = true;
+  } else {
+    return line;
+  }
+  line.prefixEnd = p;
+  if (line.localized) {
+    const char * hide = p;
+    while ((hide < end) && (*hide == ' ')) {
+      ++hide;
+    }
+    if (startsWith(hide, end, "hide(", 5) && ((end - hide) > 5) && (end[-1] == ')')) {
+      line.type = GuiLine::Hide;
+      return line;
+    }
+  }
+  if (p >= end) {
+    return line;
+  }
+  line.colon = static_cast<const char *>(std::memchr(p, ':', end - p));
+  if (!line.colon) {
+    line.type = GuiLine::Folder;
+  } else if (line.colon > p) {
+    line.type = GuiLine::Filter;
+  }
+  return line;
+}
+
+inline bool isTilesLine(const char * begin, const char * end, int & halo)
+{
+  if (!startsWith(begin, end, "#@gui_tiles", 11)) {
+    return false;
+  }
+  const char * p = begin + 11;
+  if (p == end) {
+    halo = 0;
+    return true;
+  }
+  if ((*p != '(') || (end[-1] != ')')) {
+    return false;
+  }
+  halo = 0;
+  for (++p; p < (end - 1); ++p) {
+    if ((*p < '0') || (*p > '9')) {
+      return false;
+    }
+    halo = 10 * halo + (*p - '0');
+  }
+  return true;
+}
+} // namespace
+
+void FiltersModelReader::parseFiltersSource(QByteArray & stdlibArray)
 {
   TIMING;
-  QBuffer stdlib(&stdlibArray);
-  stdlib.open(QBuffer::ReadOnly | QBuffer::Text);
   QList<QString> filterPath;
 
   QString language = LanguageSettings::configuredTranslator();
@@ -59,140 +270,142 @@ void FiltersModelReader::parseFiltersDefinitions(QByteArray & stdlibArray)
   if (!textIsPrecededBySpacesInSomeLineOfArray(localePrefix, stdlibArray)) {
     language = "en";
   }
+  const QByteArray languageSuffix = QString("_%1").arg(language).toLocal8Bit();
 
-  QString buffer = readBufferLine(stdlib);
-  QString line;
-
-  QRegExp folderRegexpNoLanguage("^\\s*#@gui[ ][^:]+$");
-  QRegExp folderRegexpLanguage(QString("^\\s*#@gui_%1[ ][^:]+$").arg(language));
-
-  QRegExp filterRegexpNoLanguage("^\\s*#@gui[ ][^:]+[ ]*:.*");
-  QRegExp filterRegexpLanguage(QString("^\\s*#@gui_%1[ ][^:]+[ ]*:.*").arg(language));
-
-  QRegExp hideCommandRegExp(QString("^\\s*#@gui_%1[ ]+hide\\((.*)\\)").arg(language));
-  QRegExp guiComment("^\\s*#@gui");
   QVector<QString> hiddenPaths;
-
   const QChar WarningPrefix('!');
-  do {
-    line = buffer.trimmed();
-    if (guiComment.indexIn(line) == 0) {
-      if (hideCommandRegExp.exactMatch(line)) {
-        QString path = hideCommandRegExp.cap(1);
-        hiddenPaths.push_back(path);
-        buffer = readBufferLine(stdlib);
-      } else if (folderRegexpNoLanguage.exactMatch(line) || folderRegexpLanguage.exactMatch(line)) {
-        //
-        // A folder
-        //
-        QString folderName = line;
-        folderName.replace(QRegExp("^\\s*#@gui[_a-zA-Z]{0,3}[ ]"), "");
-
-        while (folderName.startsWith("_") && !filterPath.isEmpty()) {
-          folderName.remove(0, 1);
-          filterPath.pop_back();
-        }
-        while (folderName.startsWith("_")) {
-          folderName.remove(0, 1);
-        }
-        if (!folderName.isEmpty()) {
-          filterPath.push_back(folderName);
-        }
-        buffer = readBufferLine(stdlib);
-      } else if (filterRegexpNoLanguage.exactMatch(line) || filterRegexpLanguage.exactMatch(line)) {
-        //
-        // A filter
-        //
-        QString filterName = line;
-        filterName.replace(QRegExp("[ ]*:.*$"), "");
-        filterName.replace(QRegExp("^\\s*#@gui[_a-zA-Z]{0,3}[ ]"), "");
-        const bool warning = filterName.startsWith(WarningPrefix);
-        if (warning) {
-          filterName.remove(0, 1);
-        }
+  LineScanner scanner(stdlibArray);
+  const char * begin = nullptr;
+  const char * end = nullptr;
+  bool hasLine = scanner.nextLine(begin, end);
+  while (hasLine) {
+    const char * lineBegin = skipSpaces(begin, end);
+    const char * lineEnd = chopSpaces(lineBegin, end);
+    const GuiLine gui = classifyGuiLine(lineBegin, lineEnd, languageSuffix);
+    if (gui.type == GuiLine::Hide) {
+      const char * path = static_cast<const char *>(std::memchr(gui.prefixEnd, '(', lineEnd - gui.prefixEnd)) + 1;
+      hiddenPaths.push_back(QString::fromUtf8(path, int(lineEnd - 1 - path)));
+      hasLine = scanner.nextLine(begin, end);
+    } else if (gui.type == GuiLine::Folder) {
+      //
+      // A folder
+      //
+      QString folderName = QString::fromUtf8(gui.prefixEnd, int(lineEnd - gui.prefixEnd));
+      while (folderName.startsWith("_") && !filterPath.isEmpty()) {
+        folderName.remove(0, 1);
+        filterPath.pop_back();
+      }
+      while (folderName.startsWith("_")) {
+        folderName.remove(0, 1);
+      }
+      if (!folderName.isEmpty()) {
+        filterPath.push_back(folderName);
+      }
+      hasLine = scanner.nextLine(begin, end);
+    } else if (gui.type == GuiLine::Filter) {
+      //
+      // A filter
+      //
+      const char * nameEnd = gui.colon;
+      while ((nameEnd > gui.prefixEnd) && (nameEnd[-1] == ' ')) {
+        --nameEnd;
+      }
+      QString filterName = QString::fromUtf8(gui.prefixEnd, int(nameEnd - gui.prefixEnd));
+      const bool warning = filterName.startsWith(WarningPrefix);
+      if (warning) {
+        filterName.remove(0, 1);
+      }
 
-        QString filterCommands = line;
-        filterCommands.replace(QRegExp("^\\s*#@gui[_a-zA-Z]{0,3}[ ][^:]+[ ]*:[ ]*"), "");
+      const char * commandsBegin = gui.colon + 1;
+      while ((commandsBegin < lineEnd) && (*commandsBegin == ' ')) {
+        ++commandsBegin;
+      }
+      const char * commandsEnd = lineEnd;
 
-        // Extract default input mode
-        GmicQt::InputMode defaultInputMode = GmicQt::UnspecifiedInputMode;
-        QRegExp reInputMode("\\s*:\\s*([xX.*+vViI-])\\s*$");
-        if (reInputMode.indexIn(filterCommands) != -1) {
-          QString mode = reInputMode.cap(1);
-          filterCommands.remove(reInputMode);
-          defaultInputMode = symbolToInputMode(mode);
+      // Extract default input mode (e.g. " : *" at the end of the line)
+      GmicQt::InputMode defaultInputMode = GmicQt::UnspecifiedInputMode;
+      if ((commandsEnd - commandsBegin) >= 2 && commandsEnd[-1] && std::strchr("xX.*+vViI-", commandsEnd[-1])) {
+        const char * modeColon = chopSpaces(commandsBegin, commandsEnd - 1);
+        if ((modeColon > commandsBegin) && (modeColon[-1] == ':')) {
+          defaultInputMode = symbolToInputMode(QString(QChar(commandsEnd[-1])));
+          commandsEnd = chopSpaces(commandsBegin, modeColon - 1);
         }
+      }
 
-        QList<QString> commands = filterCommands.split(",");
-        QString filterCommand = commands[0].trimmed();
-        if (commands.isEmpty()) {
-          commands.push_back("_none_");
-        }
-        if (commands.size() == 1) {
-          commands.push_back(commands.front());
-        }
-        QList<QString> preview = commands[1].trimmed().split("(");
-        float previewFactor = GmicQt::PreviewFactorAny;
-        bool accurateIfZoomed = true;
-        if (preview.size() >= 2) {
-          if (preview[1].endsWith("+")) {
-            accurateIfZoomed = true;
-            preview[1].chop(1);
-          } else {
-            accurateIfZoomed = false;
-          }
-          previewFactor = preview[1].replace(QRegExp("\\).*"), "").toFloat();
+      QList<QString> commands = QString::fromUtf8(commandsBegin, int(commandsEnd - commandsBegin)).split(",");
+      QString filterCommand = commands[0].trimmed();
+      if (commands.size() == 1) {
+        commands.push_back(commands.front());
+      }
+      QList<QString> preview = commands[1].trimmed().split("(");
+      float previewFactor = GmicQt::PreviewFactorAny;
+      bool accurateIfZoomed = true;
+      if (preview.size() >= 2) {
+        if (preview[1].endsWith("+")) {
+          accurateIfZoomed = true;
+          preview[1].chop(1);
+        } else {
+          accurateIfZoomed = false;
         }
-        QString filterPreviewCommand = preview[0].trimmed();
-
-        //        FiltersTreeFilterItem * filterItem = new FiltersTreeFilterItem(filterName,
-        //                                                                       filterCommand,
-        //                                                                       filterPreviewCommand,
-        //                                                                       previewFactor,
-        //                                                                       accurateIfZoomed);
-        // filterItem->setWarningFlag(warning);
+        const int parenthesis = preview[1].indexOf(')');
+        previewFactor = ((parenthesis == -1) ? preview[1] : preview[1].left(parenthesis)).toFloat();
+      }
+      QString filterPreviewCommand = preview[0].trimmed();
 
-        QString start = line;
-        start.replace(QRegExp("^\\s*"), "");
-        start.replace(QRegExp(" .*"), " :");
-        QRegExp startRegexp(QString("^\\s*%1").arg(start));
+      // Parameters lines start with the same prefix as the filter line, e.g. "#@gui_fr :"
+      QByteArray parametersPrefix(lineBegin, int(gui.prefixEnd - lineBegin));
+      parametersPrefix += ':';
 
-        // Read parameters
-        QString parameters;
-        do {
-          buffer = readBufferLine(stdlib);
-          if (startRegexp.indexIn(buffer) == 0) {
-            QString parameterLine = buffer;
-            parameterLine.replace(QRegExp("^\\s*#@gui[_a-zA-Z]{0,3}[ ]*:[ ]*"), "");
-            parameters += parameterLine;
+      // Read parameters
+      QByteArray parameters;
+      int tileHalo = -1;
+      while ((hasLine = scanner.nextLine(begin, end))) {
+        const char * parameterBegin = skipSpaces(begin, end);
+        if (startsWith(parameterBegin, end, parametersPrefix.constData(), parametersPrefix.size())) {
+          const char * parameter = parameterBegin + parametersPrefix.size();
+          while ((parameter < end) && (*parameter == ' ')) {
+            ++parameter;
           }
-        } while (!stdlib.atEnd()                               //
-                 && !folderRegexpNoLanguage.exactMatch(buffer) //
-                 && !folderRegexpLanguage.exactMatch(buffer)   //
-                 && !filterRegexpNoLanguage.exactMatch(buffer) //
-                 && !filterRegexpLanguage.exactMatch(buffer));
-
-        FiltersModel::Filter filter;
-        filter.setName(filterName);
-        filter.setCommand(filterCommand);
-        filter.setPreviewCommand(filterPreviewCommand);
-        filter.setDefaultInputMode(defaultInputMode);
-        filter.setPreviewFactor(previewFactor);
-        filter.setAccurateIfZoomed(accurateIfZoomed);
-        filter.setParameters(parameters);
-        filter.setPath(filterPath);
-        filter.setWarningFlag(warning);
-        filter.build();
-        _model.addFilter(filter);
-      } else {
-        buffer = readBufferLine(stdlib);
+          parameters.append(parameter, int(end - parameter));
+        } else {
+          int halo;
+          if (isTilesLine(parameterBegin, chopSpaces(parameterBegin, end), halo)) {
+            tileHalo = halo;
+          }
+        }
+        if (scanner.atEnd()) {
+          break;
+        }
+        // A hide line has the syntax of a localized folder line, hence also ends the parameters
+        const GuiLine::Type type = classifyGuiLine(parameterBegin, end, languageSuffix).type;
+        if ((type == GuiLine::Folder) || (type == GuiLine::Filter) || (type == GuiLine::Hide)) {
+          break;
+        }
       }
+
+      FiltersModel::Filter filter;
+      filter.setName(filterName);
+      filter.setCommand(filterCommand);
+      filter.setPreviewCommand(filterPreviewCommand);
+      filter.setDefaultInputMode(defaultInputMode);
+      filter.setPreviewFactor(previewFactor);
+      filter.setAccurateIfZoomed(accurateIfZoomed);
+      filter.setParameters(QString::fromUtf8(parameters));
+      filter.setPath(filterPath);
+      filter.setWarningFlag(warning);
+      filter.setTileHalo(tileHalo);
+      filter.build();
+      _model.addFilter(filter);
     } else {
-      buffer = readBufferLine(stdlib);
+      hasLine = scanner.nextLine(begin, end);
     }
-  } while (!buffer.isEmpty());
+  }
+  removeHiddenPaths(hiddenPaths);
+  TIMING;
+}
 
-  // Remove hidden filters from the model
+void FiltersModelReader::removeHiddenPaths(const QVector<QString> & hiddenPaths)
+{
   for (const QString & path : hiddenPaths) {
     const size_t count = _model.filterCount();
     QList<QString> pathList = path.split("/", QT_SKIP_EMPTY_PARTS);
@@ -201,7 +414,6 @@ void FiltersModelReader::parseFiltersDefinitions(QByteArray & stdlibArray)
       Logger::warning(QString("While hiding filter, name or path not found: \"%1\"").arg(path));
     }
   }
-  TIMING;
 }
 
 bool FiltersModelReader::textIsPrecededBySpacesInSomeLineOfArray(const QByteArray & text, const QByteArray & array)
@@ -254,40 +466,3 @@ GmicQt::InputMode FiltersModelReader::symbolToInputMode(const QString & str)
     return GmicQt::UnspecifiedInputMode;
   }
 }
-
-QString FiltersModelReader::readBufferLine(QBuffer & buffer)
-{
-  // QBuffer::readline(max_size) may be very slow, in debug mode, when max_size
-  // is too big (e.g. 1MB). We read large lines in multiple calls.
-  QString result;
-  QString text;
-  QRegExp commentStart("^\\s*#");
-  do {
-    text = buffer.readLine(1024);
-    result.append(text);
-  } while (!text.isEmpty() && !text.endsWith("\n"));
-
-  // Merge comment lines ending with '\'
-  if (commentStart.indexIn(result) == 0) {
-    while (result.endsWith("\\\n")) {
-      QString nextLinePeek = buffer.peek(1024);
-      if (commentStart.indexIn(nextLinePeek) == -1) {
-        return result;
-      }
-      const QString nextCommentPrefix = commentStart.cap(0);
-      result.chop(2);
-      QString nextLine;
-      do {
-        text = buffer.readLine(1024);
-        nextLine.append(text);
-      } while (!text.isEmpty() && !text.endsWith("\n"));
-      int ignoreCount = nextCommentPrefix.length();
-      const int limit = nextLine.length() - nextLine.endsWith("\n");
-      while (ignoreCount < limit && nextLine[ignoreCount] <= ' ') {
-        ++ignoreCount;
-      }
-      result.append(nextLine.rightRef(nextLine.length() - ignoreCount));
-    }
-  }
-  return result;
-}
@@ -25,19 +25,30 @@
 #ifndef GMIC_QT_FILTERSMODELREADER_H
 #define GMIC_QT_FILTERSMODELREADER_H
 #include <QString>
+#include <QVector>
 #include "FilterSelector/FiltersModel.h"
 
 class QByteArray;
-class QBuffer;
 
 class FiltersModelReader {
 public:
   FiltersModelReader(FiltersModel & model);
-  void parseFiltersDefinitions(QByteArray & stdlibArray);
+  /**
+   * @brief Fill the model, from the binary index in the rc directory when it
+   *        matches the given definitions, otherwise by parsing them (and
+   *        writing a new index).
+   *
+   * @param stdlibKey Identifies the definitions (see GmicStdLib::Key), the
+   *        index is not used if empty
+   */
+  void parseFiltersDefinitions(QByteArray & stdlibArray, const QByteArray & stdlibKey);
 
 private:
+  friend class FiltersModelReaderBenchmark;
   FiltersModel & _model;
-  static QString readBufferLine(QBuffer &);
+  void parseFiltersSource(QByteArray & stdlibArray);
+  void removeHiddenPaths(const QVector<QString> & hiddenPaths);
+  static QByteArray indexKey(const QByteArray & stdlibArray, const QByteArray & stdlibKey);
   static bool textIsPrecededBySpacesInSomeLineOfArray(const QByteArray & text, const QByteArray & array);
   static GmicQt::InputMode symbolToInputMode(const QString & str);
 };
@@ -25,6 +25,7 @@
 #include "FilterSelector/FiltersPresenter.h"
 #include <QDebug>
 #include <QSettings>
+#include <QStringList>
 #include "Common.h"
 #include "FilterSelector/FavesModelReader.h"
 #include "FilterSelector/FavesModelWriter.h"
@@ -41,6 +42,7 @@
 FiltersPresenter::FiltersPresenter(QObject * parent) : QObject(parent)
 {
   _filtersView = nullptr;
+  _filtersViewIsOutdated = true;
 }
 
 FiltersPresenter::~FiltersPresenter()
@@ -67,47 +69,98 @@ void FiltersPresenter::rebuildFilterView()
 
 void FiltersPresenter::rebuildFilterViewWithSelection(const QList<QString> & keywords)
 {
+  // The tree holds all filters and faves, the keywords only hide some of its rows
+  _searchKeywords = keywords;
   _filtersView->clear();
   _filtersView->disableModel();
   for (const FiltersModel::Filter & filter : _filtersModel) {
-    if (filter.matchKeywords(keywords)) {
-      _filtersView->addFilter(filter.name(), filter.hash(), filter.path(), filter.isWarning());
-    }
+    _filtersView->addFilter(filter.name(), filter.hash(), filter.path(), filter.isWarning());
   }
-  FavesModel::const_iterator itFave = _favesModel.cbegin();
-  while (itFave != _favesModel.cend()) {
-    if (itFave->matchKeywords(keywords)) {
-      _filtersView->addFave(itFave->name(), itFave->hash());
-    }
-    ++itFave;
+  for (const FavesModel::Fave & fave : _favesModel) {
+    _filtersView->addFave(fave.name(), fave.hash());
   }
   _filtersView->sort();
 
   QString header = QObject::tr("Available filters (%1)").arg(_filtersModel.notTestingFilterCount());
   _filtersView->setHeader(header);
   _filtersView->enableModel();
+  if (!keywords.isEmpty()) {
+    _filtersView->showOnlyFilters(searchMatches(keywords));
+  }
+  _filtersViewIsOutdated = false;
 }
 
 void FiltersPresenter::clear()
 {
   _favesModel.clear();
   _filtersModel.clear();
+  _searchIndex.invalidate();
+  _filtersViewIsOutdated = true;
 }
 
 void FiltersPresenter::readFilters()
 {
   _filtersModel.clear();
+  _searchIndex.invalidate();
+  _filtersViewIsOutdated = true;
   if (GmicStdLib::Array.isEmpty()) {
     GmicStdLib::loadStdLib();
   }
   FiltersModelReader filterModelReader(_filtersModel);
-  filterModelReader.parseFiltersDefinitions(GmicStdLib::Array);
+  filterModelReader.parseFiltersDefinitions(GmicStdLib::Array, GmicStdLib::Key);
 }
 
 void FiltersPresenter::readFaves()
 {
   FavesModelReader favesModelReader(_favesModel);
   favesModelReader.loadFaves();
+  _searchIndex.invalidate();
+  _filtersViewIsOutdated = true;
+}
+
+bool FiltersPresenter::updateFilters(const FiltersModel & model)
+{
+  const QString currentHash = _currentFilter.hash;
+  QString currentFilterHash = currentHash;
+  if (_currentFilter.isAFave && _favesModel.contains(currentHash)) {
+    currentFilterHash = _favesModel.getFaveFromHash(currentHash).originalHash();
+  }
+  bool currentFilterChanged = false;
+
+  // Since the hash depends on name and commands, a filter with a known hash
+  // can only have been moved, or have had its parameters edited.
+  for (const FiltersModel::Filter & filter : _filtersModel) {
+    if (!model.contains(filter.hash())) {
+      _filtersView->removeFilter(filter.hash(), filter.path());
+      currentFilterChanged = currentFilterChanged || (filter.hash() == currentFilterHash);
+    }
+  }
+  for (const FiltersModel::Filter & filter : model) {
+    if (_filtersModel.contains(filter.hash())) {
+      const FiltersModel::Filter & previous = _filtersModel.getFilterFromHash(filter.hash());
+      if (filter.hash() == currentFilterHash) {
+        currentFilterChanged = (previous.parameters() != filter.parameters()) || (previous.previewFactor() != filter.previewFactor()) ||
+                               (previous.isAccurateIfZoomed() != filter.isAccurateIfZoomed()) || (previous.defaultInputMode() != filter.defaultInputMode()) ||
+                               (previous.tileHalo() != filter.tileHalo());
+      }
+      if ((previous.path() == filter.path()) && (previous.isWarning() == filter.isWarning())) {
+        continue;
+      }
+      _filtersView->removeFilter(previous.hash(), previous.path());
+    }
+    _filtersView->addFilter(filter.name(), filter.hash(), filter.path(), filter.isWarning());
+  }
+  _filtersModel = model;
+  _searchIndex.invalidate();
+  _filtersView->sort();
+  if (!_searchKeywords.isEmpty()) {
+    _filtersView->showOnlyFilters(searchMatches(_searchKeywords));
+  }
+  _filtersView->setHeader(QObject::tr("Available filters (%1)").arg(_filtersModel.notTestingFilterCount()));
+  if (!currentHash.isEmpty()) {
+    selectFilterFromHash(currentHash, false);
+  }
+  return currentFilterChanged;
 }
 
 bool FiltersPresenter::allFavesAreValid() const
@@ -152,6 +205,8 @@ void FiltersPresenter::restoreFaveHashLinksAfterCaseChange()
     ++itFormerFave;
   }
   if (someFavesHaveBeenRelinked) {
+    _searchIndex.invalidate();
+    _filtersViewIsOutdated = true;
     saveFaves();
   }
 }
@@ -160,6 +215,8 @@ void FiltersPresenter::importGmicGTKFaves()
 {
   FavesModelReader favesModelReader(_favesModel);
   favesModelReader.importFavesFromGmicGTK();
+  _searchIndex.invalidate();
+  _filtersViewIsOutdated = true;
 }
 
 void FiltersPresenter::saveFaves()
@@ -202,6 +259,7 @@ void FiltersPresenter::addSelectedFilterAsNewFave(const QList<QString> & default
   fave.build();
   FiltersVisibilityMap::setVisibility(fave.hash(), true);
   _favesModel.addFave(fave);
+  _searchIndex.invalidate();
   ParametersCache::setValues(fave.hash(), defaultValues);
   ParametersCache::setVisibilityStates(fave.hash(), visibilityStates);
   ParametersCache::setInputOutputState(fave.hash(), inOutState, _currentFilter.defaultInputMode);
@@ -217,22 +275,23 @@ void FiltersPresenter::addSelectedFilterAsNewFave(const QList<QString> & default
 
 void FiltersPresenter::applySearchCriterion(const QString & text)
 {
-  static QString previousText;
-  if ((!text.isEmpty() && previousText.isEmpty()) || (text.isEmpty() && previousText.isEmpty())) {
-    _filtersView->preserveExpandedFolders();
-  }
   QList<QString> keywords = text.split(QChar(' '), QT_SKIP_EMPTY_PARTS);
-
-  rebuildFilterViewWithSelection(keywords);
-  if (text.isEmpty()) {
+  if (_filtersViewIsOutdated) {
+    _filtersView->preserveExpandedFolders();
+    rebuildFilterViewWithSelection(QList<QString>());
     _filtersView->restoreExpandedFolders();
-  } else {
-    _filtersView->expandAll();
+  }
+  if (keywords != _searchKeywords) {
+    if (keywords.isEmpty()) {
+      _filtersView->showAllFilters();
+    } else {
+      _filtersView->showOnlyFilters(searchMatches(keywords));
+    }
+    _searchKeywords = keywords;
   }
   if (!_currentFilter.hash.isEmpty()) {
     selectFilterFromHash(_currentFilter.hash, false);
   }
-  previousText = text;
 }
 
 void FiltersPresenter::selectFilterFromHash(QString hash, bool notify)
@@ -354,6 +413,7 @@ void FiltersPresenter::onFaveRenamed(const QString & hash, const QString & name)
   ParametersCache::setInputOutputState(fave.hash(), inOutState, defaultInputMode);
 
   _favesModel.addFave(fave);
+  _searchIndex.invalidate();
   _filtersView->updateFaveItem(hash, fave.hash(), fave.name());
   _filtersView->sortFaves();
   saveFaves();
@@ -363,6 +423,7 @@ void FiltersPresenter::onFaveRenamed(const QString & hash, const QString & name)
 
 void FiltersPresenter::toggleSelectionMode(bool on)
 {
+  _filtersViewIsOutdated = true;
   if (on) {
     _filtersView->enableSelectionMode();
   } else {
@@ -383,6 +444,7 @@ void FiltersPresenter::removeFave(const QString & hash)
   }
   ParametersCache::remove(hash);
   _favesModel.removeFave(hash);
+  _searchIndex.invalidate();
   _filtersView->removeFave(hash);
   saveFaves();
   onFilterChanged(_filtersView->selectedFilterHash());
@@ -422,6 +484,7 @@ void FiltersPresenter::setCurrentFilter(const QString & hash)
       _currentFilter.previewCommand = fave.previewCommand();
       _currentFilter.isAccurateIfZoomed = filter.isAccurateIfZoomed();
       _currentFilter.previewFactor = filter.previewFactor();
+      _currentFilter.tileHalo = filter.tileHalo();
     } else {
       setInvalidFilter();
       _errorMessage = tr("Cannot find this fave's original filter\n");
@@ -440,11 +503,24 @@ void FiltersPresenter::setCurrentFilter(const QString & hash)
     _currentFilter.previewCommand = filter.previewCommand();
     _currentFilter.isAccurateIfZoomed = filter.isAccurateIfZoomed();
     _currentFilter.previewFactor = filter.previewFactor();
+    _currentFilter.tileHalo = filter.tileHalo();
   } else {
     _currentFilter.clear();
   }
 }
 
+QSet<QString> FiltersPresenter::searchMatches(const QList<QString> & keywords)
+{
+  if (!_searchIndex.isValid()) {
+    _searchIndex.build(_filtersModel, _favesModel);
+  }
+  QSet<QString> hashes;
+  for (int entry : _searchIndex.search(keywords)) {
+    hashes.insert(_searchIndex.hash(entry));
+  }
+  return hashes;
+}
+
 bool FiltersPresenter::filterExistsAsFave(const QString filterHash)
 {
   for (const FavesModel::Fave & fave : _favesModel) {
@@ -465,6 +541,7 @@ void FiltersPresenter::Filter::clear()
   hash.clear();
   plainTextName.clear();
   previewFactor = GmicQt::PreviewFactorAny;
+  tileHalo = -1;
   defaultInputMode = GmicQt::UnspecifiedInputMode;
   isAFave = false;
 }
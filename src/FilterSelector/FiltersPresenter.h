@@ -25,8 +25,10 @@
 #ifndef GMIC_QT_FILTERSPRESENTER_H
 #define GMIC_QT_FILTERSPRESENTER_H
 #include <QObject>
+#include <QSet>
 #include "FilterSelector/FavesModel.h"
 #include "FilterSelector/FiltersModel.h"
+#include "FilterSelector/FiltersSearchIndex.h"
 #include "FilterSelector/FiltersView/FiltersView.h"
 #include "InputOutputState.h"
 #include "gmic_qt.h"
@@ -48,6 +50,7 @@ public:
     QString hash;
     bool isAccurateIfZoomed;
     float previewFactor;
+    int tileHalo; // -1 if the filter is not tile-safe
     bool isAFave;
     void clear();
     void setInvalid();
@@ -67,6 +70,15 @@ public:
   void readFilters();
   void readFaves();
 
+  /**
+   * @brief Replace the filters with the ones of another model, only updating
+   *        the tree items of filters that were added, removed, or moved.
+   *
+   * @return true if the definition of the current filter has changed (or if the
+   *         filter no longer exists)
+   */
+  bool updateFilters(const FiltersModel & model);
+
   bool allFavesAreValid() const;
   bool danglingFaveIsSelected() const;
 
@@ -119,12 +131,16 @@ private slots:
 private:
   void setCurrentFilter(const QString & hash);
   bool filterExistsAsFave(const QString filterHash);
+  QSet<QString> searchMatches(const QList<QString> & keywords);
 
   FiltersModel _filtersModel;
   FavesModel _favesModel;
+  FiltersSearchIndex _searchIndex;
   FiltersView * _filtersView;
   Filter _currentFilter;
   QString _errorMessage;
+  QList<QString> _searchKeywords;
+  bool _filtersViewIsOutdated; // Filters or faves were reloaded, or the selection mode has changed
 };
 
 #endif // GMIC_QT_FILTERSPRESENTER_H
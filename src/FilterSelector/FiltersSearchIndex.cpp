@@ -0,0 +1,187 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersSearchIndex.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "FilterSelector/FiltersSearchIndex.h"
+#include <QObject>
+#include <QStringList>
+#include <algorithm>
+#include <iterator>
+#include "Common.h"
+#include "FilterSelector/FavesModel.h"
+#include "FilterSelector/FiltersModel.h"
+#include "Globals.h"
+#include "HtmlTranslator.h"
+
+FiltersSearchIndex::FiltersSearchIndex() : _isValid(false) {}
+
+void FiltersSearchIndex::build(const FiltersModel & filtersModel, const FavesModel & favesModel)
+{
+  _entries.clear();
+  _postings.clear();
+  _cache.clear();
+  _entries.reserve(filtersModel.filterCount() + favesModel.faveCount());
+  for (const FiltersModel::Filter & filter : filtersModel) {
+    QString text = filter.translatedPlainText();
+    for (const QString & str : filter.translatedPlainPath()) {
+      text += QChar('\n');
+      text += str;
+    }
+    addEntry(filter.hash(), text, false);
+  }
+  static const QString faveFolderPlainText = HtmlTranslator::html2txt(QObject::tr(FAVE_FOLDER_TEXT));
+  for (const FavesModel::Fave & fave : favesModel) {
+    addEntry(fave.hash(), faveFolderPlainText + QChar('\n') + fave.plainText(), true);
+  }
+  _isValid = true;
+}
+
+void FiltersSearchIndex::invalidate()
+{
+  _isValid = false;
+}
+
+bool FiltersSearchIndex::isValid() const
+{
+  return _isValid;
+}
+
+std::vector<int> FiltersSearchIndex::search(const QList<QString> & keywords)
+{
+  std::vector<int> result;
+  if (keywords.isEmpty()) {
+    result.resize(_entries.size());
+    for (size_t entry = 0; entry < _entries.size(); ++entry) {
+      result[entry] = (int)entry;
+    }
+    return result;
+  }
+  result = matches(keywords.front().toCaseFolded());
+  for (int i = 1; i < keywords.size() && !result.empty(); ++i) {
+    const std::vector<int> & keywordMatches = matches(keywords[i].toCaseFolded());
+    std::vector<int> intersection;
+    std::set_intersection(result.begin(), result.end(), keywordMatches.begin(), keywordMatches.end(), std::back_inserter(intersection));
+    result.swap(intersection);
+  }
+  return result;
+}
+
+const QString & FiltersSearchIndex::hash(int entry) const
+{
+  return _entries[entry].hash;
+}
+
+bool FiltersSearchIndex::isFave(int entry) const
+{
+  return _entries[entry].isFave;
+}
+
+void FiltersSearchIndex::addEntry(const QString & hash, const QString & text, bool isFave)
+{
+  const int entry = (int)_entries.size();
+  _entries.push_back(Entry{hash, text.toCaseFolded(), isFave});
+  const QString & folded = _entries.back().text;
+  const QChar * data = folded.constData();
+  for (int i = 0; i + 3 <= folded.size(); ++i) {
+    if ((data[i] == QChar('\n')) || (data[i + 1] == QChar('\n')) || (data[i + 2] == QChar('\n'))) {
+      continue;
+    }
+    std::vector<int> & postings = _postings[trigram(data + i)];
+    if (postings.empty() || (postings.back() != entry)) {
+      postings.push_back(entry);
+    }
+  }
+}
+
+const std::vector<int> & FiltersSearchIndex::matches(const QString & keyword)
+{
+  QHash<QString, std::vector<int>>::const_iterator cached = _cache.constFind(keyword);
+  if (cached != _cache.constEnd()) {
+    return cached.value();
+  }
+
+  // Candidates are the matches of the longest cached prefix, if any...
+  std::vector<int> candidates;
+  bool allEntriesAreCandidates = true;
+  for (int length = keyword.size() - 1; (length > 0) && allEntriesAreCandidates; --length) {
+    cached = _cache.constFind(keyword.left(length));
+    if (cached != _cache.constEnd()) {
+      candidates = cached.value();
+      allEntriesAreCandidates = false;
+    }
+  }
+
+  // ...refined with the posting lists of the trigrams of the keyword, shortest first
+  if (keyword.size() >= 3) {
+    std::vector<const std::vector<int> *> lists;
+    for (int i = 0; i + 3 <= keyword.size(); ++i) {
+      QHash<quint64, std::vector<int>>::const_iterator it = _postings.constFind(trigram(keyword.constData() + i));
+      if (it == _postings.constEnd()) {
+        candidates.clear();
+        allEntriesAreCandidates = false;
+        lists.clear();
+        break;
+      }
+      lists.push_back(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const std::vector<int> * a, const std::vector<int> * b) { return a->size() < b->size(); });
+    for (const std::vector<int> * list : lists) {
+      if (allEntriesAreCandidates) {
+        candidates = *list;
+        allEntriesAreCandidates = false;
+        continue;
+      }
+      std::vector<int> intersection;
+      std::set_intersection(candidates.begin(), candidates.end(), list->begin(), list->end(), std::back_inserter(intersection));
+      candidates.swap(intersection);
+      if (candidates.empty()) {
+        break;
+      }
+    }
+  }
+
+  // Trigrams may come from different places of an entry's text, check candidates
+  std::vector<int> result;
+  if (allEntriesAreCandidates) {
+    for (size_t entry = 0; entry < _entries.size(); ++entry) {
+      if (_entries[entry].text.contains(keyword)) {
+        result.push_back((int)entry);
+      }
+    }
+  } else {
+    for (int entry : candidates) {
+      if (_entries[entry].text.contains(keyword)) {
+        result.push_back(entry);
+      }
+    }
+  }
+  if (_cache.size() >= FILTERS_SEARCH_CACHE_SIZE) {
+    _cache.clear();
+  }
+  return _cache.insert(keyword, result).value();
+}
+
+quint64 FiltersSearchIndex::trigram(const QChar * text)
+{
+  return (quint64(text[0].unicode()) << 32) | (quint64(text[1].unicode()) << 16) | quint64(text[2].unicode());
+}
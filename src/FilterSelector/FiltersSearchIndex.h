@@ -0,0 +1,75 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersSearchIndex.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_FILTERSSEARCHINDEX_H
+#define GMIC_QT_FILTERSSEARCHINDEX_H
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+class FiltersModel;
+class FavesModel;
+
+/*
+ * Trigram index over the texts matched by the search field: the translated plain
+ * names and path components of the filters, and the names of the faves.
+ * A keyword is looked up by intersecting the posting lists of its trigrams, the
+ * remaining candidates being checked with QString::contains(). Matches are cached
+ * per keyword, and the matches of a keyword's longest cached prefix are used as
+ * candidates, so that each typed character only refines the previous result.
+ */
+class FiltersSearchIndex {
+public:
+  FiltersSearchIndex();
+  void build(const FiltersModel & filtersModel, const FavesModel & favesModel);
+  void invalidate();
+  bool isValid() const;
+
+  /**
+   * @brief Entries (filters first, then faves, in the iteration order of
+   *        the models) matching all the keywords, case insensitively
+   */
+  std::vector<int> search(const QList<QString> & keywords);
+  const QString & hash(int entry) const;
+  bool isFave(int entry) const;
+
+private:
+  friend class FiltersSearchIndexBenchmark;
+  struct Entry {
+    QString hash;
+    QString text; // Case folded texts, separated by '\n'
+    bool isFave;
+  };
+  void addEntry(const QString & hash, const QString & text, bool isFave);
+  const std::vector<int> & matches(const QString & keyword);
+  static quint64 trigram(const QChar * text);
+  std::vector<Entry> _entries;
+  QHash<quint64, std::vector<int>> _postings;
+  QHash<QString, std::vector<int>> _cache;
+  bool _isValid;
+};
+
+#endif // GMIC_QT_FILTERSSEARCHINDEX_H
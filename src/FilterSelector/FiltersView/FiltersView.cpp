@@ -135,6 +135,30 @@ void FiltersView::addFilter(const QString & text, const QString & hash, const QL
   }
 }
 
+void FiltersView::removeFilter(const QString & hash, const QList<QString> & path)
+{
+  QStandardItem * folder = getFolderFromPath(path);
+  if (!folder) {
+    return;
+  }
+  for (int row = 0; row < folder->rowCount(); ++row) {
+    auto item = dynamic_cast<FilterTreeItem *>(folder->child(row));
+    if (item && (item->hash() == hash)) {
+      folder->removeRow(row);
+      break;
+    }
+  }
+  // Remove folders left empty
+  QStandardItem * root = _model.invisibleRootItem();
+  while ((folder != root) && (folder != _faveFolder) && !folder->rowCount()) {
+    QStandardItem * parent = folder->parent() ? folder->parent() : root;
+    parent->removeRow(folder->row());
+    folder = parent;
+  }
+  _cachedFolder = root;
+  _cachedFolderPath.clear();
+}
+
 void FiltersView::addFave(const QString & text, const QString & hash)
 {
   const bool faveIsVisible = FiltersVisibilityMap::filterIsVisible(hash);
@@ -143,6 +167,8 @@ void FiltersView::addFave(const QString & text, const QString & hash)
   }
   if (!_faveFolder) {
     createFaveFolder();
+  } else if (ui->treeView->isRowHidden(_faveFolder->row(), QModelIndex())) {
+    ui->treeView->setRowHidden(_faveFolder->row(), QModelIndex(), false);
   }
   auto item = new FilterTreeItem(text);
   item->setHash(hash);
@@ -161,7 +187,7 @@ void FiltersView::selectFave(const QString & hash)
   // Select the fave if the model is enabled
   if (ui->treeView->model() == &_model) {
     FilterTreeItem * fave = findFave(hash);
-    if (fave) {
+    if (fave && !ui->treeView->isRowHidden(fave->row(), _faveFolder->index())) {
       ui->treeView->setCurrentIndex(fave->index());
       ui->treeView->scrollTo(fave->index(), QAbstractItemView::PositionAtCenter);
     }
@@ -175,6 +201,9 @@ void FiltersView::selectActualFilter(const QString & hash, const QList<QString>
     for (int row = 0; row < folder->rowCount(); ++row) {
       auto filter = dynamic_cast<FilterTreeItem *>(folder->child(row));
       if (filter && (filter->hash() == hash)) {
+        if (ui->treeView->isRowHidden(row, folder->index())) {
+          return;
+        }
         ui->treeView->setCurrentIndex(filter->index());
         ui->treeView->scrollTo(filter->index(), QAbstractItemView::PositionAtCenter);
         return;
@@ -201,6 +230,7 @@ void FiltersView::clear()
   _model.setColumnCount(1);
   _cachedFolder = _model.invisibleRootItem();
   _cachedFolderPath.clear();
+  _foldersExpandedBySearch.clear();
 }
 
 void FiltersView::sort()
@@ -287,6 +317,32 @@ void FiltersView::restoreExpandedFolders()
   expandFolders(_expandedFolderPaths);
 }
 
+void FiltersView::showOnlyFilters(const QSet<QString> & hashes)
+{
+  // Hiding rows does not touch the model, so no item is created or destroyed
+  ui->treeView->setUpdatesEnabled(false);
+  updateRowsVisibility(_model.invisibleRootItem(), &hashes);
+  ui->treeView->setUpdatesEnabled(true);
+}
+
+void FiltersView::showAllFilters()
+{
+  ui->treeView->setUpdatesEnabled(false);
+  updateRowsVisibility(_model.invisibleRootItem(), nullptr);
+  for (const QPersistentModelIndex & index : _foldersExpandedBySearch) {
+    if (index.isValid()) {
+      ui->treeView->collapse(index);
+    }
+  }
+  _foldersExpandedBySearch.clear();
+  ui->treeView->setUpdatesEnabled(true);
+}
+
+int FiltersView::itemCount() const
+{
+  return itemCount(_model.invisibleRootItem());
+}
+
 void FiltersView::loadSettings(const QSettings &)
 {
   FiltersVisibilityMap::load();
@@ -511,7 +567,7 @@ void FiltersView::preserveExpandedFolders(QStandardItem * folder, QList<QString>
   for (int row = 0; row < rows; ++row) {
     auto subFolder = dynamic_cast<FilterTreeFolder *>(folder->child(row));
     if (subFolder) {
-      if (ui->treeView->isExpanded(subFolder->index())) {
+      if (ui->treeView->isExpanded(subFolder->index()) && !_foldersExpandedBySearch.contains(QPersistentModelIndex(subFolder->index()))) {
         list.push_back(subFolder->path().join(FilterTreePathSeparator));
       }
       preserveExpandedFolders(subFolder, list);
@@ -519,6 +575,42 @@ void FiltersView::preserveExpandedFolders(QStandardItem * folder, QList<QString>
   }
 }
 
+bool FiltersView::updateRowsVisibility(QStandardItem * folder, const QSet<QString> * hashes)
+{
+  const QModelIndex folderIndex = folder->index();
+  bool someRowIsVisible = false;
+  const int rows = folder->rowCount();
+  for (int row = 0; row < rows; ++row) {
+    QStandardItem * child = folder->child(row);
+    auto filter = dynamic_cast<FilterTreeItem *>(child);
+    bool rowIsVisible;
+    if (filter) {
+      rowIsVisible = !hashes || hashes->contains(filter->hash());
+    } else {
+      rowIsVisible = updateRowsVisibility(child, hashes) || !hashes;
+    }
+    if (ui->treeView->isRowHidden(row, folderIndex) == rowIsVisible) {
+      ui->treeView->setRowHidden(row, folderIndex, !rowIsVisible);
+    }
+    someRowIsVisible = someRowIsVisible || rowIsVisible;
+  }
+  if (hashes && someRowIsVisible && folderIndex.isValid() && !ui->treeView->isExpanded(folderIndex)) {
+    ui->treeView->expand(folderIndex);
+    _foldersExpandedBySearch.push_back(QPersistentModelIndex(folderIndex));
+  }
+  return someRowIsVisible;
+}
+
+int FiltersView::itemCount(const QStandardItem * folder)
+{
+  int result = 0;
+  const int rows = folder->rowCount();
+  for (int row = 0; row < rows; ++row) {
+    result += 1 + itemCount(folder->child(row));
+  }
+  return result;
+}
+
 void FiltersView::createFaveFolder()
 {
   if (_faveFolder) {
@@ -29,6 +29,8 @@
 #include <QList>
 #include <QMenu>
 #include <QModelIndex>
+#include <QPersistentModelIndex>
+#include <QSet>
 #include <QStandardItemModel>
 #include <QString>
 #include <QWidget>
@@ -53,6 +55,7 @@ public:
   void disableModel();
   void createFolder(const QList<QString> & path);
   void addFilter(const QString & text, const QString & hash, const QList<QString> & path, bool warning);
+  void removeFilter(const QString & hash, const QList<QString> & path);
   void addFave(const QString & text, const QString & hash);
   void selectFave(const QString & hash);
   void selectActualFilter(const QString & hash, const QList<QString> & path);
@@ -69,6 +72,18 @@ public:
   void preserveExpandedFolders();
   void restoreExpandedFolders();
 
+  /**
+   * @brief Hide the rows of the filters and faves whose hash is not in the set,
+   *        and of the folders left empty. Folders with visible filters are expanded.
+   */
+  void showOnlyFilters(const QSet<QString> & hashes);
+
+  /**
+   * @brief Show all rows, collapsing the folders expanded by showOnlyFilters()
+   */
+  void showAllFilters();
+  int itemCount() const;
+
   void loadSettings(const QSettings & settings);
   void saveSettings(QSettings & settings);
 
@@ -108,6 +123,8 @@ private:
   void expandFolders(const QList<QString> & folderPaths, QStandardItem * folder);
   void uncheckFullyUncheckedFolders(QStandardItem * folder);
   void preserveExpandedFolders(QStandardItem * folder, QList<QString> & list);
+  bool updateRowsVisibility(QStandardItem * folder, const QSet<QString> * hashes);
+  static int itemCount(const QStandardItem * folder);
   void createFaveFolder();
   void removeFaveFolder();
   void addStandardItemWithCheckbox(QStandardItem * folder, FilterTreeAbstractItem * item);
@@ -124,6 +141,7 @@ private:
   QList<QString> _cachedFolderPath;
   QStandardItem * _cachedFolder;
   QList<QString> _expandedFolderPaths;
+  QList<QPersistentModelIndex> _foldersExpandedBySearch;
   static const QString FilterTreePathSeparator;
   bool _isInSelectionMode;
   QMenu * _faveContextMenu;
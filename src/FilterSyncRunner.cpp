@@ -24,10 +24,12 @@
  */
 #include "FilterSyncRunner.h"
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QThread>
 #include <iostream>
+#include "CroppedImageListProxy.h"
 #include "FilterThread.h"
-#include "GmicStdlib.h"
+#include "GmicInterpreterPool.h"
 #include "ImageConverter.h"
 #include "Logger.h"
 #include "Utils.h"
@@ -47,7 +49,10 @@ FilterSyncRunner::FilterSyncRunner(QObject * parent, const QString & name, const
 #endif
   _gmicAbort = false;
   _failed = false;
+  _copiedInputBytes = 0;
+  _runDuration = 0;
   _gmicProgress = 0.0f;
+  _keepsOutputs = false;
 }
 
 FilterSyncRunner::~FilterSyncRunner()
@@ -71,9 +76,9 @@ void FilterSyncRunner::swapImages(cimg_library::CImgList<float> & images)
   _images->swap(images);
 }
 
-void FilterSyncRunner::setInputImages(const cimg_library::CImgList<float> & list)
+void FilterSyncRunner::setInputImages(std::shared_ptr<const cimg_library::CImgList<float>> images)
 {
-  *_images = list;
+  _inputImages = std::move(images);
 }
 
 const cimg_library::CImgList<float> & FilterSyncRunner::images() const
@@ -128,11 +133,41 @@ QString FilterSyncRunner::fullCommand() const
   return result;
 }
 
+std::size_t FilterSyncRunner::copiedInputBytes() const
+{
+  return _copiedInputBytes;
+}
+
+int FilterSyncRunner::runDuration() const
+{
+  return _runDuration;
+}
+
 void FilterSyncRunner::setLogSuffix(const QString & text)
 {
   _logSuffix = text;
 }
 
+void FilterSyncRunner::setPreviewFrameSettings(const PreviewFrame::Settings & settings)
+{
+  _previewFrameSettings = settings;
+}
+
+void FilterSyncRunner::setKeepsOutputs(bool on)
+{
+  _keepsOutputs = on;
+}
+
+std::shared_ptr<const PreviewFrame> FilterSyncRunner::previewFrame() const
+{
+  return _previewFrame;
+}
+
+std::shared_ptr<cimg_library::CImgList<float>> FilterSyncRunner::keptOutputs() const
+{
+  return _keptOutputs;
+}
+
 void FilterSyncRunner::abortGmic()
 {
   _gmicAbort = true;
@@ -140,24 +175,37 @@ void FilterSyncRunner::abortGmic()
 
 void FilterSyncRunner::run()
 {
+  QElapsedTimer timer;
+  timer.start();
   _errorMessage.clear();
   _failed = false;
+  if (_inputImages) {
+    _copiedInputBytes = CroppedImageListProxy::detach(_inputImages, *_images);
+  }
   QString fullCommandLine;
+  gmic * gmicInstance = nullptr;
   try {
     fullCommandLine = QString::fromLocal8Bit(GmicQt::commandFromOutputMessageMode(_messageMode));
     GmicQt::appendWithSpace(fullCommandLine, _command);
     GmicQt::appendWithSpace(fullCommandLine, _arguments);
-    _gmicAbort = false;
     _gmicProgress = -1;
     if (_messageMode > GmicQt::Quiet) {
       Logger::log(fullCommandLine, _logSuffix, true);
     }
-    gmic gmicInstance(_environment.isEmpty() ? nullptr : QString("%1").arg(_environment).toLocal8Bit().constData(), GmicStdLib::Array.constData(), true, 0, 0, 0.f);
-    gmicInstance.set_variable("_host", GmicQt::HostApplicationShortname, '=');
-    gmicInstance.set_variable("_tk", "qt", '=');
-    gmicInstance.run(fullCommandLine.toLocal8Bit().constData(), *_images, *_imageNames, &_gmicProgress, &_gmicAbort);
-    _gmicStatus = gmicInstance.status;
+    TIMING;
+    gmicInstance = GmicInterpreterPool::acquire(_command, _environment, _messageMode);
+    TIMING;
+    gmicInstance->run(fullCommandLine.toLocal8Bit().constData(), *_images, *_imageNames, &_gmicProgress, &_gmicAbort);
+    TIMING;
+    _gmicStatus = gmicInstance->status;
+    if (_gmicAbort) {
+      // The run may have been interrupted in the middle of any command
+      GmicInterpreterPool::discard(gmicInstance);
+    } else {
+      GmicInterpreterPool::release(gmicInstance);
+    }
   } catch (gmic_exception & e) {
+    GmicInterpreterPool::discard(gmicInstance);
     _images->assign();
     _imageNames->assign();
     const char * message = e.what();
@@ -167,4 +215,11 @@ void FilterSyncRunner::run()
     }
     _failed = true;
   }
+  if (_previewFrameSettings.enabled && !_failed && !_gmicAbort) {
+    if (_keepsOutputs) {
+      _keptOutputs = std::make_shared<cimg_library::CImgList<float>>(*_images);
+    }
+    _previewFrame = PreviewFrame::build(*_images, _previewFrameSettings);
+  }
+  _runDuration = static_cast<int>(timer.elapsed());
 }
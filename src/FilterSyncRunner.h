@@ -27,10 +27,13 @@
 
 #include <QObject>
 #include <QString>
+#include <cstddef>
+#include <memory>
 #include <QTime>
 
 #include "Common.h"
 #include "Host/host.h"
+#include "PreviewFrame.h"
 #include "gmic_qt.h"
 
 class QObject;
@@ -47,7 +50,7 @@ public:
 
   virtual ~FilterSyncRunner();
   void setArguments(const QString &);
-  void setInputImages(const cimg_library::CImgList<float> & list);
+  void setInputImages(std::shared_ptr<const cimg_library::CImgList<float>> images);
   void setImageNames(const cimg_library::CImgList<char> & imageNames);
   void swapImages(cimg_library::CImgList<float> & images);
   const cimg_library::CImgList<float> & images() const;
@@ -60,7 +63,19 @@ public:
   float progress() const;
   QString name() const;
   QString fullCommand() const;
+  std::size_t copiedInputBytes() const;
+  int runDuration() const; // Time (ms) spent in the last run(), preview frame included
   void setLogSuffix(const QString & text);
+
+  /**
+   * @brief Have outputs composed into a preview frame at the end of run(),
+   *        by the thread running the filter
+   */
+  void setPreviewFrameSettings(const PreviewFrame::Settings & settings);
+  void setKeepsOutputs(bool on); // Outputs are copied before being composed into the frame
+  std::shared_ptr<const PreviewFrame> previewFrame() const;
+  std::shared_ptr<cimg_library::CImgList<float>> keptOutputs() const;
+
   void run();
   void abortGmic();
 
@@ -69,6 +84,9 @@ private:
   QString _arguments;
   QString _environment;
   cimg_library::CImgList<float> * _images;
+  std::shared_ptr<const cimg_library::CImgList<float>> _inputImages;
+  std::size_t _copiedInputBytes;
+  int _runDuration;
   cimg_library::CImgList<char> * _imageNames;
   bool _gmicAbort;
   bool _failed;
@@ -78,6 +96,10 @@ private:
   QString _name;
   QString _logSuffix;
   GmicQt::OutputMessageMode _messageMode;
+  PreviewFrame::Settings _previewFrameSettings;
+  bool _keepsOutputs;
+  std::shared_ptr<const PreviewFrame> _previewFrame;
+  std::shared_ptr<cimg_library::CImgList<float>> _keptOutputs;
 };
 
 #endif // GMIC_QT_FILTERSYNCRUNNER_H
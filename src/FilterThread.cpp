@@ -25,8 +25,9 @@
 #include "FilterThread.h"
 #include <QDebug>
 #include <iostream>
+#include "CroppedImageListProxy.h"
 #include "FilterParameters/AbstractParameter.h"
-#include "GmicStdlib.h"
+#include "GmicInterpreterPool.h"
 #include "ImageConverter.h"
 #include "Logger.h"
 #include "Utils.h"
@@ -39,6 +40,7 @@ FilterThread::FilterThread(QObject * parent, const QString & name, const QString
 {
   _gmicAbort = false;
   _failed = false;
+  _copiedInputBytes = 0;
   _gmicProgress = 0.0f;
   // ENTERING;
 #ifdef _IS_MACOS_
@@ -67,9 +69,9 @@ void FilterThread::swapImages(cimg_library::CImgList<float> & images)
   _images->swap(images);
 }
 
-void FilterThread::setInputImages(const cimg_library::CImgList<float> & list)
+void FilterThread::setInputImages(std::shared_ptr<const cimg_library::CImgList<float>> images)
 {
-  *_images = list;
+  _inputImages = std::move(images);
 }
 
 const cimg_library::CImgList<float> & FilterThread::images() const
@@ -189,6 +191,11 @@ QString FilterThread::fullCommand() const
   return result;
 }
 
+std::size_t FilterThread::copiedInputBytes() const
+{
+  return _copiedInputBytes;
+}
+
 void FilterThread::setLogSuffix(const QString & text)
 {
   _logSuffix = text;
@@ -204,7 +211,11 @@ void FilterThread::run()
   _startTime.start();
   _errorMessage.clear();
   _failed = false;
+  if (_inputImages) {
+    _copiedInputBytes = CroppedImageListProxy::detach(_inputImages, *_images);
+  }
   QString fullCommandLine;
+  gmic * gmicInstance = nullptr;
   try {
     fullCommandLine = QString::fromLocal8Bit(GmicQt::commandFromOutputMessageMode(_messageMode));
     GmicQt::appendWithSpace(fullCommandLine, _command);
@@ -214,12 +225,20 @@ void FilterThread::run()
     if (_messageMode > GmicQt::Quiet) {
       Logger::log(fullCommandLine, _logSuffix, true);
     }
-    gmic gmicInstance(_environment.isEmpty() ? nullptr : QString("%1").arg(_environment).toLocal8Bit().constData(), GmicStdLib::Array.constData(), true, 0, 0, 0.0f);
-    gmicInstance.set_variable("_host", GmicQt::HostApplicationShortname, '=');
-    gmicInstance.set_variable("_tk", "qt", '=');
-    gmicInstance.run(fullCommandLine.toLocal8Bit().constData(), *_images, *_imageNames, &_gmicProgress, &_gmicAbort);
-    _gmicStatus = gmicInstance.status;
+    TIMING;
+    gmicInstance = GmicInterpreterPool::acquire(_command, _environment, _messageMode);
+    TIMING;
+    gmicInstance->run(fullCommandLine.toLocal8Bit().constData(), *_images, *_imageNames, &_gmicProgress, &_gmicAbort);
+    TIMING;
+    _gmicStatus = gmicInstance->status;
+    if (_gmicAbort) {
+      // The run may have been interrupted in the middle of any command
+      GmicInterpreterPool::discard(gmicInstance);
+    } else {
+      GmicInterpreterPool::release(gmicInstance);
+    }
   } catch (gmic_exception & e) {
+    GmicInterpreterPool::discard(gmicInstance);
     _images->assign();
     _imageNames->assign();
     const char * message = e.what();
@@ -27,6 +27,8 @@
 
 #include <QElapsedTimer>
 #include <QString>
+#include <cstddef>
+#include <memory>
 #include <QThread>
 
 #include "Common.h"
@@ -46,7 +48,7 @@ public:
 
   virtual ~FilterThread();
   void setArguments(const QString &);
-  void setInputImages(const cimg_library::CImgList<float> & list);
+  void setInputImages(std::shared_ptr<const cimg_library::CImgList<float>> images);
   void setImageNames(const cimg_library::CImgList<char> & imageNames);
   void swapImages(cimg_library::CImgList<float> & images);
   const cimg_library::CImgList<float> & images() const;
@@ -60,6 +62,7 @@ public:
   float progress() const;
   QString name() const;
   QString fullCommand() const;
+  std::size_t copiedInputBytes() const;
   void setLogSuffix(const QString & text);
 
   static QStringList status2StringList(const QString &);
@@ -75,10 +78,13 @@ protected:
   void run() override;
 
 private:
+  friend class TiledFilterThread;
   QString _command;
   QString _arguments;
   QString _environment;
   cimg_library::CImgList<float> * _images;
+  std::shared_ptr<const cimg_library::CImgList<float>> _inputImages;
+  std::size_t _copiedInputBytes;
   cimg_library::CImgList<char> * _imageNames;
   bool _gmicAbort;
   bool _failed;
@@ -0,0 +1,68 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersUpdateThread.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "FiltersUpdateThread.h"
+#include "Common.h"
+#include "FilterSelector/FiltersModelReader.h"
+#include "Updater.h"
+
+FiltersUpdateThread::FiltersUpdateThread(QObject * parent, const QByteArray & currentStdlib) : QThread(parent), _stdlib(currentStdlib), _stdlibChanged(false) {}
+
+FiltersUpdateThread::~FiltersUpdateThread() {}
+
+bool FiltersUpdateThread::stdlibChanged() const
+{
+  return _stdlibChanged;
+}
+
+const QByteArray & FiltersUpdateThread::stdlib() const
+{
+  return _stdlib;
+}
+
+const QByteArray & FiltersUpdateThread::stdlibKey() const
+{
+  return _stdlibKey;
+}
+
+const FiltersModel & FiltersUpdateThread::filtersModel() const
+{
+  return _filtersModel;
+}
+
+void FiltersUpdateThread::run()
+{
+  TIMING;
+  QByteArray key;
+  QByteArray stdlib = Updater::getInstance()->buildFullStdlib(&key);
+  if (stdlib == _stdlib) {
+    return;
+  }
+  _stdlib = stdlib;
+  _stdlibKey = key;
+  _stdlibChanged = true;
+  FiltersModelReader reader(_filtersModel);
+  reader.parseFiltersDefinitions(_stdlib, _stdlibKey);
+  TIMING;
+}
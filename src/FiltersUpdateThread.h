@@ -0,0 +1,60 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file FiltersUpdateThread.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_FILTERSUPDATETHREAD_H
+#define GMIC_QT_FILTERSUPDATETHREAD_H
+
+#include <QByteArray>
+#include <QThread>
+#include "FilterSelector/FiltersModel.h"
+
+/**
+ * @brief Builds the stdlib from the (already updated) sources and parses
+ *        its filters definitions, away from the GUI thread.
+ *
+ * Parsing is skipped when the stdlib is identical to the one the
+ * thread was given.
+ */
+class FiltersUpdateThread : public QThread {
+  Q_OBJECT
+
+public:
+  FiltersUpdateThread(QObject * parent, const QByteArray & currentStdlib);
+  ~FiltersUpdateThread() override;
+  bool stdlibChanged() const;
+  const QByteArray & stdlib() const;
+  const QByteArray & stdlibKey() const;
+  const FiltersModel & filtersModel() const;
+
+protected:
+  void run() override;
+
+private:
+  QByteArray _stdlib;
+  QByteArray _stdlibKey;
+  bool _stdlibChanged;
+  FiltersModel _filtersModel;
+};
+
+#endif // GMIC_QT_FILTERSUPDATETHREAD_H
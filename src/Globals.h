@@ -37,12 +37,21 @@ extern const float PreviewFactorActualSize;
 } // namespace GmicQt
 
 #define SLIDER_MIN_WIDTH 60
-#define PARAMETERS_CACHE_FILENAME "gmic_qt_params.dat"
+#define PARAMETER_WIDGET_POOL_SIZE 32                  // Hidden widgets of each type kept for the next filter
+#define PARAMETERS_CACHE_FILENAME "gmic_qt_params.dat" // JSON file of previous versions
+#define PARAMETERS_JOURNAL_FILENAME "gmic_qt_params.journal"
+#define PARAMETERS_JOURNAL_COMPACTION_SIZE (64 * 1024) // Superseded records tolerated before compaction
+#define PARAMETERS_JOURNAL_LOCK_TIMEOUT 5000            // ms, other processes may be saving their parameters
 #define FILTERS_VISIBILITY_FILENAME "gmic_qt_visibility.dat"
+#define FILTERS_INDEX_FILENAME "gmic_qt_filters.idx"
+#define STDLIB_CACHE_FILENAME "gmic_qt_stdlib.dat"
 
 #define FAVE_FOLDER_TEXT "<b>Faves</b>"
 #define FAVES_IMPORT_KEY "Faves/ImportedGTK179"
 
+#define FILTERS_SEARCH_CACHE_SIZE 512   // Keywords whose matches are kept while typing
+#define HTML_TRANSLATOR_CACHE_SIZE 4096 // Plain texts of html strings, per thread
+
 #define DARK_THEME_KEY "Config/DarkTheme"
 #define REFRESH_USING_INTERNET_KEY "Config/RefreshInternetUpdate"
 #define INTERNET_UPDATE_PERIODICITY_KEY "Config/UpdatesPeriodicityValue"
@@ -51,6 +60,27 @@ extern const float PreviewFactorActualSize;
 
 #define PREVIEW_MAX_ZOOM_FACTOR 40.0
 
+#define PREVIEW_TILE_SIZE 256
+#define PREVIEW_TILE_CACHE_DEFAULT_SIZE 256 // MB
+#define PREVIEW_WORKER_COUNT 2
+#define PREVIEW_TARGET_FRAME_TIME_MS 80
+#define PREVIEW_MIN_DOWNSCALE_FACTOR 1.25
+#define PREVIEW_MAX_DOWNSCALE_FACTOR 8.0
+#define PREVIEW_INTERACTION_DELAY_MS 300 // Preview requests closer than this come from an interaction
+#define PREVIEW_REUSE_MAX_SIZE 256       // MB, largest preview output kept to be applied as is
+#define PREVIEW_GRID_MAX_OUTPUTS 16      // More outputs are laid out by gui_preview
+#define PREVIEW_GRID_SPACING 2
+
+#define EVENT_LOOP_MONITOR_INTERVAL_MS 5
+
+#define WORKER_MAX_ATTEMPTS 2     // Runs of a job before it is considered as crashing its workers
+#define WORKER_MAX_RESTARTS 5     // Respawns of a worker process
+#define WORKER_BANDS_PER_WORKER 2 // Tiled jobs
+#define WORKER_QUIT_TIMEOUT_MS 2000
+#define WORKER_DEFAULT_TILE_HALO 16
+
+#define PARALLEL_ROWS_MINIMUM_PIXELS (512 * 512)
+
 #define KEYPOINTS_INTERACTIVE_LOWER_DELAY_MS 150
 #define KEYPOINTS_INTERACTIVE_UPPER_DELAY_MS 500
 #define KEYPOINTS_INTERACTIVE_MIDDLE_DELAY_MS ((KEYPOINTS_INTERACTIVE_LOWER_DELAY_MS + KEYPOINTS_INTERACTIVE_UPPER_DELAY_MS) / 2)
@@ -0,0 +1,245 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file GmicInterpreterPool.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "GmicInterpreterPool.h"
+#include <QByteArray>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QString>
+#include <QThread>
+#include <algorithm>
+#include "Common.h"
+#include "GmicStdlib.h"
+#include "Host/host.h"
+#include "Utils.h"
+#include "gmic.h"
+
+QMutex GmicInterpreterPool::_mutex;
+QList<gmic *> GmicInterpreterPool::_idleInterpreters;
+QHash<gmic *, GmicInterpreterPool::Entry> GmicInterpreterPool::_entries;
+unsigned int GmicInterpreterPool::_generation = 0;
+int GmicInterpreterPool::_createdCount = 0;
+QThread * GmicInterpreterPool::_prewarmThread = nullptr;
+
+class GmicInterpreterPrewarmThread : public QThread {
+public:
+  GmicInterpreterPrewarmThread(const QByteArray & stdlib, unsigned int generation) : _stdlib(stdlib), _generation(generation) {}
+
+protected:
+  void run() override
+  {
+    gmic * interpreter = nullptr;
+    try {
+      gmic * instance = new gmic(nullptr, _stdlib.constData(), true, 0, 0, 0.0f);
+      instance->set_variable("_host", GmicQt::HostApplicationShortname, '=');
+      instance->set_variable("_tk", "qt", '=');
+      interpreter = instance;
+    } catch (...) {
+      interpreter = nullptr;
+    }
+    QMutexLocker locker(&GmicInterpreterPool::_mutex);
+    GmicInterpreterPool::_prewarmThread = nullptr;
+    if (interpreter) {
+      ++GmicInterpreterPool::_createdCount;
+      GmicInterpreterPool::insertIdle(interpreter, _generation);
+    }
+  }
+
+private:
+  QByteArray _stdlib;
+  unsigned int _generation;
+};
+
+gmic * GmicInterpreterPool::acquire(const QString & command, const QString & environment, GmicQt::OutputMessageMode mode)
+{
+  // Verbosity commands ("v 3", "debug") leave a persistent state in the interpreter
+  const bool reusable = isEnabled() && !*GmicQt::commandFromOutputMessageMode(mode);
+  gmic * interpreter = nullptr;
+  Entry entry;
+  {
+    QMutexLocker locker(&_mutex);
+    if (reusable) {
+      // Most recently used interpreter of this command, or else a pristine one
+      int found = -1;
+      for (int i = _idleInterpreters.size() - 1; i >= 0; --i) {
+        const QString & previousCommand = _entries[_idleInterpreters[i]].command;
+        if (previousCommand == command) {
+          found = i;
+          break;
+        }
+        if ((found == -1) && previousCommand.isEmpty()) {
+          found = i;
+        }
+      }
+      if (found != -1) {
+        interpreter = _idleInterpreters.takeAt(found);
+        entry = _entries.value(interpreter);
+      }
+    }
+    if (!interpreter) {
+      entry.generation = _generation;
+    }
+  }
+  if (!interpreter) {
+    interpreter = createInterpreter();
+  }
+  entry.reusable = reusable;
+  entry.command = command;
+  setEnvironment(interpreter, entry, environment);
+  QMutexLocker locker(&_mutex);
+  _entries[interpreter] = entry;
+  return interpreter;
+}
+
+void GmicInterpreterPool::release(gmic * interpreter)
+{
+  if (!interpreter) {
+    return;
+  }
+  QMutexLocker locker(&_mutex);
+  const Entry entry = _entries.value(interpreter);
+  if (entry.reusable) {
+    interpreter->status.assign();
+    insertIdle(interpreter, entry.generation);
+  } else {
+    _entries.remove(interpreter);
+    locker.unlock();
+    delete interpreter;
+  }
+}
+
+void GmicInterpreterPool::discard(gmic * interpreter)
+{
+  if (!interpreter) {
+    return;
+  }
+  {
+    QMutexLocker locker(&_mutex);
+    _entries.remove(interpreter);
+  }
+  delete interpreter;
+}
+
+void GmicInterpreterPool::clear()
+{
+  QList<gmic *> interpreters;
+  {
+    QMutexLocker locker(&_mutex);
+    ++_generation;
+    interpreters.swap(_idleInterpreters);
+    for (gmic * interpreter : interpreters) {
+      _entries.remove(interpreter);
+    }
+  }
+  for (gmic * interpreter : interpreters) {
+    delete interpreter;
+  }
+}
+
+void GmicInterpreterPool::prewarm()
+{
+  if (!isEnabled() || GmicStdLib::Array.isEmpty()) {
+    return;
+  }
+  QMutexLocker locker(&_mutex);
+  if (_prewarmThread || !_idleInterpreters.isEmpty()) {
+    return;
+  }
+  _prewarmThread = new GmicInterpreterPrewarmThread(GmicStdLib::Array, _generation);
+  QObject::connect(_prewarmThread, &QThread::finished, _prewarmThread, &QObject::deleteLater);
+  _prewarmThread->start(QThread::LowPriority);
+}
+
+bool GmicInterpreterPool::isEnabled()
+{
+  static const bool enabled = qgetenv("GMIC_QT_NO_INTERPRETER_POOL").isEmpty();
+  return enabled;
+}
+
+int GmicInterpreterPool::maxIdleInterpreters()
+{
+  static const int count = std::max(2, QThread::idealThreadCount());
+  return count;
+}
+
+int GmicInterpreterPool::createdInterpreterCount()
+{
+  QMutexLocker locker(&_mutex);
+  return _createdCount;
+}
+
+gmic * GmicInterpreterPool::createInterpreter()
+{
+  TIMING;
+  auto interpreter = new gmic(nullptr, GmicStdLib::Array.constData(), true, 0, 0, 0.0f);
+  TIMING;
+  QMutexLocker locker(&_mutex);
+  ++_createdCount;
+  return interpreter;
+}
+
+void GmicInterpreterPool::setEnvironment(gmic * interpreter, Entry & entry, const QString & environment)
+{
+  interpreter->set_variable("_host", GmicQt::HostApplicationShortname, '=');
+  interpreter->set_variable("_tk", "qt", '=');
+  QStringList names;
+  const QStringList assignments = environment.split(QChar(' '), QT_SKIP_EMPTY_PARTS);
+  for (const QString & assignment : assignments) {
+    const int equal = assignment.indexOf(QChar('='));
+    if (equal <= 0) {
+      continue;
+    }
+    const QByteArray name = assignment.left(equal).toLocal8Bit();
+    const QByteArray value = assignment.mid(equal + 1).toLocal8Bit();
+    interpreter->set_variable(name.constData(), value.constData(), '=');
+    names.push_back(assignment.left(equal));
+  }
+  // Variables of the previous run that are not part of this environment (e.g. _preview_* for an apply)
+  for (const QString & name : entry.environmentVariables) {
+    if (!names.contains(name)) {
+      interpreter->set_variable(name.toLocal8Bit().constData(), "", '=');
+    }
+  }
+  entry.environmentVariables = names;
+}
+
+void GmicInterpreterPool::insertIdle(gmic * interpreter, unsigned int generation)
+{
+  // Caller must hold _mutex
+  if (generation != _generation) {
+    _entries.remove(interpreter);
+    delete interpreter;
+    return;
+  }
+  if (_idleInterpreters.size() >= maxIdleInterpreters()) {
+    // Least recently used one is dropped
+    gmic * oldest = _idleInterpreters.takeFirst();
+    _entries.remove(oldest);
+    delete oldest;
+  }
+  Entry & entry = _entries[interpreter];
+  entry.generation = generation;
+  entry.reusable = true;
+  _idleInterpreters.push_back(interpreter);
+}
@@ -0,0 +1,100 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file GmicInterpreterPool.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_GMICINTERPRETERPOOL_H
+#define GMIC_QT_GMICINTERPRETERPOOL_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+#include "gmic_qt.h"
+
+struct gmic;
+class QThread;
+
+/**
+ * @brief Long-lived G'MIC interpreters with the full stdlib already parsed.
+ *
+ * Constructing a gmic instance parses every command of GmicStdLib::Array,
+ * which dominates the latency of cheap filters. Interpreters are checked out
+ * with acquire() and handed back with release() (or discard() if the run
+ * failed or was aborted). Global variables, stored images and commands defined
+ * by a filter stay in the interpreter, hence an interpreter is only reused by
+ * the filter command that ran last on it. Only the per-run variables (_host,
+ * _tk and those of the environment string) are reset between two runs.
+ */
+class GmicInterpreterPool {
+public:
+  GmicInterpreterPool() = delete;
+
+  /**
+   * @brief Check out an interpreter ready to run a filter
+   * @param command Filter command. The interpreter is either new or has only run this command
+   * @param environment Space-separated list of "name=value" assignments
+   * @param mode Interpreters are only reused in modes that do not alter verbosity
+   * @return An interpreter, that must be given back with release() or discard()
+   */
+  static gmic * acquire(const QString & command, const QString & environment, GmicQt::OutputMessageMode mode);
+  static void release(gmic * interpreter);
+  static void discard(gmic * interpreter);
+
+  /**
+   * @brief Drop all idle interpreters. Must be called whenever GmicStdLib::Array changes.
+   */
+  static void clear();
+
+  /**
+   * @brief Build an interpreter in the background so that the next acquire() is immediate.
+   */
+  static void prewarm();
+
+  static bool isEnabled();
+  static int createdInterpreterCount();
+
+  /**
+   * @brief Idle interpreters kept, enough for the bands of a TiledFilterThread.
+   */
+  static int maxIdleInterpreters();
+
+private:
+  struct Entry {
+    unsigned int generation;
+    bool reusable;
+    QString command; // Empty until the interpreter has run a filter
+    QStringList environmentVariables;
+  };
+  static gmic * createInterpreter();
+  static void setEnvironment(gmic * interpreter, Entry & entry, const QString & environment);
+  static void insertIdle(gmic * interpreter, unsigned int generation);
+  static QMutex _mutex;
+  static QList<gmic *> _idleInterpreters;
+  static QHash<gmic *, Entry> _entries;
+  static unsigned int _generation;
+  static int _createdCount;
+  static QThread * _prewarmThread;
+  friend class GmicInterpreterPrewarmThread;
+};
+
+#endif // GMIC_QT_GMICINTERPRETERPOOL_H
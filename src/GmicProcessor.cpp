@@ -30,7 +30,11 @@
 #include <QRegExp>
 #include <QSize>
 #include <QString>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <memory>
+#include "Common.h"
 #include "CroppedActiveLayerProxy.h"
 #include "CroppedImageListProxy.h"
 #include "FilterSyncRunner.h"
@@ -40,14 +44,31 @@
 #include "ImageConverter.h"
 #include "ImageTools.h"
 #include "LayersExtentProxy.h"
+#include "Logger.h"
 #include "OverrideCursor.h"
+#include "TiledFilterThread.h"
 #include "gmic.h"
 
-GmicProcessor::GmicProcessor(QObject * parent) : QObject(parent)
+namespace
+{
+bool sameImages(const cimg_library::CImgList<float> & a, const cimg_library::CImgList<float> & b)
+{
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (unsigned int i = 0; i < a.size(); ++i) {
+    if (!a[i].is_sameXYZC(b[i]) || (a[i].size() && std::memcmp(a[i].data(), b[i].data(), a[i].size() * sizeof(float)))) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+GmicProcessor::GmicProcessor(QObject * parent) : QObject(parent), _previewScheduler(nullptr, PREVIEW_WORKER_COUNT)
 {
   _filterThread = nullptr;
   _gmicImages = new cimg_library::CImgList<gmic_pixel_type>;
-  _previewImage = new cimg_library::CImg<float>;
   _waitingCursorTimer.setSingleShot(true);
   connect(&_waitingCursorTimer, SIGNAL(timeout()), this, SLOT(showWaitingCursor()));
   cimg_library::cimg::srand();
@@ -55,6 +76,21 @@ GmicProcessor::GmicProcessor(QObject * parent) : QObject(parent)
   _lastAppliedCommandInOutState = GmicQt::InputOutputState::Unspecified;
   _filterExecutionTime.start();
   _completeFullImageProcessingCount = 0;
+  _lastPreviewCopiedBytes = 0;
+  _previewRefinementBytes = 0;
+  _previewIsInteractive = false;
+  _lastPreviewPassFactor = 1.0;
+  _lastPreviewDraftDuration = 0;
+  _lastPreviewFullDuration = 0;
+  _previewIdleTimer.setSingleShot(true);
+  _previewIdleTimer.setInterval(PREVIEW_INTERACTION_DELAY_MS);
+  connect(&_previewIdleTimer, &QTimer::timeout, this, &GmicProcessor::submitPreviewRefinement);
+  _tiledPreview.active = false;
+  _previewImageNamesCorrected = false;
+  _reusablePreviewPending = false;
+  _reusablePreviewCheckPending = false;
+  connect(&_previewScheduler, &PreviewScheduler::resultAvailable, this, &GmicProcessor::onPreviewResultAvailable, Qt::QueuedConnection);
+  connect(&_previewScheduler, &PreviewScheduler::abortedRunsFinished, this, &GmicProcessor::onAbortedPreviewRunsFinished, Qt::QueuedConnection);
 }
 
 void GmicProcessor::init()
@@ -71,13 +107,48 @@ void GmicProcessor::setContext(const GmicProcessor::FilterContext & context)
 void GmicProcessor::execute()
 {
   gmic_list<char> imageNames;
+  std::shared_ptr<const cimg_library::CImgList<gmic_pixel_type>> inputImages;
   FilterContext::VisibleRect & rect = _filterContext.visibleRect;
   _gmicImages->assign();
+  _previewRefinement.reset();
+  _previewIdleTimer.stop();
+  _reusablePreviewPending = false;
+  _reusablePreviewCheckPending = false;
+  // Debugging aid: Apply runs the filter anyway, and its output is compared with the reusable preview
+  static const bool checkReusablePreview = !qgetenv("GMIC_QT_CHECK_PREVIEW_REUSE").isEmpty();
+  const bool reusePreview = (_filterContext.requestType == FilterContext::FullImageProcessing) && reusablePreviewMatchesContext() && !checkReusablePreview;
   if ((_filterContext.requestType == FilterContext::PreviewProcessing) || (_filterContext.requestType == FilterContext::SynchronousPreviewProcessing)) {
-    CroppedImageListProxy::get(*_gmicImages, imageNames, rect.x, rect.y, rect.w, rect.h, _filterContext.inputOutputState.inputMode, _filterContext.zoomFactor);
-    updateImageNames(imageNames);
-  } else {
-    CroppedImageListProxy::get(*_gmicImages, imageNames, rect.x, rect.y, rect.w, rect.h, _filterContext.inputOutputState.inputMode, 1.0);
+    _reusablePreview.images.reset();
+    _reusablePreview.imageNames.reset();
+    _tiledPreview.active = (_filterContext.requestType == FilterContext::PreviewProcessing) && _filterContext.tiledPreview && //
+                           !_untileableFilters.contains(_filterContext.filterHash) && setupTiledPreview();
+    if (_tiledPreview.active) {
+      if (_tiledPreview.missingTiles.isEmpty()) {
+        // Every visible tile has already been rendered with these parameters (status of the last run may be another filter's).
+        // Runs for previous parameters must not replace this frame.
+        _previewScheduler.cancel();
+        _previewRefinement.reset();
+        _gmicStatus.clear();
+        _parametersVisibilityStates.clear();
+        _lastPreviewCopiedBytes = 0;
+        assembleTiledPreview(*_gmicImages);
+        _previewFrame = PreviewFrame::build(*_gmicImages, previewFrameSettings(1.0));
+        emit previewImageAvailable();
+        return;
+      }
+      // Only the layer pixels of the processed area are fetched, at full resolution, then sampled at the scale of the tiles
+      const QRectF fetched = tiledPreviewFetchedRect();
+      CroppedImageListProxy::get(inputImages, imageNames, fetched.x(), fetched.y(), fetched.width(), fetched.height(), _filterContext.inputOutputState.inputMode, 1.0);
+      _tiledPreview.active = cropTiledPreviewInput(inputImages);
+    }
+    if (!_tiledPreview.active) {
+      CroppedImageListProxy::get(inputImages, imageNames, rect.x, rect.y, rect.w, rect.h, _filterContext.inputOutputState.inputMode, _filterContext.zoomFactor);
+    }
+    _previewImageNamesCorrected = updateImageNames(imageNames);
+  } else if (!reusePreview) {
+    CroppedImageListProxy::get(inputImages, imageNames, rect.x, rect.y, rect.w, rect.h, _filterContext.inputOutputState.inputMode, 1.0);
+    // The image is about to change anyway: let the filter thread take the buffers without a copy
+    CroppedImageListProxy::clear();
   }
   _waitingCursorTimer.start(WAITING_CURSOR_DELAY);
   const GmicQt::InputOutputState & io = _filterContext.inputOutputState;
@@ -85,40 +156,134 @@ void GmicProcessor::execute()
   env += QString(" _output_mode=%1").arg(io.outputMode);
   env += QString(" _output_messages=%1").arg(_filterContext.outputMessageMode);
   env += QString(" _preview_mode=%1").arg(io.previewMode);
+  const QString commonEnv = env;
+  auto previewEnv = [&](int width, int height, int quality) {
+    QString result = commonEnv;
+    result += QString(" _preview_width=%1").arg(width);
+    result += QString(" _preview_height=%1").arg(height);
+    result += QString(" _preview_timeout=%1").arg(_filterContext.previewTimeout);
+    result += QString(" _preview_quality=%1").arg(quality); // 0 for a draft, 1 otherwise
+    return result;
+  };
+  double draftFactor = 1.0;
   if ((_filterContext.requestType == FilterContext::PreviewProcessing) || (_filterContext.requestType == FilterContext::SynchronousPreviewProcessing)) {
-    env += QString(" _preview_width=%1").arg(_filterContext.previewWidth);
-    env += QString(" _preview_height=%1").arg(_filterContext.previewHeight);
-    env += QString(" _preview_timeout=%1").arg(_filterContext.previewTimeout);
+    env = previewEnv(_filterContext.previewWidth, _filterContext.previewHeight, 1);
+    // Requests following each other closely come from an interaction (slider or keypoint drag, panning...)
+    _previewIsInteractive = _previewRequestTime.isValid() && (_previewRequestTime.elapsed() < PREVIEW_INTERACTION_DELAY_MS);
+    _previewRequestTime.start();
+    _previewInputSize = (inputImages && !inputImages->is_empty()) ? QSize((*inputImages)[0].width(), (*inputImages)[0].height()) : QSize();
+    // Synchronous previews are only downscaled while dragging keypoints
+    if (inputImages && previewDraftIsUseful(*inputImages) && ((_filterContext.requestType == FilterContext::PreviewProcessing) || _previewIsInteractive)) {
+      draftFactor = _previewResolution.downscaleFactor(_filterContext.filterHash, _previewInputSize.width() * static_cast<double>(_previewInputSize.height()));
+    }
+  }
+  std::shared_ptr<cimg_library::CImgList<gmic_pixel_type>> draftImages;
+  QString draftEnv;
+  if (draftFactor > 1.0) {
+    draftImages = previewDraftImages(*inputImages, draftFactor);
+    draftEnv = previewEnv(std::max(1, static_cast<int>(std::round(_filterContext.previewWidth / draftFactor))), //
+                          std::max(1, static_cast<int>(std::round(_filterContext.previewHeight / draftFactor))), 0);
   }
   if (_filterContext.requestType == FilterContext::SynchronousPreviewProcessing) {
-    FilterSyncRunner runner(this, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, env, _filterContext.outputMessageMode);
-    runner.swapImages(*_gmicImages);
-    runner.setImageNames(imageNames);
-    runner.setLogSuffix("preview");
+    _previewScheduler.cancel();
     cimg_library::cimg::srand();
     _previewRandomSeed = cimg_library::cimg::_rand();
-    _filterExecutionTime.restart();
-    runner.run();
-    manageSynchonousRunner(runner);
-    recordPreviewFilterExecutionDurationMS(_filterExecutionTime.elapsed());
+    if (draftImages) {
+      _previewRefinement.reset(new FilterSyncRunner(nullptr, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, env, _filterContext.outputMessageMode));
+      _previewRefinementBytes = PreviewScheduler::imageBytes(*inputImages);
+      _previewRefinement->setInputImages(std::move(inputImages));
+      _previewRefinement->setImageNames(imageNames);
+      _previewRefinement->setLogSuffix("preview");
+      _previewRefinement->setPreviewFrameSettings(previewFrameSettings(1.0));
+      _previewRefinement->setKeepsOutputs(previewIsReusable(_previewRefinementBytes));
+      FilterSyncRunner runner(this, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, draftEnv, _filterContext.outputMessageMode);
+      runner.setInputImages(std::move(draftImages));
+      runner.setImageNames(imageNames);
+      runner.setLogSuffix("draft");
+      runner.setPreviewFrameSettings(previewFrameSettings(draftFactor));
+      _filterExecutionTime.restart();
+      runner.run();
+      _lastPreviewPassFactor = draftFactor;
+      _lastPreviewDraftDuration = runner.runDuration();
+      _previewResolution.recordDuration(_filterContext.filterHash, _previewDraftInputSize.width() * static_cast<double>(_previewDraftInputSize.height()), _lastPreviewDraftDuration);
+      _lastPreviewCopiedBytes = runner.copiedInputBytes();
+      if (showPreviewDraft(runner)) {
+        schedulePreviewRefinement();
+      } else {
+        submitPreviewRefinement();
+      }
+    } else {
+      FilterSyncRunner runner(this, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, env, _filterContext.outputMessageMode);
+      runner.setKeepsOutputs(inputImages && previewIsReusable(PreviewScheduler::imageBytes(*inputImages)));
+      runner.setInputImages(std::move(inputImages));
+      runner.setImageNames(imageNames);
+      runner.setLogSuffix("preview");
+      runner.setPreviewFrameSettings(previewFrameSettings(1.0));
+      _filterExecutionTime.restart();
+      runner.run();
+      _lastPreviewPassFactor = 1.0;
+      _lastPreviewFullDuration = runner.runDuration();
+      _previewResolution.recordDuration(_filterContext.filterHash, _previewInputSize.width() * static_cast<double>(_previewInputSize.height()), _lastPreviewFullDuration);
+      _lastPreviewCopiedBytes = runner.copiedInputBytes();
+      manageSynchonousRunner(runner);
+      recordPreviewFilterExecutionDurationMS(_lastPreviewFullDuration);
+    }
   } else if (_filterContext.requestType == FilterContext::PreviewProcessing) {
-    _filterThread = new FilterThread(this, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, env, _filterContext.outputMessageMode);
-    _filterThread->swapImages(*_gmicImages);
-    _filterThread->setImageNames(imageNames);
-    _filterThread->setLogSuffix("preview");
-    connect(_filterThread, SIGNAL(finished()), this, SLOT(onPreviewThreadFinished()), Qt::QueuedConnection);
-    cimg_library::cimg::srand();
-    _previewRandomSeed = cimg_library::cimg::_rand();
+    std::unique_ptr<FilterSyncRunner> runner(new FilterSyncRunner(nullptr, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, env, _filterContext.outputMessageMode));
+    const std::size_t inputBytes = inputImages ? PreviewScheduler::imageBytes(*inputImages) : 0;
+    runner->setInputImages(std::move(inputImages));
+    runner->setImageNames(imageNames);
+    runner->setLogSuffix("preview");
+    if (!_tiledPreview.active) {
+      // Tiles are assembled with the cached ones before being composed
+      runner->setPreviewFrameSettings(previewFrameSettings(1.0));
+      runner->setKeepsOutputs(previewIsReusable(inputBytes));
+    }
+    if (_tiledPreview.active) {
+      // Missing tiles are rendered with the seed of the cached ones (it is part of their key)
+      cimg_library::cimg::srand(_previewRandomSeed);
+    } else {
+      cimg_library::cimg::srand();
+      _previewRandomSeed = cimg_library::cimg::_rand();
+    }
     _filterExecutionTime.restart();
-    _filterThread->start();
+    if (draftImages) {
+      std::unique_ptr<FilterSyncRunner> draftRunner(
+          new FilterSyncRunner(nullptr, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, draftEnv, _filterContext.outputMessageMode));
+      const std::size_t draftBytes = PreviewScheduler::imageBytes(*draftImages);
+      draftRunner->setInputImages(std::move(draftImages));
+      draftRunner->setImageNames(imageNames);
+      draftRunner->setLogSuffix("draft");
+      draftRunner->setPreviewFrameSettings(previewFrameSettings(draftFactor));
+      _previewRefinement = std::move(runner);
+      _previewRefinementBytes = inputBytes;
+      _lastPreviewPassFactor = draftFactor;
+      _previewScheduler.submit(std::move(draftRunner), draftBytes);
+    } else {
+      _lastPreviewPassFactor = 1.0;
+      _previewScheduler.submit(std::move(runner), inputBytes);
+    }
   } else if (_filterContext.requestType == FilterContext::FullImageProcessing) {
+    _previewScheduler.cancel();
     _lastAppliedFilterName = _filterContext.filterName;
     _lastAppliedCommand = _filterContext.filterCommand;
     _lastAppliedCommandArguments = _filterContext.filterArguments;
     _lastAppliedCommandEnv = env;
     _lastAppliedCommandInOutState = _filterContext.inputOutputState;
-    _filterThread = new FilterThread(this, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, env, _filterContext.outputMessageMode);
-    _filterThread->swapImages(*_gmicImages);
+    if (reusePreview) {
+      // The preview is already the result: it is sent to the host once the caller has returned, as a filter thread would
+      _reusablePreviewPending = true;
+      QTimer::singleShot(0, this, SLOT(outputReusablePreview()));
+      return;
+    }
+    _reusablePreviewCheckPending = checkReusablePreview && reusablePreviewMatchesContext();
+    if (_filterContext.tileHalo >= 0) {
+      _filterThread = new TiledFilterThread(this, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, env, _filterContext.outputMessageMode,
+                                            _filterContext.tileHalo);
+    } else {
+      _filterThread = new FilterThread(this, _filterContext.filterName, _filterContext.filterCommand, _filterContext.filterArguments, env, _filterContext.outputMessageMode);
+    }
+    _filterThread->setInputImages(std::move(inputImages));
     _filterThread->setImageNames(imageNames);
     _filterThread->setLogSuffix("apply");
     connect(_filterThread, SIGNAL(finished()), this, SLOT(onApplyThreadFinished()), Qt::QueuedConnection);
@@ -134,12 +299,12 @@ bool GmicProcessor::isProcessingFullImage() const
 
 bool GmicProcessor::isProcessing() const
 {
-  return _filterThread;
+  return _filterThread || _reusablePreviewPending || _previewScheduler.isBusy();
 }
 
 bool GmicProcessor::isIdle() const
 {
-  return !_filterThread;
+  return !isProcessing();
 }
 
 int GmicProcessor::duration() const
@@ -147,6 +312,9 @@ int GmicProcessor::duration() const
   if (_filterThread) {
     return _filterThread->duration();
   }
+  if (_previewScheduler.isBusy()) {
+    return static_cast<int>(_filterExecutionTime.elapsed());
+  }
   return 0;
 }
 
@@ -155,7 +323,7 @@ float GmicProcessor::progress() const
   if (_filterThread) {
     return _filterThread->progress();
   }
-  return 0.0f;
+  return _previewScheduler.progress();
 }
 
 int GmicProcessor::lastPreviewFilterExecutionDurationMS() const
@@ -203,19 +371,50 @@ int GmicProcessor::completedFullImageProcessingCount() const
   return _completeFullImageProcessingCount;
 }
 
+std::size_t GmicProcessor::lastPreviewCopiedBytes() const
+{
+  return _lastPreviewCopiedBytes;
+}
+
+void GmicProcessor::setPreviewTileCacheSize(int megaBytes)
+{
+  _previewTiles.setBudget(megaBytes);
+}
+
+PreviewScheduler::Statistics GmicProcessor::previewSchedulerStatistics() const
+{
+  return _previewScheduler.statistics();
+}
+
+QString GmicProcessor::previewResolutionSummary() const
+{
+  const double pixels = _previewInputSize.width() * static_cast<double>(_previewInputSize.height());
+  const int estimate = _previewResolution.estimatedDuration(_filterContext.filterHash, pixels);
+  QString text = QString("Downscale x%1 (%2x%3)").arg(_lastPreviewPassFactor, 0, 'f', 2).arg(_previewInputSize.width()).arg(_previewInputSize.height());
+  text += QString("\nLast draft: %1 ms, last full resolution pass: %2 ms").arg(_lastPreviewDraftDuration).arg(_lastPreviewFullDuration);
+  text += QString("\nFull resolution: %1").arg((estimate >= 0) ? QString("~%1 ms").arg(estimate) : QString("?"));
+  text += QString("\nTarget: %1 ms%2").arg(_previewResolution.targetFrameTime()).arg(_previewIsInteractive ? " (interacting)" : "");
+  return text;
+}
+
 void GmicProcessor::cancel()
 {
+  _previewIdleTimer.stop();
+  _previewRefinement.reset();
+  _previewScheduler.cancel();
+  _reusablePreviewPending = false;
   abortCurrentFilterThread();
+  hideWaitingCursor();
 }
 
 bool GmicProcessor::hasUnfinishedAbortedThreads() const
 {
-  return !_unfinishedAbortedThreads.isEmpty();
+  return !_unfinishedAbortedThreads.isEmpty() || _previewScheduler.hasAbortedRuns();
 }
 
-const cimg_library::CImg<float> & GmicProcessor::previewImage() const
+std::shared_ptr<const PreviewFrame> GmicProcessor::previewFrame() const
 {
-  return *_previewImage;
+  return _previewFrame;
 }
 
 const QStringList & GmicProcessor::gmicStatus() const
@@ -240,42 +439,73 @@ void GmicProcessor::saveSettings(QSettings & settings)
 GmicProcessor::~GmicProcessor()
 {
   delete _gmicImages;
-  delete _previewImage;
   if (!_unfinishedAbortedThreads.isEmpty()) {
     qWarning() << QString("Error: ~GmicProcessor(): There are %1 unfinished filter threads.").arg(_unfinishedAbortedThreads.size());
   }
+  const PreviewScheduler::Statistics statistics = _previewScheduler.statistics();
+  TRACE << "Previews completed:" << statistics.completed << "superseded:" << statistics.superseded << "aborted:" << statistics.aborted << "peak image memory:" << statistics.peakImageBytes;
 }
 
-void GmicProcessor::onPreviewThreadFinished()
+void GmicProcessor::onPreviewResultAvailable()
 {
-  Q_ASSERT_X(_filterThread, __PRETTY_FUNCTION__, "No filter thread");
-  if (_filterThread->isRunning()) {
+  std::unique_ptr<FilterSyncRunner> runner = _previewScheduler.takeResult();
+  if (!runner) {
+    // Superseded or canceled meanwhile
     return;
   }
-  if (_filterThread->failed()) {
+  // Measured by the runner, hence excluding the time spent in the queue of the scheduler
+  if (_previewRefinement) {
+    // This is the draft
+    _lastPreviewDraftDuration = runner->runDuration();
+    _previewResolution.recordDuration(_filterContext.filterHash, _previewDraftInputSize.width() * static_cast<double>(_previewDraftInputSize.height()), _lastPreviewDraftDuration);
+    if (showPreviewDraft(*runner)) {
+      schedulePreviewRefinement();
+    } else {
+      submitPreviewRefinement();
+    }
+    return;
+  }
+  _lastPreviewPassFactor = 1.0;
+  _lastPreviewFullDuration = runner->runDuration();
+  _previewResolution.recordDuration(_filterContext.filterHash, _previewInputSize.width() * static_cast<double>(_previewInputSize.height()), _lastPreviewFullDuration);
+  if (runner->failed()) {
     _gmicStatus.clear();
     _parametersVisibilityStates.clear();
     _gmicImages->assign();
-    QString message = _filterThread->errorMessage();
-    _filterThread->deleteLater();
-    _filterThread = nullptr;
     hideWaitingCursor();
-    emit previewCommandFailed(message);
+    emit previewCommandFailed(runner->errorMessage());
     return;
   }
-  _gmicStatus = _filterThread->gmicStatus();
-  _parametersVisibilityStates = _filterThread->parametersVisibilityStates();
-  _gmicImages->assign();
-  _filterThread->swapImages(*_gmicImages);
-  for (unsigned int i = 0; i < _gmicImages->size(); ++i) {
-    gmic_qt_apply_color_profile((*_gmicImages)[i]);
+  _gmicStatus = runner->gmicStatus();
+  _parametersVisibilityStates = runner->parametersVisibilityStates();
+  _lastPreviewCopiedBytes = runner->copiedInputBytes();
+  keepReusablePreview(*runner);
+  if (_tiledPreview.active) {
+    _gmicImages->assign();
+    runner->swapImages(*_gmicImages);
+    runner.reset();
+    if (!assembleTiledPreview(*_gmicImages)) {
+      // Output geometry does not match the input one: the filter cannot be previewed by tiles
+      _untileableFilters.insert(_filterContext.filterHash);
+      execute();
+      return;
+    }
+    _previewFrame = PreviewFrame::build(*_gmicImages, previewFrameSettings(1.0));
+  } else {
+    // Composed by the worker
+    _previewFrame = runner->previewFrame();
+    runner.reset();
   }
-  GmicQt::buildPreviewImage(*_gmicImages, *_previewImage, _filterContext.inputOutputState.previewMode, _filterContext.previewWidth, _filterContext.previewHeight);
-  _filterThread->deleteLater();
-  _filterThread = nullptr;
   hideWaitingCursor();
   emit previewImageAvailable();
-  recordPreviewFilterExecutionDurationMS(_filterExecutionTime.elapsed());
+  recordPreviewFilterExecutionDurationMS(_lastPreviewFullDuration);
+}
+
+void GmicProcessor::onAbortedPreviewRunsFinished()
+{
+  if (_unfinishedAbortedThreads.isEmpty() && !_previewScheduler.hasAbortedRuns()) {
+    emit noMoreUnfinishedJobs();
+  }
 }
 
 void GmicProcessor::onApplyThreadFinished()
@@ -298,27 +528,36 @@ void GmicProcessor::onApplyThreadFinished()
     _filterThread = nullptr;
     emit fullImageProcessingFailed(message);
   } else {
-    if (GmicQt::HostApplicationName.isEmpty()) {
-      emit aboutToSendImagesToHost();
-    }
     _filterThread->swapImages(*_gmicImages);
-    if (_filterContext.outputMessageMode == GmicQt::VerboseLayerName) {
-      QString label = QString("[G'MIC] %1: %2").arg(_filterThread->name()).arg(_filterThread->fullCommand());
-      gmic_qt_output_images(*_gmicImages, _filterThread->imageNames(), _filterContext.inputOutputState.outputMode, label.toLocal8Bit().constData());
-    } else {
-      gmic_qt_output_images(*_gmicImages, _filterThread->imageNames(), _filterContext.inputOutputState.outputMode, nullptr);
+    if (_reusablePreviewCheckPending) {
+      checkReusablePreview();
     }
-    _completeFullImageProcessingCount += 1;
-    LayersExtentProxy::clear();
-    CroppedActiveLayerProxy::clear();
-    CroppedImageListProxy::clear();
+    sendImagesToHost(_filterThread->imageNames(), _filterThread->name(), _filterThread->fullCommand());
     _filterThread->deleteLater();
     _filterThread = nullptr;
-    _lastAppliedCommandGmicStatus = _gmicStatus; // TODO : save visibility states?
     emit fullImageProcessingDone();
   }
 }
 
+void GmicProcessor::outputReusablePreview()
+{
+  if (!_reusablePreviewPending) {
+    // Canceled meanwhile
+    return;
+  }
+  _reusablePreviewPending = false;
+  hideWaitingCursor();
+  // Images are taken from the kept preview, which is dropped by sendImagesToHost() anyway
+  std::shared_ptr<cimg_library::CImgList<char>> imageNames = _reusablePreview.imageNames;
+  _gmicImages->assign();
+  _reusablePreview.images->swap(*_gmicImages);
+  if (_filterContext.outputMessageMode >= GmicQt::VerboseConsole) {
+    Logger::note(QString("Preview of the whole image at actual size applied without running the filter again"));
+  }
+  sendImagesToHost(*imageNames, _reusablePreview.name, _reusablePreview.fullCommand);
+  emit fullImageProcessingDone();
+}
+
 void GmicProcessor::onAbortedThreadFinished()
 {
   auto thread = dynamic_cast<FilterThread *>(sender());
@@ -326,14 +565,14 @@ void GmicProcessor::onAbortedThreadFinished()
     _unfinishedAbortedThreads.removeOne(thread);
     thread->deleteLater();
   }
-  if (_unfinishedAbortedThreads.isEmpty()) {
+  if (_unfinishedAbortedThreads.isEmpty() && !_previewScheduler.hasAbortedRuns()) {
     emit noMoreUnfinishedJobs();
   }
 }
 
 void GmicProcessor::showWaitingCursor()
 {
-  if (_filterThread) {
+  if (isProcessing()) {
     OverrideCursor::setWaiting(true);
   }
 }
@@ -344,8 +583,9 @@ void GmicProcessor::hideWaitingCursor()
   OverrideCursor::setWaiting(false);
 }
 
-void GmicProcessor::updateImageNames(gmic_list<char> & imageNames)
+bool GmicProcessor::updateImageNames(gmic_list<char> & imageNames)
 {
+  bool changed = false;
   const double & xFactor = _filterContext.positionStringCorrection.xFactor;
   const double & yFactor = _filterContext.positionStringCorrection.yFactor;
   int maxWidth;
@@ -363,8 +603,10 @@ void GmicProcessor::updateImageNames(gmic_list<char> & imageNames)
       str.replace(position.cap(0), QString("pos(%1%2%3)").arg(newXPos).arg(position.cap(2)).arg(newYPos));
       name.resize(str.size() + 1);
       std::memcpy(name.data(), str.toLatin1().constData(), name.width());
+      changed = true;
     }
   }
+  return changed;
 }
 
 void GmicProcessor::abortCurrentFilterThread()
@@ -393,16 +635,305 @@ void GmicProcessor::manageSynchonousRunner(FilterSyncRunner & runner)
   }
   _gmicStatus = runner.gmicStatus();
   _parametersVisibilityStates = runner.parametersVisibilityStates();
-  _gmicImages->assign();
-  runner.swapImages(*_gmicImages);
-  for (unsigned int i = 0; i < _gmicImages->size(); ++i) {
-    gmic_qt_apply_color_profile((*_gmicImages)[i]);
-  }
-  GmicQt::buildPreviewImage(*_gmicImages, *_previewImage, _filterContext.inputOutputState.previewMode, _filterContext.previewWidth, _filterContext.previewHeight);
+  keepReusablePreview(runner);
+  _previewFrame = runner.previewFrame();
   hideWaitingCursor();
   emit previewImageAvailable();
 }
 
+void GmicProcessor::submitPreviewRefinement()
+{
+  if (!_previewRefinement) {
+    return;
+  }
+  _filterExecutionTime.restart();
+  _lastPreviewPassFactor = 1.0;
+  _previewScheduler.submit(std::move(_previewRefinement), _previewRefinementBytes);
+}
+
+bool GmicProcessor::previewDraftIsUseful(const cimg_library::CImgList<float> & images) const
+{
+  static const bool draftsEnabled = qgetenv("GMIC_QT_NO_PREVIEW_DRAFT").isEmpty();
+  if (!draftsEnabled || !_filterContext.previewDraft || _tiledPreview.active || images.is_empty()) {
+    return false;
+  }
+  return (images[0].width() >= 32) && (images[0].height() >= 32);
+}
+
+std::shared_ptr<cimg_library::CImgList<float>> GmicProcessor::previewDraftImages(const cimg_library::CImgList<float> & images, double factor)
+{
+  auto result = std::make_shared<cimg_library::CImgList<float>>(images.size());
+  for (unsigned int i = 0; i < images.size(); ++i) {
+    const cimg_library::CImg<float> & image = images[i];
+    image.get_resize(std::max(1, static_cast<int>(std::round(image.width() / factor))), std::max(1, static_cast<int>(std::round(image.height() / factor))), -100, -100, 2).move_to((*result)[i]);
+  }
+  _previewDraftInputSize = QSize((*result)[0].width(), (*result)[0].height());
+  return result;
+}
+
+PreviewFrame::Settings GmicProcessor::previewFrameSettings(double draftFactor) const
+{
+  PreviewFrame::Settings settings;
+  settings.enabled = true;
+  settings.previewMode = _filterContext.inputOutputState.previewMode;
+  settings.previewWidth = _filterContext.previewWidth;
+  settings.previewHeight = _filterContext.previewHeight;
+  if (draftFactor > 1.0) {
+    // Outputs may not have the input size, so they are scaled by the ratio between inputs
+    settings.xScale = _previewInputSize.width() / static_cast<double>(_previewDraftInputSize.width());
+    settings.yScale = _previewInputSize.height() / static_cast<double>(_previewDraftInputSize.height());
+  }
+  return settings;
+}
+
+bool GmicProcessor::showPreviewDraft(FilterSyncRunner & runner)
+{
+  if (runner.failed()) {
+    return false;
+  }
+  _gmicStatus = runner.gmicStatus();
+  _parametersVisibilityStates = runner.parametersVisibilityStates();
+  _previewFrame = runner.previewFrame();
+  emit previewImageAvailable();
+  return true;
+}
+
+void GmicProcessor::schedulePreviewRefinement()
+{
+  // While the user interacts, full resolution waits for the input to go idle
+  if (_previewIsInteractive) {
+    _previewIdleTimer.start();
+  } else {
+    submitPreviewRefinement();
+  }
+}
+
+bool GmicProcessor::previewIsReusable(std::size_t inputBytes) const
+{
+  // Only a preview computed on the whole image, at actual size and with the image names of the host, is what Apply would produce.
+  // Filters may also behave differently when given the _preview_* variables, which filters previewing the whole image are not expected to do.
+  const FilterContext::VisibleRect & rect = _filterContext.visibleRect;
+  if (!_filterContext.previewIsFullImage || _tiledPreview.active || (_filterContext.zoomFactor < 1.0) || (rect.x > 0.0) || (rect.y > 0.0) || (rect.x + rect.w < 1.0) || (rect.y + rect.h < 1.0) || _previewImageNamesCorrected) {
+    return false;
+  }
+  return inputBytes <= PREVIEW_REUSE_MAX_SIZE * 1024ull * 1024ull;
+}
+
+void GmicProcessor::keepReusablePreview(const FilterSyncRunner & runner)
+{
+  // Outputs are only kept by runners of reusable previews
+  if (!runner.keptOutputs()) {
+    return;
+  }
+  _reusablePreview.command = _filterContext.filterCommand;
+  _reusablePreview.arguments = _filterContext.filterArguments;
+  _reusablePreview.filterHash = _filterContext.filterHash;
+  _reusablePreview.inputOutputState = _filterContext.inputOutputState;
+  _reusablePreview.outputMessageMode = _filterContext.outputMessageMode;
+  _reusablePreview.randomSeed = _previewRandomSeed;
+  _reusablePreview.name = runner.name();
+  _reusablePreview.fullCommand = runner.fullCommand();
+  _reusablePreview.images = runner.keptOutputs();
+  _reusablePreview.imageNames = std::make_shared<cimg_library::CImgList<char>>(runner.imageNames());
+}
+
+bool GmicProcessor::reusablePreviewMatchesContext() const
+{
+  if (!_reusablePreview.images) {
+    return false;
+  }
+  // The command differs when the filter has a specific preview command
+  return (_reusablePreview.command == _filterContext.filterCommand) && (_reusablePreview.arguments == _filterContext.filterArguments) && //
+         (_reusablePreview.filterHash == _filterContext.filterHash) && (_reusablePreview.inputOutputState == _filterContext.inputOutputState) && //
+         (_reusablePreview.outputMessageMode == _filterContext.outputMessageMode) && (_reusablePreview.randomSeed == _previewRandomSeed);
+}
+
+void GmicProcessor::checkReusablePreview()
+{
+  _reusablePreviewCheckPending = false;
+  if (!_reusablePreview.images) {
+    return;
+  }
+  if (sameImages(*_reusablePreview.images, *_gmicImages)) {
+    Logger::note(QString("Preview output is identical to the applied one (%1 image(s))").arg(_gmicImages->size()));
+  } else {
+    Logger::warning(QString("Preview output differs from the applied one, it should not be reused for filter %1").arg(_filterContext.filterName));
+  }
+}
+
+void GmicProcessor::sendImagesToHost(const cimg_library::CImgList<char> & imageNames, const QString & name, const QString & fullCommand)
+{
+  if (GmicQt::HostApplicationName.isEmpty()) {
+    emit aboutToSendImagesToHost();
+  }
+  if (_filterContext.outputMessageMode == GmicQt::VerboseLayerName) {
+    QString label = QString("[G'MIC] %1: %2").arg(name).arg(fullCommand);
+    gmic_qt_output_images(*_gmicImages, imageNames, _filterContext.inputOutputState.outputMode, label.toLocal8Bit().constData());
+  } else {
+    gmic_qt_output_images(*_gmicImages, imageNames, _filterContext.inputOutputState.outputMode, nullptr);
+  }
+  _completeFullImageProcessingCount += 1;
+  LayersExtentProxy::clear();
+  CroppedActiveLayerProxy::clear();
+  CroppedImageListProxy::clear();
+  _previewTiles.clear();
+  _reusablePreview.images.reset();
+  _reusablePreview.imageNames.reset();
+  _lastAppliedCommandGmicStatus = _gmicStatus; // TODO : save visibility states?
+}
+
+bool GmicProcessor::setupTiledPreview()
+{
+  int fullWidth = 0;
+  int fullHeight = 0;
+  LayersExtentProxy::getExtent(_filterContext.inputOutputState.inputMode, fullWidth, fullHeight);
+  if ((fullWidth <= 0) || (fullHeight <= 0)) {
+    return false;
+  }
+  // Tiles are laid out on the layer scaled by the zoom factor, but never upscaled
+  const double scale = std::min(1.0, _filterContext.zoomFactor);
+  const QRect image(0, 0, std::max(1, static_cast<int>(std::round(fullWidth * scale))), std::max(1, static_cast<int>(std::round(fullHeight * scale))));
+  const FilterContext::VisibleRect & rect = _filterContext.visibleRect;
+  const QPoint topLeft(static_cast<int>(std::floor(rect.x * image.width())), static_cast<int>(std::floor(rect.y * image.height())));
+  const QPoint bottomRight(static_cast<int>(std::ceil((rect.x + rect.w) * image.width())) - 1, static_cast<int>(std::ceil((rect.y + rect.h) * image.height())) - 1);
+  const QRect visible = QRect(topLeft, bottomRight) & image;
+  if (visible.isEmpty()) {
+    return false;
+  }
+  _tiledPreview.imageSize = image.size();
+  _tiledPreview.visible = visible;
+  _tiledPreview.tiles = QRect(QPoint(visible.left() / PREVIEW_TILE_SIZE, visible.top() / PREVIEW_TILE_SIZE), //
+                              QPoint(visible.right() / PREVIEW_TILE_SIZE, visible.bottom() / PREVIEW_TILE_SIZE));
+  _tiledPreview.keyPrefix = PreviewTileCache::keyPrefix(_filterContext.filterHash, _filterContext.filterArguments, scale, _filterContext.inputOutputState.inputMode,
+                                                        _filterContext.inputOutputState.previewMode, _filterContext.previewTileHalo,
+                                                        QSize(_filterContext.previewWidth, _filterContext.previewHeight), _previewRandomSeed);
+  _tiledPreview.missingTiles.clear();
+  QRect missingArea;
+  for (int row = _tiledPreview.tiles.top(); row <= _tiledPreview.tiles.bottom(); ++row) {
+    for (int column = _tiledPreview.tiles.left(); column <= _tiledPreview.tiles.right(); ++column) {
+      if (!_previewTiles.contains(_tiledPreview.keyPrefix, column, row)) {
+        _tiledPreview.missingTiles.push_back(QPoint(column, row));
+        missingArea |= QRect(column * PREVIEW_TILE_SIZE, row * PREVIEW_TILE_SIZE, PREVIEW_TILE_SIZE, PREVIEW_TILE_SIZE);
+      }
+    }
+  }
+  const int halo = _filterContext.previewTileHalo;
+  _tiledPreview.processed = missingArea.adjusted(-halo, -halo, halo, halo) & image;
+  // Rounded outward to tiles, so that the proxy keeps the fetched area while the same tiles are processed.
+  // Pixel x of the scaled layer is pixel floor(x * fullWidth / width) of the layer.
+  const QRect & processed = _tiledPreview.processed;
+  const QRect aligned = QRect(QPoint((processed.left() / PREVIEW_TILE_SIZE) * PREVIEW_TILE_SIZE, (processed.top() / PREVIEW_TILE_SIZE) * PREVIEW_TILE_SIZE), //
+                              QPoint((processed.right() / PREVIEW_TILE_SIZE + 1) * PREVIEW_TILE_SIZE - 1, (processed.bottom() / PREVIEW_TILE_SIZE + 1) * PREVIEW_TILE_SIZE - 1)) &
+                        image;
+  const double xRatio = fullWidth / static_cast<double>(image.width());
+  const double yRatio = fullHeight / static_cast<double>(image.height());
+  _tiledPreview.fullSize = QSize(fullWidth, fullHeight);
+  _tiledPreview.fetched = QRect(QPoint(static_cast<int>(aligned.left() * xRatio), static_cast<int>(aligned.top() * yRatio)), //
+                                QPoint(static_cast<int>(aligned.right() * xRatio), static_cast<int>(aligned.bottom() * yRatio)));
+  return true;
+}
+
+QRectF GmicProcessor::tiledPreviewFetchedRect() const
+{
+  const QRect & fetched = _tiledPreview.fetched;
+  const double width = _tiledPreview.fullSize.width();
+  const double height = _tiledPreview.fullSize.height();
+  return QRectF(fetched.x() / width, fetched.y() / height, fetched.width() / width, fetched.height() / height);
+}
+
+bool GmicProcessor::cropTiledPreviewInput(std::shared_ptr<const cimg_library::CImgList<gmic_pixel_type>> & images) const
+{
+  if (!images || (images->size() != 1)) {
+    return false;
+  }
+  // Position of the fetched pixels in the layer, computed as hosts do
+  const cimg_library::CImg<gmic_pixel_type> & source = (*images)[0];
+  const QSize & fullSize = _tiledPreview.fullSize;
+  const QRectF fetched = tiledPreviewFetchedRect();
+  const int sourceLeft = static_cast<int>(std::floor(fetched.x() * fullSize.width()));
+  const int sourceTop = static_cast<int>(std::floor(fetched.y() * fullSize.height()));
+  if ((sourceLeft > _tiledPreview.fetched.left()) || (sourceTop > _tiledPreview.fetched.top()) || (source.width() <= _tiledPreview.fetched.right() - sourceLeft) ||
+      (source.height() <= _tiledPreview.fetched.bottom() - sourceTop)) {
+    // Unexpected geometry, the preview is not tiled
+    return false;
+  }
+  const QRect & processed = _tiledPreview.processed;
+  std::shared_ptr<cimg_library::CImgList<gmic_pixel_type>> cropped(new cimg_library::CImgList<gmic_pixel_type>(1));
+  cimg_library::CImg<gmic_pixel_type> & result = (*cropped)[0];
+  if (_tiledPreview.imageSize == fullSize) {
+    source.get_crop(processed.left() - sourceLeft, processed.top() - sourceTop, processed.right() - sourceLeft, processed.bottom() - sourceTop).move_to(result);
+  } else {
+    // Nearest neighbor sampling, the same for every fetched area
+    const double xRatio = fullSize.width() / static_cast<double>(_tiledPreview.imageSize.width());
+    const double yRatio = fullSize.height() / static_cast<double>(_tiledPreview.imageSize.height());
+    QVector<int> columns(processed.width());
+    for (int x = 0; x < processed.width(); ++x) {
+      columns[x] = static_cast<int>((processed.left() + x) * xRatio) - sourceLeft;
+    }
+    result.assign(processed.width(), processed.height(), 1, source.spectrum());
+    cimg_forYC(result, y, c)
+    {
+      const gmic_pixel_type * row = source.data(0, static_cast<int>((processed.top() + y) * yRatio) - sourceTop, 0, c);
+      gmic_pixel_type * destination = result.data(0, y, 0, c);
+      for (int x = 0; x < processed.width(); ++x) {
+        destination[x] = row[columns[x]];
+      }
+    }
+  }
+  images = cropped;
+  return true;
+}
+
+bool GmicProcessor::assembleTiledPreview(cimg_library::CImgList<float> & images)
+{
+  const QRect & processed = _tiledPreview.processed;
+  cimg_library::CImg<float> rendered;
+  if (!_tiledPreview.missingTiles.isEmpty()) {
+    if ((images.size() != 1) || (images[0].width() != processed.width()) || (images[0].height() != processed.height())) {
+      return false;
+    }
+    images[0].move_to(rendered);
+  }
+  const QRect image(QPoint(0, 0), _tiledPreview.imageSize);
+  int spectrum = rendered.spectrum();
+  for (int row = _tiledPreview.tiles.top(); row <= _tiledPreview.tiles.bottom(); ++row) {
+    for (int column = _tiledPreview.tiles.left(); column <= _tiledPreview.tiles.right(); ++column) {
+      if (!_tiledPreview.missingTiles.contains(QPoint(column, row))) {
+        const cimg_library::CImg<float> * tile = _previewTiles.tile(_tiledPreview.keyPrefix, column, row);
+        spectrum = std::max(spectrum, tile ? tile->spectrum() : 0);
+      }
+    }
+  }
+  const QRect & visible = _tiledPreview.visible;
+  cimg_library::CImg<float> result(visible.width(), visible.height(), 1, spectrum, 0);
+  cimg_library::CImgList<float> newTiles;
+  for (int row = _tiledPreview.tiles.top(); row <= _tiledPreview.tiles.bottom(); ++row) {
+    for (int column = _tiledPreview.tiles.left(); column <= _tiledPreview.tiles.right(); ++column) {
+      const QRect area = QRect(column * PREVIEW_TILE_SIZE, row * PREVIEW_TILE_SIZE, PREVIEW_TILE_SIZE, PREVIEW_TILE_SIZE) & image;
+      cimg_library::CImg<float> tile;
+      if (_tiledPreview.missingTiles.contains(QPoint(column, row))) {
+        const QRect source = area.translated(-processed.topLeft());
+        newTiles.insert(rendered.get_crop(source.left(), source.top(), source.right(), source.bottom()));
+        tile = newTiles.back();
+      } else if (const cimg_library::CImg<float> * cached = _previewTiles.tile(_tiledPreview.keyPrefix, column, row)) {
+        tile = *cached;
+      }
+      if (tile.spectrum() != spectrum) {
+        GmicQt::calibrate_image(tile, spectrum, true);
+      }
+      result.draw_image(area.left() - visible.left(), area.top() - visible.top(), tile);
+    }
+  }
+  // New tiles are cached only now, so that no visible tile could have been dropped meanwhile
+  for (int i = 0; i < _tiledPreview.missingTiles.size(); ++i) {
+    const QPoint & position = _tiledPreview.missingTiles[i];
+    _previewTiles.insert(_tiledPreview.keyPrefix, position.x(), position.y(), newTiles[i]);
+  }
+  images.assign(1);
+  result.move_to(images[0]);
+  return true;
+}
+
 const QList<int> & GmicProcessor::parametersVisibilityStates() const
 {
   return _parametersVisibilityStates;
@@ -28,14 +28,25 @@
 #include <QElapsedTimer>
 #include <QList>
 #include <QObject>
+#include <QPoint>
+#include <QRect>
+#include <QRectF>
+#include <QSet>
 #include <QSettings>
 #include <QSignalMapper>
+#include <QSize>
 #include <QString>
 #include <QStringList>
 #include <QTimer>
 #include <QVector>
+#include <cstddef>
 #include <deque>
+#include <memory>
 #include "InputOutputState.h"
+#include "PreviewFrame.h"
+#include "PreviewResolutionController.h"
+#include "PreviewScheduler.h"
+#include "PreviewTileCache.h"
 #include "gmic_qt.h"
 class FilterThread;
 class FilterSyncRunner;
@@ -76,6 +87,11 @@ public:
     QString filterCommand;
     QString filterArguments;
     QString filterHash;
+    bool tiledPreview = false;       // Preview is rendered by tiles, cached in PreviewTileCache
+    int previewTileHalo = 0;         // Margin (in preview pixels) processed around tiles
+    int tileHalo = -1;               // Halo of tile-safe filters (in image pixels), -1 if the filter is not tile-safe
+    bool previewDraft = false;       // A low resolution draft may be shown first, if the filter is slow
+    bool previewIsFullImage = false; // The preview factor of the filter is GmicQt::PreviewFactorFullImage
   };
 
   GmicProcessor(QObject * parent = nullptr);
@@ -89,7 +105,7 @@ public:
   bool isIdle() const;
   bool hasUnfinishedAbortedThreads() const;
 
-  const cimg_library::CImg<float> & previewImage() const;
+  std::shared_ptr<const PreviewFrame> previewFrame() const;
   const QStringList & gmicStatus() const;
   const QList<int> & parametersVisibilityStates() const;
 
@@ -108,6 +124,21 @@ public:
 
   int completedFullImageProcessingCount() const;
 
+  /**
+   * @brief Number of input pixel bytes that had to be copied for the last preview
+   *        (0 when the filter could use the cached images without a copy)
+   */
+  std::size_t lastPreviewCopiedBytes() const;
+
+  void setPreviewTileCacheSize(int megaBytes);
+
+  PreviewScheduler::Statistics previewSchedulerStatistics() const;
+
+  /**
+   * @brief Downscale factor and timings of the last preview, for debugging
+   */
+  QString previewResolutionSummary() const;
+
 public slots:
   void cancel();
 
@@ -120,21 +151,38 @@ signals:
   void aboutToSendImagesToHost();
 
 private slots:
-  void onPreviewThreadFinished();
+  void onPreviewResultAvailable();
+  void onAbortedPreviewRunsFinished();
+  void submitPreviewRefinement();
   void onApplyThreadFinished();
+  void outputReusablePreview();
   void onAbortedThreadFinished();
   void showWaitingCursor();
   void hideWaitingCursor();
 
 private:
-  void updateImageNames(cimg_library::CImgList<char> & imageNames);
+  bool updateImageNames(cimg_library::CImgList<char> & imageNames);
   void abortCurrentFilterThread();
   void manageSynchonousRunner(FilterSyncRunner & runner);
+  bool setupTiledPreview();
+  QRectF tiledPreviewFetchedRect() const; // Normalized, as given to CroppedImageListProxy
+  bool cropTiledPreviewInput(std::shared_ptr<const cimg_library::CImgList<gmic_pixel_type>> & images) const;
+  bool assembleTiledPreview(cimg_library::CImgList<float> & images);
+  bool previewDraftIsUseful(const cimg_library::CImgList<float> & images) const;
+  std::shared_ptr<cimg_library::CImgList<float>> previewDraftImages(const cimg_library::CImgList<float> & images, double factor);
+  PreviewFrame::Settings previewFrameSettings(double draftFactor) const;
+  bool showPreviewDraft(FilterSyncRunner & runner);
+  void schedulePreviewRefinement();
+  bool previewIsReusable(std::size_t inputBytes) const;
+  void keepReusablePreview(const FilterSyncRunner & runner);
+  bool reusablePreviewMatchesContext() const;
+  void checkReusablePreview();
+  void sendImagesToHost(const cimg_library::CImgList<char> & imageNames, const QString & name, const QString & fullCommand);
 
   FilterThread * _filterThread;
   FilterContext _filterContext;
   cimg_library::CImgList<float> * _gmicImages;
-  cimg_library::CImg<float> * _previewImage;
+  std::shared_ptr<const PreviewFrame> _previewFrame;
   QList<FilterThread *> _unfinishedAbortedThreads;
 
   unsigned int _previewRandomSeed;
@@ -153,6 +201,52 @@ private:
   QElapsedTimer _filterExecutionTime;
   std::deque<int> _lastFilterPreviewExecutionDurations;
   int _completeFullImageProcessingCount;
+  std::size_t _lastPreviewCopiedBytes;
+
+  struct TiledPreview {
+    bool active;
+    QString keyPrefix;
+    QSize imageSize;             // Size of the whole (zoomed out) image
+    QRect visible;               // Visible area, in image pixels
+    QRect tiles;                 // Columns and rows of the visible tiles
+    QRect processed;             // Area sent to the filter: missing tiles plus halo
+    QSize fullSize;              // Size of the layer
+    QRect fetched;               // Layer pixels sampled for the processed area, fetched from the host
+    QVector<QPoint> missingTiles;
+  };
+  TiledPreview _tiledPreview;
+  PreviewTileCache _previewTiles;
+  PreviewScheduler _previewScheduler;
+  std::unique_ptr<FilterSyncRunner> _previewRefinement; // Full quality pass, submitted once the draft is done
+  std::size_t _previewRefinementBytes;
+  QSize _previewInputSize;
+  QSize _previewDraftInputSize;
+  PreviewResolutionController _previewResolution;
+  QElapsedTimer _previewRequestTime;
+  QTimer _previewIdleTimer;
+  bool _previewIsInteractive;
+  double _lastPreviewPassFactor;
+  int _lastPreviewDraftDuration; // Durations (ms) of the last runs, measured by the runners themselves
+  int _lastPreviewFullDuration;
+  QSet<QString> _untileableFilters;
+
+  // Un-composited output of the last preview, when it was computed on the whole image at actual size
+  struct ReusablePreview {
+    QString command;
+    QString arguments;
+    QString filterHash;
+    GmicQt::InputOutputState inputOutputState;
+    GmicQt::OutputMessageMode outputMessageMode;
+    unsigned int randomSeed;
+    QString name;
+    QString fullCommand;
+    std::shared_ptr<cimg_library::CImgList<float>> images;
+    std::shared_ptr<cimg_library::CImgList<char>> imageNames;
+  };
+  ReusablePreview _reusablePreview;
+  bool _previewImageNamesCorrected;
+  bool _reusablePreviewPending;
+  bool _reusablePreviewCheckPending;
 };
 
 #endif // GMIC_QT_GMICPROCESSOR_H
@@ -23,25 +23,38 @@
  *
  */
 #include "GmicStdlib.h"
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QList>
 #include <QString>
 #include <QStringList>
 #include "Common.h"
+#include "GmicInterpreterPool.h"
 #include "Utils.h"
 #include "gmic.h"
 
 QByteArray GmicStdLib::Array;
+QByteArray GmicStdLib::Key;
 
 void GmicStdLib::loadStdLib()
 {
   QFile stdlib(QString("%1update%2.gmic").arg(GmicQt::path_rc(false)).arg(gmic_version));
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  hash.addData(QByteArray::number(gmic_version));
   if (!stdlib.open(QFile::ReadOnly)) {
     gmic_image<char> stdlib_h = gmic::decompress_stdlib();
     Array = QByteArray::fromRawData(stdlib_h, stdlib_h.size());
     Array[Array.size() - 1] = '\n';
   } else {
     Array = stdlib.readAll();
+    QFileInfo info(stdlib);
+    hash.addData(stdlib.fileName().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
   }
+  Key = hash.result();
+  GmicInterpreterPool::clear();
 }
@@ -32,6 +32,7 @@ public:
   GmicStdLib() = delete;
   static void loadStdLib();
   static QByteArray Array;
+  static QByteArray Key; // Identifies Array, from the G'MIC version and the sizes and dates of its sources
 };
 
 #endif // GMIC_QT_GMICSTDLIB_H
@@ -29,6 +29,7 @@
 #include "Common.h"
 #include "FilterParameters/FilterParametersWidget.h"
 #include "FilterThread.h"
+#include "GmicInterpreterPool.h"
 #include "GmicStdlib.h"
 #include "ParametersCache.h"
 #include "Updater.h"
@@ -104,7 +105,8 @@ void HeadlessProcessor::startProcessing()
 {
   _singleShotTimer.start();
   Updater::getInstance()->updateSources(false);
-  GmicStdLib::Array = Updater::getInstance()->buildFullStdlib();
+  GmicStdLib::Array = Updater::getInstance()->buildFullStdlib(&GmicStdLib::Key);
+  GmicInterpreterPool::clear();
   _gmicImages->assign();
   gmic_list<char> imageNames;
   gmic_qt_get_cropped_images(*_gmicImages, imageNames, -1, -1, -1, -1, _inputMode);
@@ -25,19 +25,26 @@
 #include <QApplication>
 #include <QDebug>
 #include <QDesktopWidget>
+#include <QDir>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QFont>
 #include <QMessageBox>
 #include <QPainter>
 #include <QRegularExpression>
+#include <QThread>
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include "Common.h"
+#include "Globals.h"
 #include "Host/None/ImageDialog.h"
 #include "Host/host.h"
 #include "ImageConverter.h"
 #include "MainWindow.h"
+#include "Utils.h"
+#include "WorkerPool.h"
+#include "WorkerProcess.h"
 #include "gmic_qt.h"
 #include "gmic.h"
 
@@ -87,6 +94,77 @@ const QImage & transparentImage()
   }
   return image;
 }
+void saveBatchOutput(const cimg_library::CImgList<float> & images, const QString & filename)
+{
+  const QFileInfo info(filename);
+  for (unsigned int i = 0; i < images.size(); ++i) {
+    const QString suffix = (images.size() > 1) ? QString("_gmic_%1.png").arg(i) : QString("_gmic.png");
+    const QString output = info.dir().filePath(info.completeBaseName() + suffix);
+    QImage image;
+    ImageConverter::convert(images[i], image);
+    if (!image.save(output)) {
+      std::cerr << "Cannot write " << output.toLocal8Bit().constData() << "\n";
+    }
+  }
+}
+/**
+ * gmic_qt --batch <command> <image>...        One job per image
+ * gmic_qt --batch-tiles <command> <image> [halo]  One job per band of the image (command must be tile-safe)
+ */
+int runBatch(const QStringList & arguments)
+{
+  const bool tiles = (arguments[1] == "--batch-tiles");
+  const QString command = arguments[2];
+  const QStringList filenames = tiles ? arguments.mid(3, 1) : arguments.mid(3);
+  bool ok = true;
+  const int halo = (tiles && (arguments.size() > 4)) ? arguments[4].toInt(&ok) : WORKER_DEFAULT_TILE_HALO;
+  if (!ok) {
+    std::cerr << "Invalid halo: " << arguments[4].toLocal8Bit().constData() << "\n";
+    return 1;
+  }
+  const int workerCount = qEnvironmentVariableIsSet("GMIC_QT_WORKERS") ? qEnvironmentVariableIntValue("GMIC_QT_WORKERS") : QThread::idealThreadCount();
+  WorkerPool pool(nullptr, workerCount);
+  QList<int> jobs;
+  int failures = 0;
+  for (const QString & filename : filenames) {
+    QImage qimage;
+    if (!qimage.load(filename)) {
+      std::cerr << "Cannot read " << filename.toLocal8Bit().constData() << "\n";
+      ++failures;
+      jobs.push_back(-1);
+      continue;
+    }
+    std::shared_ptr<cimg_library::CImgList<float>> images(new cimg_library::CImgList<float>(1));
+    ImageConverter::convert(qimage.convertToFormat(QImage::Format_ARGB32), (*images)[0]);
+    if (tiles) {
+      QString message;
+      if (pool.runTiled(command, QString(), (*images)[0], halo, message)) {
+        saveBatchOutput(*images, filename);
+      } else {
+        std::cerr << filename.toLocal8Bit().constData() << ": " << message.toLocal8Bit().constData() << "\n";
+        ++failures;
+      }
+    } else {
+      jobs.push_back(pool.submit(command, QString(), std::move(images)));
+    }
+  }
+  pool.waitForDone();
+  for (int i = 0; i < jobs.size(); ++i) {
+    if (jobs[i] == -1) {
+      continue;
+    }
+    const QString message = pool.errorMessage(jobs[i]);
+    std::shared_ptr<cimg_library::CImgList<float>> output = pool.takeOutput(jobs[i]);
+    if (output) {
+      saveBatchOutput(*output, filenames[i]);
+    } else {
+      std::cerr << filenames[i].toLocal8Bit().constData() << ": " << message.toLocal8Bit().constData() << "\n";
+      ++failures;
+    }
+  }
+  pool.report(std::cout);
+  return failures ? 1 : 0;
+}
 } // namespace gmic_qt_standalone
 
 namespace GmicQt
@@ -195,6 +273,16 @@ int main(int argc, char * argv[])
   if (argc == 2) {
     filename = argv[1];
   }
+  if (filename == "--worker") {
+    QCoreApplication app(argc, argv);
+    GmicQt::setupApplication();
+    return WorkerProcess::exec();
+  }
+  if ((argc >= 4) && (!strcmp(argv[1], "--batch") || !strcmp(argv[1], "--batch-tiles"))) {
+    QCoreApplication app(argc, argv);
+    GmicQt::setupApplication();
+    return gmic_qt_standalone::runBatch(QCoreApplication::arguments());
+  }
 #ifdef DEFAULT_IMAGE
   if (filename.isEmpty() && QFileInfo(DEFAULT_IMAGE).isReadable()) {
     filename = DEFAULT_IMAGE;
@@ -92,6 +92,10 @@ void gmic_qt_output_images(cimg_library::CImgList<gmic_pixel_type> & images, con
 /**
  * @brief Apply a color profile to a given image
  *
+ * Preview frames are built by the threads running the filters, hence this
+ * function may be called from any thread, concurrently. It must not use
+ * widgets nor any non thread-safe state of the host.
+ *
  * @param [in,out] images An image
  */
 void gmic_qt_apply_color_profile(cimg_library::CImg<gmic_pixel_type> & images);
@@ -25,29 +25,249 @@
 
 #include "HtmlTranslator.h"
 #include <QDebug>
-#include <QRegularExpression>
+#include <QSet>
 #include "CImg.h"
 #include "Common.h"
+#include "Globals.h"
 
-QTextDocument HtmlTranslator::_document;
+QThreadStorage<QTextDocument *> HtmlTranslator::_documents;
+QThreadStorage<QHash<QString, QString> *> HtmlTranslator::_plainTexts;
+
+namespace
+{
+inline bool isAsciiLetter(ushort c)
+{
+  return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'));
+}
+
+inline bool isHexDigit(ushort c)
+{
+  return ((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f')) || ((c >= 'A') && (c <= 'F'));
+}
+
+inline bool isTextDocumentSeparator(ushort c)
+{
+  // Characters replaced by toPlainText()
+  return (c == 0x2028) || (c == 0x2029) || (c == 0xfdd0) || (c == 0xfdd1);
+}
+} // namespace
 
 // TODO : enum param force + enum param translate
 QString HtmlTranslator::html2txt(const QString & str, bool force)
 {
   if (force || hasHtmlEntities(str)) {
-    _document.setHtml(str);
-    return fromUtf8Escapes(_document.toPlainText());
+    // Folder names, in particular, are converted many times
+    QHash<QString, QString> & cache = plainTexts();
+    QHash<QString, QString>::const_iterator it = cache.constFind(str);
+    if (it != cache.constEnd()) {
+      return it.value();
+    }
+    QString text;
+    if (!decodeInlineHtml(str, text)) {
+      text = documentPlainText(str);
+    }
+    text = fromUtf8Escapes(text);
+    if (cache.size() >= HTML_TRANSLATOR_CACHE_SIZE) {
+      cache.clear();
+    }
+    cache.insert(str, text);
+    return text;
   }
   return fromUtf8Escapes(str);
 }
 
 bool HtmlTranslator::hasHtmlEntities(const QString & str)
 {
-  return str.contains(QRegularExpression("&[a-zA-Z]+;")) || str.contains(QRegularExpression("&#x?[0-9A-Fa-f]+;")) || str.contains(QRegularExpression("<[a-zA-Z]*>"));
+  // Same as matching one of the regular expressions "&[a-zA-Z]+;", "&#x?[0-9A-Fa-f]+;" or "<[a-zA-Z]*>"
+  const QChar * data = str.constData();
+  const int size = str.size();
+  for (int i = 0; i < size; ++i) {
+    const ushort c = data[i].unicode();
+    int j = i + 1;
+    if (c == '&') {
+      if ((j < size) && (data[j] == QChar('#'))) {
+        ++j;
+        if ((j < size) && (data[j] == QChar('x'))) {
+          ++j;
+        }
+        const int digits = j;
+        while ((j < size) && isHexDigit(data[j].unicode())) {
+          ++j;
+        }
+        if ((j > digits) && (j < size) && (data[j] == QChar(';'))) {
+          return true;
+        }
+      } else {
+        while ((j < size) && isAsciiLetter(data[j].unicode())) {
+          ++j;
+        }
+        if ((j > i + 1) && (j < size) && (data[j] == QChar(';'))) {
+          return true;
+        }
+      }
+    } else if (c == '<') {
+      while ((j < size) && isAsciiLetter(data[j].unicode())) {
+        ++j;
+      }
+      if ((j < size) && (data[j] == QChar('>'))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+QTextDocument & HtmlTranslator::document()
+{
+  if (!_documents.hasLocalData()) {
+    _documents.setLocalData(new QTextDocument);
+  }
+  return *_documents.localData();
+}
+
+QHash<QString, QString> & HtmlTranslator::plainTexts()
+{
+  if (!_plainTexts.hasLocalData()) {
+    _plainTexts.setLocalData(new QHash<QString, QString>);
+  }
+  return *_plainTexts.localData();
+}
+
+QString HtmlTranslator::documentPlainText(const QString & html)
+{
+  QTextDocument & doc = document();
+  doc.setHtml(html);
+  return doc.toPlainText();
+}
+
+bool HtmlTranslator::decodeInlineHtml(const QString & html, QString & text)
+{
+  // Handles the markup found in filter names: inline tags (<b>, <i>, <font ...>, etc.)
+  // and a few entities. Returns false for anything else, which is left to QTextDocument.
+  text.clear();
+  text.reserve(html.size());
+  bool pendingSpace = false; // Collapsed white spaces
+  const QChar * it = html.constData();
+  const QChar * end = it + html.size();
+  while (it != end) {
+    const ushort c = it->unicode();
+    QChar decoded;
+    if (c == '<') {
+      if (!skipInlineTag(it, end)) {
+        return false;
+      }
+      continue;
+    }
+    if (c == '&') {
+      if (!decodeEntity(it, end, decoded)) {
+        return false;
+      }
+    } else if (isTextDocumentSeparator(c)) {
+      return false;
+    } else if (it->isSpace() && (c != QChar::Nbsp)) {
+      if (text.isEmpty()) {
+        return false; // Leading white spaces
+      }
+      pendingSpace = true;
+      ++it;
+      continue;
+    } else {
+      decoded = *it++;
+    }
+    if (pendingSpace) {
+      text += QChar(' ');
+      pendingSpace = false;
+    }
+    text += (decoded.unicode() == QChar::Nbsp) ? QChar(' ') : decoded;
+  }
+  return !pendingSpace; // Trailing white spaces are left to QTextDocument
+}
+
+bool HtmlTranslator::skipInlineTag(const QChar *& it, const QChar * end)
+{
+  static const QSet<QString> inlineTags = {"b", "i", "u", "em", "strong", "font", "span", "small", "big", "sub", "sup"};
+  const QChar * p = it + 1;
+  const bool closing = (p != end) && (*p == QChar('/'));
+  if (closing) {
+    ++p;
+  }
+  const QChar * name = p;
+  while ((p != end) && isAsciiLetter(p->unicode())) {
+    ++p;
+  }
+  if ((p == name) || ((p != end) && (*p != QChar('>')) && !p->isSpace()) || !inlineTags.contains(QString(name, int(p - name)).toLower())) {
+    return false;
+  }
+  // Attributes, possibly quoted
+  QChar quote;
+  QChar previous;
+  while ((p != end) && (!quote.isNull() || (*p != QChar('>')))) {
+    if ((closing && !p->isSpace()) || (quote.isNull() && (*p == QChar('<')))) {
+      return false;
+    }
+    if (quote.isNull() && ((*p == QChar('"')) || (*p == QChar('\'')))) {
+      quote = *p;
+    } else if (*p == quote) {
+      quote = QChar();
+    }
+    if (!p->isSpace()) {
+      previous = *p;
+    }
+    ++p;
+  }
+  if ((p == end) || (previous == QChar('/'))) {
+    return false;
+  }
+  it = p + 1;
+  return true;
+}
+
+bool HtmlTranslator::decodeEntity(const QChar *& it, const QChar * end, QChar & decoded)
+{
+  const QChar * semicolon = it + 1;
+  while ((semicolon != end) && (*semicolon != QChar(';')) && (semicolon - it < 10)) {
+    ++semicolon;
+  }
+  if ((semicolon == end) || (*semicolon != QChar(';'))) {
+    return false;
+  }
+  const QString name(it + 1, int(semicolon - it - 1));
+  if (name.startsWith(QChar('#'))) {
+    bool ok = false;
+    uint value;
+    if (name.startsWith("#x") || name.startsWith("#X")) {
+      value = name.midRef(2).toUInt(&ok, 16);
+    } else {
+      value = name.midRef(1).toUInt(&ok, 10);
+    }
+    // Control, Windows-1252 remapped, surrogate, non-BMP and white space characters are left to QTextDocument
+    if (!ok || (value < 0x20) || ((value >= 0x7f) && (value < 0xa0)) || ((value >= 0xd800) && (value < 0xe000)) || (value > 0xfffd) ||
+        isTextDocumentSeparator(ushort(value)) || (QChar(value).isSpace() && (value != QChar::Nbsp))) {
+      return false;
+    }
+    decoded = QChar(value);
+  } else if (name == "amp") {
+    decoded = QChar('&');
+  } else if (name == "lt") {
+    decoded = QChar('<');
+  } else if (name == "gt") {
+    decoded = QChar('>');
+  } else if (name == "quot") {
+    decoded = QChar('"');
+  } else if (name == "nbsp") {
+    decoded = QChar(QChar::Nbsp);
+  } else {
+    return false;
+  }
+  it = semicolon + 1;
+  return true;
 }
 
 QString HtmlTranslator::fromUtf8Escapes(const QString & str)
 {
+  if (!str.contains(QChar('\\'))) {
+    return str; // strunescape() only replaces escape sequences
+  }
   QByteArray ba = str.toUtf8();
   cimg_library::cimg::strunescape(ba.data());
   return QString::fromUtf8(ba);
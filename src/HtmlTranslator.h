@@ -25,8 +25,10 @@
 #ifndef GMIC_QT_HTMLTRANSLATOR_H
 #define GMIC_QT_HTMLTRANSLATOR_H
 
+#include <QHash>
 #include <QString>
 #include <QTextDocument>
+#include <QThreadStorage>
 
 class HtmlTranslator {
 public:
@@ -35,7 +37,15 @@ public:
   static QString fromUtf8Escapes(const QString & str);
 
 private:
-  static QTextDocument _document;
+  friend class HtmlTranslatorBenchmark;
+  static bool decodeInlineHtml(const QString & html, QString & text);
+  static bool skipInlineTag(const QChar *& it, const QChar * end);
+  static bool decodeEntity(const QChar *& it, const QChar * end, QChar & decoded);
+  static QString documentPlainText(const QString & html);
+  static QTextDocument & document();
+  static QHash<QString, QString> & plainTexts();
+  static QThreadStorage<QTextDocument *> _documents; // Filters may be parsed by a worker thread
+  static QThreadStorage<QHash<QString, QString> *> _plainTexts;
 };
 
 #endif //  GMIC_QT_HTMLTRANSLATOR_H
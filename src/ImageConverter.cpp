@@ -25,9 +25,26 @@
 #include "ImageConverter.h"
 #include <QDebug>
 #include <QImage>
+#include <algorithm>
+#include <vector>
 #include "Common.h"
+#include "ImageTools.h"
+#include "Utils.h"
 #include "gmic.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define GMIC_QT_CONVERTER_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GMIC_QT_CONVERTER_AVX2
+#include <immintrin.h>
+#endif
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GMIC_QT_CONVERTER_NEON
+#include <arm_neon.h>
+#endif
+
 namespace
 {
 inline bool archIsLittleEndian()
@@ -36,9 +53,327 @@ inline bool archIsLittleEndian()
   return (*reinterpret_cast<const unsigned char *>(&x));
 }
 
+// NaN gives 0, as in the vectorized kernels
 inline unsigned char float2uchar_bounded(const float & in)
 {
-  return (in < 0.0f) ? 0 : ((in > 255.0f) ? 255 : static_cast<unsigned char>(in));
+  return (in >= 0.0f) ? ((in > 255.0f) ? 255 : static_cast<unsigned char>(in)) : 0;
+}
+
+typedef ImageConverter::ConversionKernels ConversionKernels;
+
+void scalarPlanarToInterleaved4(const float * c0, const float * c1, const float * c2, const float * c3, unsigned char * dst, int n)
+{
+  while (n--) {
+    dst[0] = float2uchar_bounded(*c0++);
+    dst[1] = float2uchar_bounded(*c1++);
+    dst[2] = float2uchar_bounded(*c2++);
+    dst[3] = float2uchar_bounded(*c3++);
+    dst += 4;
+  }
+}
+
+void scalarPlanarToInterleaved3(const float * c0, const float * c1, const float * c2, unsigned char * dst, int n)
+{
+  while (n--) {
+    dst[0] = float2uchar_bounded(*c0++);
+    dst[1] = float2uchar_bounded(*c1++);
+    dst[2] = float2uchar_bounded(*c2++);
+    dst += 3;
+  }
+}
+
+void scalarPlanarToGray(const float * src, unsigned char * dst, int n)
+{
+  while (n--) {
+    *dst++ = float2uchar_bounded(*src++);
+  }
+}
+
+void scalarInterleaved4ToPlanar(const unsigned char * src, float * c0, float * c1, float * c2, float * c3, int n)
+{
+  while (n--) {
+    *c0++ = static_cast<float>(src[0]);
+    *c1++ = static_cast<float>(src[1]);
+    *c2++ = static_cast<float>(src[2]);
+    *c3++ = static_cast<float>(src[3]);
+    src += 4;
+  }
+}
+
+void scalarInterleaved3ToPlanar(const unsigned char * src, float * c0, float * c1, float * c2, int n)
+{
+  while (n--) {
+    *c0++ = static_cast<float>(src[0]);
+    *c1++ = static_cast<float>(src[1]);
+    *c2++ = static_cast<float>(src[2]);
+    src += 3;
+  }
+}
+
+#ifdef GMIC_QT_CONVERTER_SSE2
+
+// 16 floats to 16 bytes, clamped to [0,255] and truncated (as float2uchar_bounded).
+// _mm_max_ps returns its second operand when the first one is NaN, hence NaN gives 0.
+inline __m128i sse2Pack16(const float * p)
+{
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 max = _mm_set1_ps(255.0f);
+  const __m128i a = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(p), zero), max));
+  const __m128i b = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(p + 4), zero), max));
+  const __m128i c = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(p + 8), zero), max));
+  const __m128i d = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(p + 12), zero), max));
+  return _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+}
+
+// Interleave 4 x 16 bytes as 16 pixels (64 bytes)
+inline void sse2Store4(const __m128i v0, const __m128i v1, const __m128i v2, const __m128i v3, unsigned char * dst)
+{
+  const __m128i v01lo = _mm_unpacklo_epi8(v0, v1);
+  const __m128i v01hi = _mm_unpackhi_epi8(v0, v1);
+  const __m128i v23lo = _mm_unpacklo_epi8(v2, v3);
+  const __m128i v23hi = _mm_unpackhi_epi8(v2, v3);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi16(v01lo, v23lo));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_unpackhi_epi16(v01lo, v23lo));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 32), _mm_unpacklo_epi16(v01hi, v23hi));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 48), _mm_unpackhi_epi16(v01hi, v23hi));
+}
+
+void sse2PlanarToInterleaved4(const float * c0, const float * c1, const float * c2, const float * c3, unsigned char * dst, int n)
+{
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    sse2Store4(sse2Pack16(c0 + i), sse2Pack16(c1 + i), sse2Pack16(c2 + i), sse2Pack16(c3 + i), dst + 4 * i);
+  }
+  scalarPlanarToInterleaved4(c0 + i, c1 + i, c2 + i, c3 + i, dst + 4 * i, n - i);
+}
+
+void sse2PlanarToInterleaved3(const float * c0, const float * c1, const float * c2, unsigned char * dst, int n)
+{
+  // No byte shuffle in SSE2: clamping and conversion are vectorized, interleaving is not
+  alignas(16) unsigned char bytes[3][16];
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm_store_si128(reinterpret_cast<__m128i *>(bytes[0]), sse2Pack16(c0 + i));
+    _mm_store_si128(reinterpret_cast<__m128i *>(bytes[1]), sse2Pack16(c1 + i));
+    _mm_store_si128(reinterpret_cast<__m128i *>(bytes[2]), sse2Pack16(c2 + i));
+    unsigned char * out = dst + 3 * i;
+    for (int k = 0; k < 16; ++k) {
+      out[0] = bytes[0][k];
+      out[1] = bytes[1][k];
+      out[2] = bytes[2][k];
+      out += 3;
+    }
+  }
+  scalarPlanarToInterleaved3(c0 + i, c1 + i, c2 + i, dst + 3 * i, n - i);
+}
+
+void sse2PlanarToGray(const float * src, unsigned char * dst, int n)
+{
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), sse2Pack16(src + i));
+  }
+  scalarPlanarToGray(src + i, dst + i, n - i);
+}
+
+void sse2Interleaved4ToPlanar(const unsigned char * src, float * c0, float * c1, float * c2, float * c3, int n)
+{
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i));
+    _mm_storeu_ps(c0 + i, _mm_cvtepi32_ps(_mm_and_si128(v, mask)));
+    _mm_storeu_ps(c1 + i, _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 8), mask)));
+    _mm_storeu_ps(c2 + i, _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 16), mask)));
+    _mm_storeu_ps(c3 + i, _mm_cvtepi32_ps(_mm_srli_epi32(v, 24)));
+  }
+  scalarInterleaved4ToPlanar(src + 4 * i, c0 + i, c1 + i, c2 + i, c3 + i, n - i);
+}
+
+#endif // GMIC_QT_CONVERTER_SSE2
+
+#ifdef GMIC_QT_CONVERTER_AVX2
+
+// 32 floats to 32 bytes, clamped to [0,255] and truncated (NaN gives 0, as with SSE2)
+__attribute__((target("avx2"))) inline __m256i avx2Pack32(const float * p)
+{
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 max = _mm256_set1_ps(255.0f);
+  const __m256i a = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(p), zero), max));
+  const __m256i b = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(p + 8), zero), max));
+  const __m256i c = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(p + 16), zero), max));
+  const __m256i d = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(p + 24), zero), max));
+  // Packing works on 128 bits lanes: 32 bits groups come out as a0 b0 c0 d0 a1 b1 c1 d1
+  const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+  return _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+__attribute__((target("avx2"))) void avx2PlanarToInterleaved4(const float * c0, const float * c1, const float * c2, const float * c3, unsigned char * dst, int n)
+{
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i v0 = avx2Pack32(c0 + i);
+    const __m256i v1 = avx2Pack32(c1 + i);
+    const __m256i v2 = avx2Pack32(c2 + i);
+    const __m256i v3 = avx2Pack32(c3 + i);
+    sse2Store4(_mm256_castsi256_si128(v0), _mm256_castsi256_si128(v1), _mm256_castsi256_si128(v2), _mm256_castsi256_si128(v3), dst + 4 * i);
+    sse2Store4(_mm256_extracti128_si256(v0, 1), _mm256_extracti128_si256(v1, 1), _mm256_extracti128_si256(v2, 1), _mm256_extracti128_si256(v3, 1), dst + 4 * i + 64);
+  }
+  scalarPlanarToInterleaved4(c0 + i, c1 + i, c2 + i, c3 + i, dst + 4 * i, n - i);
+}
+
+__attribute__((target("avx2"))) void avx2PlanarToInterleaved3(const float * c0, const float * c1, const float * c2, unsigned char * dst, int n)
+{
+  alignas(32) unsigned char bytes[3][32];
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    _mm256_store_si256(reinterpret_cast<__m256i *>(bytes[0]), avx2Pack32(c0 + i));
+    _mm256_store_si256(reinterpret_cast<__m256i *>(bytes[1]), avx2Pack32(c1 + i));
+    _mm256_store_si256(reinterpret_cast<__m256i *>(bytes[2]), avx2Pack32(c2 + i));
+    unsigned char * out = dst + 3 * i;
+    for (int k = 0; k < 32; ++k) {
+      out[0] = bytes[0][k];
+      out[1] = bytes[1][k];
+      out[2] = bytes[2][k];
+      out += 3;
+    }
+  }
+  scalarPlanarToInterleaved3(c0 + i, c1 + i, c2 + i, dst + 3 * i, n - i);
+}
+
+__attribute__((target("avx2"))) void avx2PlanarToGray(const float * src, unsigned char * dst, int n)
+{
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), avx2Pack32(src + i));
+  }
+  scalarPlanarToGray(src + i, dst + i, n - i);
+}
+
+__attribute__((target("avx2"))) void avx2Interleaved4ToPlanar(const unsigned char * src, float * c0, float * c1, float * c2, float * c3, int n)
+{
+  const __m256i mask = _mm256_set1_epi32(0xFF);
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * i));
+    _mm256_storeu_ps(c0 + i, _mm256_cvtepi32_ps(_mm256_and_si256(v, mask)));
+    _mm256_storeu_ps(c1 + i, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(v, 8), mask)));
+    _mm256_storeu_ps(c2 + i, _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(v, 16), mask)));
+    _mm256_storeu_ps(c3 + i, _mm256_cvtepi32_ps(_mm256_srli_epi32(v, 24)));
+  }
+  scalarInterleaved4ToPlanar(src + 4 * i, c0 + i, c1 + i, c2 + i, c3 + i, n - i);
+}
+
+#endif // GMIC_QT_CONVERTER_AVX2
+
+#ifdef GMIC_QT_CONVERTER_NEON
+
+// 8 floats to 8 bytes, clamped to [0,255] and truncated (negative values and NaN are converted to 0)
+inline uint8x8_t neonPack8(const float * p)
+{
+  const float32x4_t max = vdupq_n_f32(255.0f);
+  const uint32x4_t a = vcvtq_u32_f32(vminq_f32(vld1q_f32(p), max));
+  const uint32x4_t b = vcvtq_u32_f32(vminq_f32(vld1q_f32(p + 4), max));
+  return vqmovn_u16(vcombine_u16(vqmovn_u32(a), vqmovn_u32(b)));
+}
+
+inline void neonStoreFloats(uint8x8_t v, float * dst)
+{
+  const uint16x8_t w = vmovl_u8(v);
+  vst1q_f32(dst, vcvtq_f32_u32(vmovl_u16(vget_low_u16(w))));
+  vst1q_f32(dst + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(w))));
+}
+
+void neonPlanarToInterleaved4(const float * c0, const float * c1, const float * c2, const float * c3, unsigned char * dst, int n)
+{
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint8x8x4_t v;
+    v.val[0] = neonPack8(c0 + i);
+    v.val[1] = neonPack8(c1 + i);
+    v.val[2] = neonPack8(c2 + i);
+    v.val[3] = neonPack8(c3 + i);
+    vst4_u8(dst + 4 * i, v);
+  }
+  scalarPlanarToInterleaved4(c0 + i, c1 + i, c2 + i, c3 + i, dst + 4 * i, n - i);
+}
+
+void neonPlanarToInterleaved3(const float * c0, const float * c1, const float * c2, unsigned char * dst, int n)
+{
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint8x8x3_t v;
+    v.val[0] = neonPack8(c0 + i);
+    v.val[1] = neonPack8(c1 + i);
+    v.val[2] = neonPack8(c2 + i);
+    vst3_u8(dst + 3 * i, v);
+  }
+  scalarPlanarToInterleaved3(c0 + i, c1 + i, c2 + i, dst + 3 * i, n - i);
+}
+
+void neonPlanarToGray(const float * src, unsigned char * dst, int n)
+{
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    vst1_u8(dst + i, neonPack8(src + i));
+  }
+  scalarPlanarToGray(src + i, dst + i, n - i);
+}
+
+void neonInterleaved4ToPlanar(const unsigned char * src, float * c0, float * c1, float * c2, float * c3, int n)
+{
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const uint8x8x4_t v = vld4_u8(src + 4 * i);
+    neonStoreFloats(v.val[0], c0 + i);
+    neonStoreFloats(v.val[1], c1 + i);
+    neonStoreFloats(v.val[2], c2 + i);
+    neonStoreFloats(v.val[3], c3 + i);
+  }
+  scalarInterleaved4ToPlanar(src + 4 * i, c0 + i, c1 + i, c2 + i, c3 + i, n - i);
+}
+
+void neonInterleaved3ToPlanar(const unsigned char * src, float * c0, float * c1, float * c2, int n)
+{
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const uint8x8x3_t v = vld3_u8(src + 3 * i);
+    neonStoreFloats(v.val[0], c0 + i);
+    neonStoreFloats(v.val[1], c1 + i);
+    neonStoreFloats(v.val[2], c2 + i);
+  }
+  scalarInterleaved3ToPlanar(src + 3 * i, c0 + i, c1 + i, c2 + i, n - i);
+}
+
+#endif // GMIC_QT_CONVERTER_NEON
+
+} // namespace
+
+std::vector<ImageConverter::ConversionKernels> ImageConverter::availableKernels()
+{
+  std::vector<ConversionKernels> result;
+  result.push_back({"scalar", scalarPlanarToInterleaved4, scalarPlanarToInterleaved3, scalarPlanarToGray, scalarInterleaved4ToPlanar, scalarInterleaved3ToPlanar});
+#ifdef GMIC_QT_CONVERTER_SSE2
+  result.push_back({"sse2", sse2PlanarToInterleaved4, sse2PlanarToInterleaved3, sse2PlanarToGray, sse2Interleaved4ToPlanar, scalarInterleaved3ToPlanar});
+#endif
+#ifdef GMIC_QT_CONVERTER_AVX2
+  if (__builtin_cpu_supports("avx2")) {
+    result.push_back({"avx2", avx2PlanarToInterleaved4, avx2PlanarToInterleaved3, avx2PlanarToGray, avx2Interleaved4ToPlanar, scalarInterleaved3ToPlanar});
+  }
+#endif
+#ifdef GMIC_QT_CONVERTER_NEON
+  result.push_back({"neon", neonPlanarToInterleaved4, neonPlanarToInterleaved3, neonPlanarToGray, neonInterleaved4ToPlanar, neonInterleaved3ToPlanar});
+#endif
+  return result;
+}
+
+namespace
+{
+const ConversionKernels & kernels()
+{
+  // GMIC_QT_NO_SIMD may be set to compare results with the scalar kernels
+  static const ConversionKernels selected = qgetenv("GMIC_QT_NO_SIMD").isEmpty() ? ImageConverter::availableKernels().back() : ImageConverter::availableKernels().front();
+  return selected;
 }
 
 } // namespace
@@ -72,103 +407,69 @@ void ImageConverter::convert(const cimg_library::CImg<float> & in, QImage & out)
   }
 #endif
 
+  const ConversionKernels & k = kernels();
+  const int width = in.width();
+  const int height = out.height();
+  const bool littleEndian = archIsLittleEndian();
+  // Scanlines are addressed from bits(), as scanLine() may not be called concurrently
+  unsigned char * const bits = out.bits();
+  const int bytesPerLine = out.bytesPerLine();
   if (in.spectrum() == 3) {
     const float * srcR = in.data(0, 0, 0, 0);
     const float * srcG = in.data(0, 0, 0, 1);
     const float * srcB = in.data(0, 0, 0, 2);
-    int height = out.height();
-    for (int y = 0; y < height; ++y) {
-      int n = in.width();
-      unsigned char * dst = out.scanLine(y);
-      while (n--) {
-        dst[0] = float2uchar_bounded(*srcR++);
-        dst[1] = float2uchar_bounded(*srcG++);
-        dst[2] = float2uchar_bounded(*srcB++);
-        dst += 3;
+    GmicQt::parallelForRows(height, width, [&](int firstRow, int lastRow) {
+      for (int y = firstRow; y <= lastRow; ++y) {
+        const int offset = y * width;
+        k.planarToInterleaved3(srcR + offset, srcG + offset, srcB + offset, bits + y * bytesPerLine, width);
       }
-    }
+    });
   } else if (in.spectrum() == 4) {
     const float * srcR = in.data(0, 0, 0, 0);
     const float * srcG = in.data(0, 0, 0, 1);
     const float * srcB = in.data(0, 0, 0, 2);
     const float * srcA = in.data(0, 0, 0, 3);
-    int height = out.height();
-    if (archIsLittleEndian()) {
-      for (int y = 0; y < height; ++y) {
-        int n = in.width();
-        unsigned char * dst = out.scanLine(y);
-        while (n--) {
-          dst[0] = float2uchar_bounded(*srcB++);
-          dst[1] = float2uchar_bounded(*srcG++);
-          dst[2] = float2uchar_bounded(*srcR++);
-          dst[3] = float2uchar_bounded(*srcA++);
-          dst += 4;
+    GmicQt::parallelForRows(height, width, [&](int firstRow, int lastRow) {
+      for (int y = firstRow; y <= lastRow; ++y) {
+        const int offset = y * width;
+        if (littleEndian) {
+          k.planarToInterleaved4(srcB + offset, srcG + offset, srcR + offset, srcA + offset, bits + y * bytesPerLine, width);
+        } else {
+          k.planarToInterleaved4(srcA + offset, srcR + offset, srcG + offset, srcB + offset, bits + y * bytesPerLine, width);
         }
       }
-    } else {
-      for (int y = 0; y < height; ++y) {
-        int n = in.width();
-        unsigned char * dst = out.scanLine(y);
-        while (n--) {
-          dst[0] = float2uchar_bounded(*srcA++);
-          dst[1] = float2uchar_bounded(*srcR++);
-          dst[2] = float2uchar_bounded(*srcG++);
-          dst[3] = float2uchar_bounded(*srcB++);
-          dst += 4;
-        }
-      }
-    }
+    });
   } else if (in.spectrum() == 2) {
     //
     // Gray + Alpha
     //
     const float * src = in.data(0, 0, 0, 0);
     const float * srcA = in.data(0, 0, 0, 1);
-    int height = out.height();
-    if (archIsLittleEndian()) {
-      for (int y = 0; y < height; ++y) {
-        int n = in.width();
-        unsigned char * dst = out.scanLine(y);
-        while (n--) {
-          dst[2] = dst[1] = dst[0] = float2uchar_bounded(*src++);
-          dst[3] = float2uchar_bounded(*srcA++);
-          dst += 4;
-        }
-      }
-    } else {
-      for (int y = 0; y < height; ++y) {
-        int n = in.width();
-        unsigned char * dst = out.scanLine(y);
-        while (n--) {
-          dst[1] = dst[2] = dst[3] = float2uchar_bounded(*src++);
-          dst[0] = float2uchar_bounded(*srcA++);
-          dst += 4;
+    GmicQt::parallelForRows(height, width, [&](int firstRow, int lastRow) {
+      for (int y = firstRow; y <= lastRow; ++y) {
+        const int offset = y * width;
+        if (littleEndian) {
+          k.planarToInterleaved4(src + offset, src + offset, src + offset, srcA + offset, bits + y * bytesPerLine, width);
+        } else {
+          k.planarToInterleaved4(srcA + offset, src + offset, src + offset, src + offset, bits + y * bytesPerLine, width);
         }
       }
-    }
+    });
   } else {
     //
     // 8-bits Gray levels
     //
     const float * src = in.data(0, 0, 0, 0);
-    int height = out.height();
-    for (int y = 0; y < height; ++y) {
-      int n = in.width();
-      unsigned char * dst = out.scanLine(y);
+    GmicQt::parallelForRows(height, width, [&](int firstRow, int lastRow) {
+      for (int y = firstRow; y <= lastRow; ++y) {
+        const int offset = y * width;
 #if ((QT_VERSION_MAJOR == 5) && (QT_VERSION_MINOR > 4)) || (QT_VERSION_MAJOR >= 6)
-      while (n--) {
-        *dst++ = static_cast<unsigned char>(*src++);
-      }
+        k.planarToGray(src + offset, bits + y * bytesPerLine, width);
 #else
-      while (n--) {
-        dst[0] = float2uchar_bounded(*src);
-        dst[1] = float2uchar_bounded(*src);
-        dst[2] = float2uchar_bounded(*src);
-        ++src;
-        dst += 3;
-      }
+        k.planarToInterleaved3(src + offset, src + offset, src + offset, bits + y * bytesPerLine, width);
 #endif
-    }
+      }
+    });
   }
 }
 
@@ -176,6 +477,9 @@ void ImageConverter::convert(const QImage & in, cimg_library::CImg<float> & out)
 {
   Q_ASSERT_X(in.format() == QImage::Format_ARGB32 || in.format() == QImage::Format_RGB888, "convert", "bad input format");
 
+  const ConversionKernels & k = kernels();
+  const unsigned char * const bits = in.constBits();
+  const int bytesPerLine = in.bytesPerLine();
   if (in.format() == QImage::Format_ARGB32) {
     const int w = in.width();
     const int h = in.height();
@@ -184,31 +488,17 @@ void ImageConverter::convert(const QImage & in, cimg_library::CImg<float> & out)
     float * dstG = out.data(0, 0, 0, 1);
     float * dstB = out.data(0, 0, 0, 2);
     float * dstA = out.data(0, 0, 0, 3);
-    if (archIsLittleEndian()) {
-      for (int y = 0; y < h; ++y) {
-        const unsigned char * src = in.scanLine(y);
-        int n = in.width();
-        while (n--) {
-          *dstB++ = static_cast<float>(src[0]);
-          *dstG++ = static_cast<float>(src[1]);
-          *dstR++ = static_cast<float>(src[2]);
-          *dstA++ = static_cast<float>(src[3]);
-          src += 4;
-        }
-      }
-    } else {
-      for (int y = 0; y < h; ++y) {
-        const unsigned char * src = in.scanLine(y);
-        int n = in.width();
-        while (n--) {
-          *dstA++ = static_cast<float>(src[0]);
-          *dstR++ = static_cast<float>(src[1]);
-          *dstG++ = static_cast<float>(src[2]);
-          *dstB++ = static_cast<float>(src[3]);
-          src += 4;
+    const bool littleEndian = archIsLittleEndian();
+    GmicQt::parallelForRows(h, w, [&](int firstRow, int lastRow) {
+      for (int y = firstRow; y <= lastRow; ++y) {
+        const int offset = y * w;
+        if (littleEndian) {
+          k.interleaved4ToPlanar(bits + y * bytesPerLine, dstB + offset, dstG + offset, dstR + offset, dstA + offset, w);
+        } else {
+          k.interleaved4ToPlanar(bits + y * bytesPerLine, dstA + offset, dstR + offset, dstG + offset, dstB + offset, w);
         }
       }
-    }
+    });
     return;
   }
 
@@ -219,16 +509,17 @@ void ImageConverter::convert(const QImage & in, cimg_library::CImg<float> & out)
     float * dstR = out.data(0, 0, 0, 0);
     float * dstG = out.data(0, 0, 0, 1);
     float * dstB = out.data(0, 0, 0, 2);
-    for (int y = 0; y < h; ++y) {
-      const unsigned char * src = in.scanLine(y);
-      int n = in.width();
-      while (n--) {
-        *dstR++ = static_cast<float>(src[0]);
-        *dstG++ = static_cast<float>(src[1]);
-        *dstB++ = static_cast<float>(src[2]);
-        src += 3;
+    GmicQt::parallelForRows(h, w, [&](int firstRow, int lastRow) {
+      for (int y = firstRow; y <= lastRow; ++y) {
+        const int offset = y * w;
+        k.interleaved3ToPlanar(bits + y * bytesPerLine, dstR + offset, dstG + offset, dstB + offset, w);
       }
-    }
+    });
     return;
   }
 }
+
+const char * ImageConverter::kernelsName()
+{
+  return kernels().name;
+}
@@ -25,6 +25,8 @@
 #ifndef GMIC_QT_IMAGECONVERTER_H
 #define GMIC_QT_IMAGECONVERTER_H
 
+#include <vector>
+
 class QImage;
 namespace cimg_library
 {
@@ -33,9 +35,36 @@ template <typename T> struct CImg;
 
 class ImageConverter {
 public:
+  /**
+   * @brief Values are clamped to [0,255] and truncated, NaN gives 0
+   */
   static void convert(const cimg_library::CImg<float> & in, QImage & out);
   static void convert(const QImage & in, cimg_library::CImg<float> & out);
 
+  /**
+   * @brief Name of the row conversion kernels in use ("scalar", "sse2", "avx2" or "neon"),
+   *        selected at runtime from CPU features
+   */
+  static const char * kernelsName();
+
+  /**
+   * Row conversion kernels. Interleaved pixels are described by their byte order in memory,
+   * so that the same kernel handles ARGB32 on little and big endian architectures.
+   */
+  struct ConversionKernels {
+    const char * name;
+    void (*planarToInterleaved4)(const float * c0, const float * c1, const float * c2, const float * c3, unsigned char * dst, int n);
+    void (*planarToInterleaved3)(const float * c0, const float * c1, const float * c2, unsigned char * dst, int n);
+    void (*planarToGray)(const float * src, unsigned char * dst, int n);
+    void (*interleaved4ToPlanar)(const unsigned char * src, float * c0, float * c1, float * c2, float * c3, int n);
+    void (*interleaved3ToPlanar)(const unsigned char * src, float * c0, float * c1, float * c2, int n);
+  };
+
+  /**
+   * @brief Kernels supported by the running CPU, the last one being the fastest
+   */
+  static std::vector<ConversionKernels> availableKernels();
+
 private:
   ImageConverter() = delete;
 };
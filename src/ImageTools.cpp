@@ -26,8 +26,12 @@
 #include <QDebug>
 #include <QImage>
 #include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include "Globals.h"
 #include "GmicStdlib.h"
 #include "ImageConverter.h"
+#include "Utils.h"
 #include "gmic.h"
 
 /*
@@ -38,49 +42,92 @@
 namespace GmicQt
 {
 
-void buildPreviewImage(const cimg_library::CImgList<float> & images, cimg_library::CImg<float> & result, GmicQt::PreviewMode previewMode, int previewWidth, int previewHeight)
+namespace
 {
-  cimg_library::CImgList<gmic_pixel_type> preview_input_images;
+
+void selectPreviewOutputs(cimg_library::CImgList<float> & images, cimg_library::CImgList<float> & selection, GmicQt::PreviewMode previewMode)
+{
+  unsigned int first = 0;
+  unsigned int count = images.size();
   switch (previewMode) {
   case GmicQt::FirstOutput:
-    if (images && images.size() > 0) {
-      preview_input_images.push_back(images[0]);
-    }
-    break;
   case GmicQt::SecondOutput:
-    if (images && images.size() > 1) {
-      preview_input_images.push_back(images[1]);
-    }
-    break;
   case GmicQt::ThirdOutput:
-    if (images && images.size() > 2) {
-      preview_input_images.push_back(images[2]);
-    }
-    break;
   case GmicQt::FourthOutput:
-    if (images && images.size() > 3) {
-      preview_input_images.push_back(images[3]);
-    }
+    first = static_cast<unsigned int>(previewMode - GmicQt::FirstOutput);
+    count = 1;
+    break;
+  case GmicQt::First2SecondOutput:
+    count = 2;
+    break;
+  case GmicQt::First2ThirdOutput:
+    count = 3;
+    break;
+  case GmicQt::First2FourthOutput:
+    count = 4;
     break;
-  case GmicQt::First2SecondOutput: {
-    preview_input_images.push_back(images[0]);
-    preview_input_images.push_back(images[1]);
-  } break;
-  case GmicQt::First2ThirdOutput: {
-    for (int i = 0; i < 3; ++i) {
-      preview_input_images.push_back(images[i]);
-    }
-  } break;
-  case GmicQt::First2FourthOutput: {
-    for (int i = 0; i < 4; ++i) {
-      preview_input_images.push_back(images[i]);
-    }
-  } break;
   case GmicQt::AllOutputs:
   default:
-    preview_input_images = images;
+    images.move_to(selection);
+    return;
+  }
+  for (unsigned int i = first; (i < first + count) && (i < images.size()); ++i) {
+    images[i].move_to(selection);
+  }
+}
+
+// Layouts other than a grid of flat images are left to gui_preview
+bool previewGridIsSupported(const cimg_library::CImgList<float> & images)
+{
+  if ((images.size() < 2) || (images.size() > PREVIEW_GRID_MAX_OUTPUTS)) {
+    return false;
+  }
+  cimglist_for(images, l)
+  {
+    if (images[l].is_empty() || (images[l].depth() != 1)) {
+      return false;
+    }
   }
+  return true;
+}
 
+// Outputs are scaled down to the cells of a grid as square as possible, within the size of the largest one
+void buildPreviewGrid(cimg_library::CImgList<float> & images, cimg_library::CImg<float> & result)
+{
+  int width = 0;
+  int height = 0;
+  int spectrum = 0;
+  cimglist_for(images, l)
+  {
+    width = std::max(width, images[l].width());
+    height = std::max(height, images[l].height());
+    spectrum = std::max(spectrum, images[l].spectrum());
+  }
+  const int count = static_cast<int>(images.size());
+  int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+  if ((count == 2) && (width > height)) {
+    columns = 1; // Wide images are stacked
+  }
+  const int rows = (count + columns - 1) / columns;
+  const int cellWidth = std::max(1, (width - (columns - 1) * PREVIEW_GRID_SPACING) / columns);
+  const int cellHeight = std::max(1, (height - (rows - 1) * PREVIEW_GRID_SPACING) / rows);
+  result.assign(width, height, 1, spectrum, 0);
+  cimglist_for(images, l)
+  {
+    cimg_library::CImg<float> & image = images[l];
+    const double scale = std::min(cellWidth / static_cast<double>(image.width()), cellHeight / static_cast<double>(image.height()));
+    image.resize(std::max(1, static_cast<int>(std::round(image.width() * scale))), std::max(1, static_cast<int>(std::round(image.height() * scale))), 1, -100, 2);
+    const int x = (l % columns) * (cellWidth + PREVIEW_GRID_SPACING) + (cellWidth - image.width()) / 2;
+    const int y = (l / columns) * (cellHeight + PREVIEW_GRID_SPACING) + (cellHeight - image.height()) / 2;
+    result.draw_image(x, y, image);
+    image.assign();
+  }
+}
+
+} // namespace
+
+void composePreviewImage(cimg_library::CImgList<float> & preview_input_images, cimg_library::CImg<float> & result, int previewWidth, int previewHeight, bool nativeGrid)
+{
   int spectrum = 0;
   cimglist_for(preview_input_images, l) { spectrum = std::max(spectrum, preview_input_images[l].spectrum()); }
   spectrum += (spectrum == 1 || spectrum == 3);
@@ -89,6 +136,10 @@ void buildPreviewImage(const cimg_library::CImgList<float> & images, cimg_librar
     result.swap(preview_input_images.front());
     return;
   }
+  if (nativeGrid && previewGridIsSupported(preview_input_images)) {
+    buildPreviewGrid(preview_input_images, result);
+    return;
+  }
   if (preview_input_images.size() > 1) {
     try {
       cimg_library::CImgList<char> preview_images_names;
@@ -111,6 +162,14 @@ void buildPreviewImage(const cimg_library::CImgList<float> & images, cimg_librar
   result.assign();
 }
 
+void buildPreviewImage(cimg_library::CImgList<float> & images, cimg_library::CImg<float> & result, GmicQt::PreviewMode previewMode, int previewWidth, int previewHeight)
+{
+  static const bool nativeGrid = qgetenv("GMIC_QT_GMIC_PREVIEW_LAYOUT").isEmpty();
+  cimg_library::CImgList<float> preview_input_images;
+  selectPreviewOutputs(images, preview_input_images, previewMode);
+  composePreviewImage(preview_input_images, result, previewWidth, previewHeight, nativeGrid);
+}
+
 template <typename T> void image2uchar(cimg_library::CImg<T> & img)
 {
   unsigned int len = img.width() * img.height();
@@ -160,6 +219,26 @@ template <typename T> void image2uchar(cimg_library::CImg<T> & img)
   }
 }
 
+// Blend the first channels of an image over a checkerboard, according to its alpha channel.
+//-------------------------------------------------------------------------------------------
+template <typename T> void blendOverCheckerboard(cimg_library::CImg<T> & img, const int channels, const int alphaChannel)
+{
+  const int width = img.width();
+  parallelForRows(img.height(), width, [&](int firstRow, int lastRow) {
+    for (int y = firstRow; y <= lastRow; ++y) {
+      for (int c = 0; c < channels; ++c) {
+        T * ptr = img.data(0, y, 0, c);
+        const T * ptr_a = img.data(0, y, 0, alphaChannel);
+        for (int x = 0; x < width; ++x) {
+          const unsigned int a = (unsigned int)*(ptr_a++), i = 96 + (((x ^ y) & 8) << 3);
+          *ptr = (T)((a * (unsigned int)*ptr + (255 - a) * i) >> 8);
+          ++ptr;
+        }
+      }
+    }
+  });
+}
+
 // Calibrate any image to fit the required number of channels (GRAY,GRAYA, RGB or RGBA).
 //---------------------------------------------------------------------------------------
 template <typename T> void calibrate_image(cimg_library::CImg<T> & img, const int spectrum, const bool is_preview)
@@ -173,13 +252,7 @@ template <typename T> void calibrate_image(cimg_library::CImg<T> & img, const in
       break;
     case 2: // from GRAYA
       if (is_preview) {
-        T *ptr_r = img.data(0, 0, 0, 0), *ptr_a = img.data(0, 0, 0, 1);
-        cimg_forXY(img, x, y)
-        {
-          const unsigned int a = (unsigned int)*(ptr_a++), i = 96 + (((x ^ y) & 8) << 3);
-          *ptr_r = (T)((a * (unsigned int)*ptr_r + (255 - a) * i) >> 8);
-          ++ptr_r;
-        }
+        blendOverCheckerboard(img, 1, 1);
       }
       img.channel(0);
       break;
@@ -190,13 +263,7 @@ template <typename T> void calibrate_image(cimg_library::CImg<T> & img, const in
     case 4: // from RGBA
       (img.get_shared_channel(0) += img.get_shared_channel(1) += img.get_shared_channel(2)) /= 3;
       if (is_preview) {
-        T *ptr_r = img.data(0, 0, 0, 0), *ptr_a = img.data(0, 0, 0, 3);
-        cimg_forXY(img, x, y)
-        {
-          const unsigned int a = (unsigned int)*(ptr_a++), i = 96 + (((x ^ y) & 8) << 3);
-          *ptr_r = (T)((a * (unsigned int)*ptr_r + (255 - a) * i) >> 8);
-          ++ptr_r;
-        }
+        blendOverCheckerboard(img, 1, 3);
       }
       img.channel(0);
       break;
@@ -233,13 +300,7 @@ template <typename T> void calibrate_image(cimg_library::CImg<T> & img, const in
       break;
     case 2: // from GRAYA
       if (is_preview) {
-        T *ptr_r = img.data(0, 0, 0, 0), *ptr_a = img.data(0, 0, 0, 1);
-        cimg_forXY(img, x, y)
-        {
-          const unsigned int a = (unsigned int)*(ptr_a++), i = 96 + (((x ^ y) & 8) << 3);
-          *ptr_r = (T)((a * (unsigned int)*ptr_r + (255 - a) * i) >> 8);
-          ++ptr_r;
-        }
+        blendOverCheckerboard(img, 1, 1);
       }
       img.channel(0).resize(-100, -100, 1, 3);
       break;
@@ -247,17 +308,7 @@ template <typename T> void calibrate_image(cimg_library::CImg<T> & img, const in
       break;
     case 4: // from RGBA
       if (is_preview) {
-        T *ptr_r = img.data(0, 0, 0, 0), *ptr_g = img.data(0, 0, 0, 1), *ptr_b = img.data(0, 0, 0, 2), *ptr_a = img.data(0, 0, 0, 3);
-        cimg_forXY(img, x, y)
-        {
-          const unsigned int a = (unsigned int)*(ptr_a++), i = 96 + (((x ^ y) & 8) << 3);
-          *ptr_r = (T)((a * (unsigned int)*ptr_r + (255 - a) * i) >> 8);
-          *ptr_g = (T)((a * (unsigned int)*ptr_g + (255 - a) * i) >> 8);
-          *ptr_b = (T)((a * (unsigned int)*ptr_b + (255 - a) * i) >> 8);
-          ++ptr_r;
-          ++ptr_g;
-          ++ptr_b;
-        }
+        blendOverCheckerboard(img, 3, 3);
       }
       img.channels(0, 2);
       break;
@@ -39,7 +39,18 @@ namespace GmicQt
 template <typename T> void image2uchar(cimg_library::CImg<T> & img);
 template <typename T> void calibrate_image(cimg_library::CImg<T> & img, const int spectrum, const bool is_preview);
 
-void buildPreviewImage(const cimg_library::CImgList<float> & images, cimg_library::CImg<float> & result, GmicQt::PreviewMode previewMode, int previewWidth, int previewHeight);
+/**
+ * @brief Compose the outputs selected by the preview mode into a single image
+ *        (outputs are moved from the list, which is left unspecified)
+ */
+void buildPreviewImage(cimg_library::CImgList<float> & images, cimg_library::CImg<float> & result, GmicQt::PreviewMode previewMode, int previewWidth, int previewHeight);
+
+/**
+ * @brief Compose preview outputs into a single image (outputs are moved from the list)
+ *
+ * @param nativeGrid If false, several outputs are always laid out by the gui_preview command
+ */
+void composePreviewImage(cimg_library::CImgList<float> & images, cimg_library::CImg<float> & result, int previewWidth, int previewHeight, bool nativeGrid);
 } // namespace GmicQt
 
 template <typename T> bool hasAlphaChannel(const cimg_library::CImg<T> & image);
@@ -36,17 +36,22 @@
 #include <QShowEvent>
 #include <QStyleFactory>
 #include <cassert>
+#include <cmath>
 #include <iostream>
+#include <memory>
 #include <typeinfo>
 #include "Common.h"
 #include "CroppedActiveLayerProxy.h"
 #include "CroppedImageListProxy.h"
 #include "DialogSettings.h"
+#include "EventLoopMonitor.h"
 #include "FilterSelector/FavesModelReader.h"
 #include "FilterSelector/FiltersPresenter.h"
 #include "FilterSelector/FiltersVisibilityMap.h"
 #include "FilterTextTranslator.h"
+#include "FiltersUpdateThread.h"
 #include "Globals.h"
+#include "GmicInterpreterPool.h"
 #include "GmicStdlib.h"
 #include "IconLoader.h"
 #include "LayersExtentProxy.h"
@@ -74,6 +79,9 @@ MainWindow::MainWindow(QWidget * parent) : QWidget(parent), ui(new Ui::MainWindo
   _lastExecutionOK = true; // Overwritten by loadSettings()
   _expandCollapseIcon = nullptr;
   _newSession = true; // Overwritten by loadSettings()
+  if (!qgetenv("GMIC_QT_STALL_HISTOGRAM").isEmpty()) {
+    _eventLoopMonitor = new EventLoopMonitor(this);
+  }
 
   setWindowTitle(GmicQt::pluginFullName());
   QStringList tsp = QIcon::themeSearchPaths();
@@ -196,9 +204,13 @@ MainWindow::~MainWindow()
   //  FiltersTreeAbstractItem::buildHashesList(_filtersTreeModel.invisibleRootItem(),hashes);
   //  ParametersCache::cleanup(hashes);
 
+  discardFiltersUpdateThread();
   saveCurrentParameters();
   ParametersCache::save();
   saveSettings();
+  if (_eventLoopMonitor) {
+    Logger::note(_eventLoopMonitor->histogram());
+  }
   Logger::setMode(Logger::StandardOutput); // Close log file, if necessary
   delete ui;
 }
@@ -277,6 +289,8 @@ void MainWindow::setDarkTheme()
 
 void MainWindow::updateFiltersFromSources(int ageLimit, bool useNetwork)
 {
+  // A full update supersedes the background one of the startup
+  discardFiltersUpdateThread();
   if (useNetwork) {
     ui->progressInfoWidget->startFiltersUpdateAnimationAndShow();
   }
@@ -310,9 +324,19 @@ void MainWindow::onUpdateDownloadsFinished(int status)
 }
 
 void MainWindow::buildFiltersTree()
+{
+  QByteArray key;
+  const QByteArray stdlib = Updater::getInstance()->buildFullStdlib(&key);
+  buildFiltersTree(stdlib, key);
+}
+
+void MainWindow::buildFiltersTree(const QByteArray & stdlib, const QByteArray & stdlibKey)
 {
   saveCurrentParameters();
-  GmicStdLib::Array = Updater::getInstance()->buildFullStdlib();
+  GmicStdLib::Array = stdlib;
+  GmicStdLib::Key = stdlibKey;
+  GmicInterpreterPool::clear();
+  GmicInterpreterPool::prewarm();
   const bool withVisibility = filtersSelectionMode();
 
   // TODO : Is this the right place?
@@ -355,12 +379,24 @@ void MainWindow::onStartupFiltersUpdateFinished(int status)
   } else if (status == Updater::UpdateNotNecessary) {
   }
 
+  if (_filtersTreeFromLastCatalog) {
+    // Filters of the previous session are already shown
+    startFiltersUpdateThread();
+  } else {
+    QByteArray key;
+    const QByteArray stdlib = Updater::getInstance()->buildFullStdlib(&key);
+    setupFiltersTree(stdlib, key);
+  }
+}
+
+void MainWindow::setupFiltersTree(const QByteArray & stdlib, const QByteArray & stdlibKey)
+{
   if (QSettings().value(FAVES_IMPORT_KEY, false).toBool() || !FavesModelReader::gmicGTKFaveFileAvailable()) {
     _gtkFavesShouldBeImported = false;
   } else {
     _gtkFavesShouldBeImported = askUserForGTKFavesImport();
   }
-  buildFiltersTree();
+  buildFiltersTree(stdlib, stdlibKey);
   ui->searchField->setFocus();
 
   // Let the standalone version load an image, if necessary (not pretty)
@@ -391,6 +427,62 @@ void MainWindow::onStartupFiltersUpdateFinished(int status)
   // Preview update is triggered when PreviewWidget receives
   // the WindowActivate Event (while pendingResize is true
   // after the very first resize event).
+  if (logsStartupTimes()) {
+    Logger::note(QString("Filters tree ready after %1 ms").arg(_startupTimer.elapsed()));
+  }
+}
+
+void MainWindow::startFiltersUpdateThread()
+{
+  _filtersUpdateThread = new FiltersUpdateThread(this, GmicStdLib::Array);
+  connect(_filtersUpdateThread, &QThread::finished, this, &MainWindow::onFiltersUpdateThreadFinished);
+  _filtersUpdateThread->start(QThread::LowPriority);
+}
+
+void MainWindow::discardFiltersUpdateThread()
+{
+  if (!_filtersUpdateThread) {
+    return;
+  }
+  _filtersUpdateThread->disconnect(this);
+  _filtersUpdateThread->wait();
+  delete _filtersUpdateThread;
+  _filtersUpdateThread = nullptr;
+  _filtersTreeFromLastCatalog = false;
+}
+
+void MainWindow::onFiltersUpdateThreadFinished()
+{
+  if (!_filtersUpdateThread) {
+    return;
+  }
+  std::unique_ptr<FiltersUpdateThread> thread(_filtersUpdateThread);
+  thread->wait();
+  _filtersUpdateThread = nullptr;
+  _filtersTreeFromLastCatalog = false;
+  if (!thread->stdlibChanged()) {
+    return;
+  }
+  saveCurrentParameters();
+  GmicStdLib::Array = thread->stdlib();
+  GmicStdLib::Key = thread->stdlibKey();
+  GmicInterpreterPool::clear();
+  GmicInterpreterPool::prewarm();
+  const bool currentFilterChanged = _filtersPresenter->updateFilters(thread->filtersModel());
+  if (!currentFilterChanged) {
+    return;
+  }
+  if (_filtersPresenter->currentFilter().hash.isEmpty()) {
+    setNoFilter();
+    ui->previewWidget->sendUpdateRequest();
+  } else {
+    activateFilter(false);
+  }
+}
+
+bool MainWindow::logsStartupTimes() const
+{
+  return DialogSettings::outputMessageMode() >= GmicQt::VerboseConsole;
 }
 
 void MainWindow::showZoomWarningIfNeeded()
@@ -565,6 +657,16 @@ void MainWindow::onPreviewUpdateRequested(bool synchronous)
   context.filterCommand = currentFilter.previewCommand;
   context.filterArguments = ui->filterParams->valueString();
   context.filterHash = currentFilter.hash;
+  // Only filters declared as tile-safe are tiled. Keypoints are located relatively to the whole preview, hence not usable with tiles
+  context.tiledPreview = DialogSettings::tiledPreviewEnabled() && (currentFilter.tileHalo >= 0) && (context.inputOutputState.inputMode == GmicQt::Active) &&
+                         (ui->previewWidget->keypoints().size() == 0);
+  if (context.tiledPreview) {
+    context.previewTileHalo = static_cast<int>(std::ceil(currentFilter.tileHalo * std::min(1.0, context.zoomFactor)));
+  }
+  // A draft is a zoomed out preview, only faithful for filters that are accurate when zoomed
+  context.previewDraft = currentFilter.isAccurateIfZoomed;
+  context.previewIsFullImage = (currentFilter.previewFactor == GmicQt::PreviewFactorFullImage);
+  _processor.setPreviewTileCacheSize(DialogSettings::previewTileCacheSize());
   _processor.setContext(context);
   _processor.execute();
 
@@ -607,9 +709,19 @@ void MainWindow::onPreviewImageAvailable()
   if (ui->filterParams->hasKeypoints()) {
     ui->previewWidget->setKeypoints(ui->filterParams->keypoints());
   }
-  ui->previewWidget->setPreviewImage(_processor.previewImage());
+  ui->previewWidget->setPreviewFrame(_processor.previewFrame());
+  static const bool previewDebugOverlay = !qgetenv("GMIC_QT_PREVIEW_DEBUG").isEmpty();
+  if (previewDebugOverlay) {
+    ui->previewWidget->setDebugOverlay(_processor.previewResolutionSummary());
+  }
   ui->previewWidget->enableRightClick();
   ui->tbUpdateFilters->setEnabled(true);
+  if (!_firstPreviewReceived) {
+    _firstPreviewReceived = true;
+    if (logsStartupTimes()) {
+      Logger::note(QString("First preview after %1 ms").arg(_startupTimer.elapsed()));
+    }
+  }
   if (_pendingActionAfterCurrentProcessing == CloseAction) {
     close();
   }
@@ -664,6 +776,7 @@ void MainWindow::processImage()
   context.filterName = currentFilter.plainTextName;
   context.filterCommand = currentFilter.command;
   context.filterHash = currentFilter.hash;
+  context.tileHalo = currentFilter.tileHalo;
   ui->filterParams->updateValueString(false); // Required to get up-to-date values of text parameters
   context.filterArguments = ui->filterParams->valueString();
   _processor.setGmicStatusQuotedParameters(ui->filterParams->quotedParameters());
@@ -1096,6 +1209,7 @@ void MainWindow::showEvent(QShowEvent * event)
     return;
   }
   _showEventReceived = true;
+  _startupTimer.start();
   adjustVerticalSplitter();
   if (_newSession) {
     Logger::clear();
@@ -1109,7 +1223,18 @@ void MainWindow::showEvent(QShowEvent * event)
     ageLimit = settings.value(INTERNET_UPDATE_PERIODICITY_KEY, INTERNET_DEFAULT_PERIODICITY).toInt();
   }
   const bool useNetwork = (ageLimit != INTERNET_NEVER_UPDATE_PERIODICITY);
-  ui->progressInfoWidget->startFiltersUpdateAnimationAndShow();
+
+  // Show the filters of the previous session right away, sources are
+  // checked (and filters updated if needed) afterwards.
+  static const bool blockingStartup = !qgetenv("GMIC_QT_BLOCKING_STARTUP").isEmpty();
+  QByteArray lastStdlibKey;
+  const QByteArray lastStdlib = blockingStartup ? QByteArray() : Updater::lastKnownStdlib(&lastStdlibKey);
+  if (lastStdlib.isEmpty()) {
+    ui->progressInfoWidget->startFiltersUpdateAnimationAndShow();
+  } else {
+    _filtersTreeFromLastCatalog = true;
+    setupFiltersTree(lastStdlib, lastStdlibKey);
+  }
   Updater::getInstance()->startUpdate(ageLimit, 4, useNetwork);
 }
 
@@ -25,6 +25,7 @@
 #ifndef GMIC_QT_MAINWINDOW_H
 #define GMIC_QT_MAINWINDOW_H
 
+#include <QElapsedTimer>
 #include <QIcon>
 #include <QList>
 #include <QString>
@@ -34,6 +35,9 @@
 #include "GmicProcessor.h"
 #include "Updater.h"
 
+class EventLoopMonitor;
+class FiltersUpdateThread;
+
 namespace Ui
 {
 class MainWindow;
@@ -100,6 +104,7 @@ public slots:
   void onPreviewImageAvailable();
   void onPreviewError(const QString & message);
   void onParametersChanged();
+  void onFiltersUpdateThreadFinished();
   static bool isAccepted();
   void setFilterName(const QString & text);
 
@@ -138,6 +143,11 @@ private:
   };
   bool askUserForGTKFavesImport();
   void buildFiltersTree();
+  void buildFiltersTree(const QByteArray & stdlib, const QByteArray & stdlibKey);
+  void setupFiltersTree(const QByteArray & stdlib, const QByteArray & stdlibKey);
+  void startFiltersUpdateThread();
+  void discardFiltersUpdateThread();
+  bool logsStartupTimes() const;
 
   enum ProcessingAction
   {
@@ -163,6 +173,11 @@ private:
   FiltersPresenter * _filtersPresenter;
   GmicProcessor _processor;
   ulong _lastPreviewKeypointBurstUpdateTime;
+  FiltersUpdateThread * _filtersUpdateThread = nullptr;
+  bool _filtersTreeFromLastCatalog = false;
+  bool _firstPreviewReceived = false;
+  QElapsedTimer _startupTimer;
+  EventLoopMonitor * _eventLoopMonitor = nullptr; // Stalls of the GUI thread, if GMIC_QT_STALL_HISTOGRAM is set
   static bool _isAccepted;
 };
 
@@ -23,13 +23,19 @@
  *
  */
 #include "ParametersCache.h"
-#include <QBuffer>
-#include <QDataStream>
-#include <QDebug>
+#include <QCoreApplication>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include "Common.h"
 #include "Globals.h"
@@ -40,19 +46,514 @@
 QHash<QString, QList<QString>> ParametersCache::_parametersCache;
 QHash<QString, GmicQt::InputOutputState> ParametersCache::_inOutPanelStates;
 QHash<QString, QList<int>> ParametersCache::_visibilityStates;
+QByteArray ParametersCache::_journal;
+qint64 ParametersCache::_journalSize = 0;
+qint64 ParametersCache::_journalLiveBytes = 0;
+quint32 ParametersCache::_journalId = 0;
+QHash<QString, qint64> ParametersCache::_journalIndex;
+QSet<QString> ParametersCache::_modifiedHashes;
+bool ParametersCache::_loadFiltersParameters = true;
+bool ParametersCache::_rewriteJournal = false;
+QThread * ParametersCache::_compactionThread = nullptr;
+
+namespace
+{
+const char JournalMagic[8] = {'G', 'M', 'I', 'C', 'Q', 'T', 'P', 'J'};
+const quint32 JournalByteOrderMark = 0x01020304;
+const quint32 JournalVersion = 1;
+const int JournalHeaderSize = 8 + 4 + 4 + 4;
+
+enum RecordKind
+{
+  EntryRecord = 1,
+  RemovalRecord = 2
+};
+
+enum EntryFlags
+{
+  HasValuesFlag = 1,
+  HasVisibilityStatesFlag = 2,
+  HasInputOutputStateFlag = 4
+};
+
+class Cursor {
+public:
+  Cursor(const char * data, qint64 size) : _position(data), _end(data + size), _ok(true) {}
+  bool ok() const { return _ok; }
+
+  qint32 readInt()
+  {
+    qint32 value = 0;
+    if (_end - _position < 4) {
+      _ok = false;
+      return 0;
+    }
+    std::memcpy(&value, _position, 4);
+    _position += 4;
+    return value;
+  }
+
+  qint32 readCount()
+  {
+    const qint32 count = readInt();
+    if ((count < 0) || (count > (_end - _position) / 4)) {
+      _ok = false;
+      return 0;
+    }
+    return count;
+  }
+
+  QString readString()
+  {
+    const qint32 length = readInt();
+    const qint64 bytes = 2 * (qint64)length;
+    const qint64 paddedBytes = (bytes + 3) & ~qint64(3);
+    if (!_ok || (length < 0) || (_end - _position < paddedBytes)) {
+      _ok = false;
+      return QString();
+    }
+    QString result;
+    result.resize(length);
+    std::memcpy(result.data(), _position, bytes);
+    _position += paddedBytes;
+    return result;
+  }
+
+private:
+  const char * _position;
+  const char * _end;
+  bool _ok;
+};
+
+void appendInt(QByteArray & array, qint32 value)
+{
+  array.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void appendString(QByteArray & array, const QString & str)
+{
+  appendInt(array, str.size());
+  array.append(reinterpret_cast<const char *>(str.constData()), 2 * str.size());
+  if (str.size() & 1) {
+    array.append(2, '\0');
+  }
+}
+
+quint32 newJournalId()
+{
+  return (quint32)QDateTime::currentMSecsSinceEpoch() ^ ((quint32)QCoreApplication::applicationPid() << 16);
+}
+
+QByteArray journalHeader(quint32 journalId)
+{
+  QByteArray array;
+  array.append(JournalMagic, sizeof(JournalMagic));
+  appendInt(array, (qint32)JournalByteOrderMark);
+  appendInt(array, (qint32)JournalVersion);
+  appendInt(array, (qint32)journalId);
+  return array;
+}
+
+bool readJournalHeader(const char * data, qint64 size, quint32 & journalId)
+{
+  if ((size < JournalHeaderSize) || std::memcmp(data, JournalMagic, sizeof(JournalMagic))) {
+    return false;
+  }
+  Cursor cursor(data + sizeof(JournalMagic), size - sizeof(JournalMagic));
+  if (((quint32)cursor.readInt() != JournalByteOrderMark) || ((quint32)cursor.readInt() != JournalVersion)) {
+    return false;
+  }
+  journalId = (quint32)cursor.readInt();
+  return true;
+}
+
+qint32 recordSize(const char * data, qint64 offset)
+{
+  qint32 size;
+  std::memcpy(&size, data + offset, sizeof(size));
+  return size;
+}
+
+/*
+ * Returns the end of the last complete record found from offset. If index is
+ * not null, it is filled with the offsets of the latest entries.
+ */
+qint64 scanJournal(const char * data, qint64 size, qint64 offset, QHash<QString, qint64> * index, qint64 * liveBytes)
+{
+  while (size - offset >= 12) {
+    const qint32 bytes = recordSize(data, offset);
+    if ((bytes < 12) || (bytes & 3) || (bytes > size - offset)) {
+      break;
+    }
+    Cursor cursor(data + offset + 4, bytes - 4);
+    const qint32 kind = cursor.readInt();
+    const QString hash = cursor.readString();
+    if (!cursor.ok() || ((kind != EntryRecord) && (kind != RemovalRecord))) {
+      break;
+    }
+    if (index) {
+      QHash<QString, qint64>::iterator previous = index->find(hash);
+      if (previous != index->end()) {
+        *liveBytes -= recordSize(data, previous.value());
+        index->erase(previous);
+      }
+      if (kind == EntryRecord) {
+        index->insert(hash, offset);
+        *liveBytes += bytes;
+      }
+    }
+    offset += bytes;
+  }
+  return offset;
+}
+
+/*
+ * Valid records appended to a journal file after position, by another process.
+ */
+QByteArray readJournalTail(QFile & file, qint64 position)
+{
+  if (!file.seek(position)) {
+    return QByteArray();
+  }
+  QByteArray tail = file.readAll();
+  tail.truncate((int)scanJournal(tail.constData(), tail.size(), 0, nullptr, nullptr));
+  return tail;
+}
+
+class ParametersJournalCompactionThread : public QThread {
+public:
+  ParametersJournalCompactionThread(const QByteArray & journal, const QVector<qint64> & offsets, qint64 liveBytes) : _journal(journal), _offsets(offsets), _liveBytes(liveBytes) {}
+  const QByteArray & compactedJournal() const { return _compactedJournal; }
+
+protected:
+  void run() override
+  {
+    _compactedJournal = journalHeader(newJournalId());
+    _compactedJournal.reserve(JournalHeaderSize + (int)_liveBytes);
+    for (const qint64 offset : _offsets) {
+      _compactedJournal.append(_journal.constData() + offset, recordSize(_journal.constData(), offset));
+    }
+  }
+
+private:
+  QByteArray _journal;
+  QVector<qint64> _offsets;
+  qint64 _liveBytes;
+  QByteArray _compactedJournal;
+};
+
+} // namespace
 
 void ParametersCache::load(bool loadFiltersParameters)
 {
-  // Load JSON file
+  discardCompaction();
   _parametersCache.clear();
   _inOutPanelStates.clear();
   _visibilityStates.clear();
+  _journal.clear();
+  _journalSize = 0;
+  _journalLiveBytes = 0;
+  _journalIndex.clear();
+  _modifiedHashes.clear();
+  _loadFiltersParameters = loadFiltersParameters;
+  // A new session drops the stored parameters, the journal is rewritten with
+  // the in/out states only.
+  _rewriteJournal = !loadFiltersParameters;
 
-  QString jsonFilename = QString("%1%2").arg(GmicQt::path_rc(true), PARAMETERS_CACHE_FILENAME);
-  QFile jsonFile(jsonFilename);
-  if (!jsonFile.exists()) {
+  const QString filename = journalFilename();
+  QLockFile lock(filename + ".lock");
+  if (!lock.tryLock(PARAMETERS_JOURNAL_LOCK_TIMEOUT)) {
+    // Reading is still safe, a record being appended is ignored
+    Logger::warning("Cannot lock " + filename);
+  }
+  if (readJournal(filename)) {
+    const qint64 deadBytes = _journalSize - JournalHeaderSize - _journalLiveBytes;
+    if (!_rewriteJournal && (deadBytes > PARAMETERS_JOURNAL_COMPACTION_SIZE) && (deadBytes > _journalLiveBytes)) {
+      startCompaction();
+    }
+    return;
+  }
+  _journal.clear();
+  _journalIndex.clear();
+  _rewriteJournal = true;
+  if (QFile::exists(filename)) {
+    Logger::warning(QString("Cannot read ") + filename);
+    Logger::warning("Last filters parameters are lost!");
+    return;
+  }
+  // Import the JSON file of previous versions
+  const QString jsonFilename = QString("%1%2").arg(GmicQt::path_rc(true), PARAMETERS_CACHE_FILENAME);
+  if (QFile::exists(jsonFilename)) {
+    readLegacyFile(jsonFilename, loadFiltersParameters);
+  }
+}
+
+void ParametersCache::save()
+{
+  const QString filename = journalFilename();
+  QLockFile lock(filename + ".lock");
+  if (!lock.tryLock(PARAMETERS_JOURNAL_LOCK_TIMEOUT)) {
+    Logger::error("Cannot lock " + filename);
+    Logger::error("Parameters cannot be saved");
+    return;
+  }
+  if (_rewriteJournal) {
+    if (writeJournal(filename)) {
+      // Remove files of previous versions
+      const QString & path = GmicQt::path_rc(true);
+      QFile::remove(path + PARAMETERS_CACHE_FILENAME);
+      QFile::remove(path + PARAMETERS_CACHE_FILENAME ".bak");
+      QFile::remove(path + "gmic_qt_parameters.dat");
+      QFile::remove(path + "gmic_qt_parameters.json");
+      QFile::remove(path + "gmic_qt_parameters.json.bak");
+      QFile::remove(path + "gmic_qt_parameters_json.dat");
+    } else {
+      Logger::error("Cannot write " + filename);
+      Logger::error("Parameters cannot be saved");
+    }
+    return;
+  }
+  QByteArray records;
+  for (const QString & hash : _modifiedHashes) {
+    records.append(encode(hash));
+  }
+  if (finishCompaction(filename, records) || records.isEmpty()) {
+    _modifiedHashes.clear();
     return;
   }
+  if (appendToJournal(filename, records)) {
+    _modifiedHashes.clear();
+  } else {
+    Logger::error("Cannot write " + filename);
+    Logger::error("Parameters cannot be saved");
+  }
+}
+
+QString ParametersCache::journalFilename()
+{
+  return QString("%1%2").arg(GmicQt::path_rc(true), PARAMETERS_JOURNAL_FILENAME);
+}
+
+bool ParametersCache::readJournal(const QString & filename)
+{
+  QFile file(filename);
+  if (!file.open(QFile::ReadOnly)) {
+    return false;
+  }
+  _journal = file.readAll();
+  if (!readJournalHeader(_journal.constData(), _journal.size(), _journalId)) {
+    return false;
+  }
+  _journalSize = scanJournal(_journal.constData(), _journal.size(), JournalHeaderSize, &_journalIndex, &_journalLiveBytes);
+  if (_journalSize != _journal.size()) {
+    Logger::warning(QString("Ignoring incomplete records at the end of ") + filename);
+  }
+  return true;
+}
+
+void ParametersCache::decode(const QString & hash)
+{
+  QHash<QString, qint64>::iterator it = _journalIndex.find(hash);
+  if (it == _journalIndex.end()) {
+    return;
+  }
+  const qint64 offset = it.value();
+  _journalIndex.erase(it);
+  Cursor cursor(_journal.constData() + offset, recordSize(_journal.constData(), offset));
+  cursor.readInt();    // Record size
+  cursor.readInt();    // Kind, always EntryRecord in the index
+  cursor.readString(); // Hash
+  const qint32 flags = cursor.readInt();
+  QList<QString> values;
+  QList<int> visibilityStates;
+  if (flags & HasValuesFlag) {
+    const qint32 count = cursor.readCount();
+    values.reserve(count);
+    for (qint32 i = 0; i < count; ++i) {
+      values.push_back(cursor.readString());
+    }
+  }
+  if (flags & HasVisibilityStatesFlag) {
+    const qint32 count = cursor.readCount();
+    visibilityStates.reserve(count);
+    for (qint32 i = 0; i < count; ++i) {
+      visibilityStates.push_back(cursor.readInt());
+    }
+  }
+  GmicQt::InputOutputState state;
+  if (flags & HasInputOutputStateFlag) {
+    state.inputMode = (GmicQt::InputMode)cursor.readInt();
+    state.outputMode = (GmicQt::OutputMode)cursor.readInt();
+    state.previewMode = (GmicQt::PreviewMode)cursor.readInt();
+  }
+  if (!cursor.ok()) {
+    Logger::warning(QString("Cannot decode cached parameters of filter %1").arg(hash));
+    return;
+  }
+  if (_loadFiltersParameters) {
+    if (flags & HasValuesFlag) {
+      _parametersCache[hash] = values;
+    }
+    if (flags & HasVisibilityStatesFlag) {
+      _visibilityStates[hash] = visibilityStates;
+    }
+  }
+  if (flags & HasInputOutputStateFlag) {
+    _inOutPanelStates[hash] = state;
+  }
+}
+
+void ParametersCache::decodeAll()
+{
+  const QList<QString> hashes = _journalIndex.keys();
+  for (const QString & hash : hashes) {
+    decode(hash);
+  }
+}
+
+QByteArray ParametersCache::encode(const QString & hash)
+{
+  decode(hash);
+  QHash<QString, QList<QString>>::const_iterator itValues = _parametersCache.constFind(hash);
+  QHash<QString, QList<int>>::const_iterator itVisibilityStates = _visibilityStates.constFind(hash);
+  QHash<QString, GmicQt::InputOutputState>::const_iterator itState = _inOutPanelStates.constFind(hash);
+  const qint32 flags = ((itValues != _parametersCache.constEnd()) ? HasValuesFlag : 0)                     //
+                       | ((itVisibilityStates != _visibilityStates.constEnd()) ? HasVisibilityStatesFlag : 0) //
+                       | ((itState != _inOutPanelStates.constEnd()) ? HasInputOutputStateFlag : 0);
+  QByteArray record;
+  appendInt(record, 0); // Record size, set below
+  appendInt(record, flags ? EntryRecord : RemovalRecord);
+  appendString(record, hash);
+  if (flags) {
+    appendInt(record, flags);
+  }
+  if (flags & HasValuesFlag) {
+    appendInt(record, itValues.value().size());
+    for (const QString & value : itValues.value()) {
+      appendString(record, value);
+    }
+  }
+  if (flags & HasVisibilityStatesFlag) {
+    appendInt(record, itVisibilityStates.value().size());
+    for (const int state : itVisibilityStates.value()) {
+      appendInt(record, state);
+    }
+  }
+  if (flags & HasInputOutputStateFlag) {
+    appendInt(record, (qint32)itState.value().inputMode);
+    appendInt(record, (qint32)itState.value().outputMode);
+    appendInt(record, (qint32)itState.value().previewMode);
+  }
+  const qint32 size = record.size();
+  std::memcpy(record.data(), &size, sizeof(size));
+  return record;
+}
+
+bool ParametersCache::writeJournal(const QString & filename)
+{
+  discardCompaction();
+  decodeAll();
+  QSet<QString> hashes;
+  for (const QString & hash : _parametersCache.keys()) {
+    hashes.insert(hash);
+  }
+  for (const QString & hash : _visibilityStates.keys()) {
+    hashes.insert(hash);
+  }
+  for (const QString & hash : _inOutPanelStates.keys()) {
+    hashes.insert(hash);
+  }
+  const quint32 journalId = newJournalId();
+  QByteArray journal = journalHeader(journalId);
+  for (const QString & hash : hashes) {
+    journal.append(encode(hash));
+  }
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly) || (file.write(journal) != journal.size()) || !file.commit()) {
+    return false;
+  }
+  _journal = journal;
+  _journalSize = journal.size();
+  _journalLiveBytes = journal.size() - JournalHeaderSize;
+  _journalId = journalId;
+  _modifiedHashes.clear();
+  _rewriteJournal = false;
+  return true;
+}
+
+bool ParametersCache::appendToJournal(const QString & filename, const QByteArray & records)
+{
+  QFile file(filename);
+  if (!file.open(QFile::ReadWrite)) {
+    return false;
+  }
+  const QByteArray header = file.read(JournalHeaderSize);
+  quint32 journalId;
+  if (!readJournalHeader(header.constData(), header.size(), journalId)) {
+    // The journal has been removed or damaged since it was loaded
+    file.close();
+    return writeJournal(filename);
+  }
+  // Another process may have appended records, or rewritten the journal
+  const qint64 position = ((journalId == _journalId) && (file.size() >= _journalSize)) ? _journalSize : JournalHeaderSize;
+  const qint64 end = position + readJournalTail(file, position).size();
+  if ((end != file.size()) && !file.resize(end)) {
+    return false;
+  }
+  return file.seek(end) && (file.write(records) == records.size()) && file.flush();
+}
+
+void ParametersCache::startCompaction()
+{
+  QVector<qint64> offsets;
+  offsets.reserve(_journalIndex.size());
+  for (const qint64 offset : _journalIndex) {
+    offsets.push_back(offset);
+  }
+  std::sort(offsets.begin(), offsets.end());
+  _compactionThread = new ParametersJournalCompactionThread(_journal, offsets, _journalLiveBytes);
+  _compactionThread->start(QThread::LowPriority);
+}
+
+bool ParametersCache::finishCompaction(const QString & filename, const QByteArray & records)
+{
+  if (!_compactionThread) {
+    return false;
+  }
+  _compactionThread->wait();
+  QByteArray journal = static_cast<ParametersJournalCompactionThread *>(_compactionThread)->compactedJournal();
+  delete _compactionThread;
+  _compactionThread = nullptr;
+  QFile file(filename);
+  QByteArray header;
+  if (file.open(QFile::ReadOnly)) {
+    header = file.read(JournalHeaderSize);
+  }
+  quint32 journalId = 0;
+  if (!readJournalHeader(header.constData(), header.size(), journalId) || (journalId != _journalId) || (file.size() < _journalSize)) {
+    // Rewritten by another process meanwhile
+    return false;
+  }
+  journal.append(readJournalTail(file, _journalSize));
+  file.close();
+  journal.append(records);
+  // The temporary file of QSaveFile is unique to this process, and atomically replaces the journal
+  QSaveFile compacted(filename);
+  return compacted.open(QIODevice::WriteOnly) && (compacted.write(journal) == journal.size()) && compacted.commit();
+}
+
+void ParametersCache::discardCompaction()
+{
+  if (_compactionThread) {
+    _compactionThread->wait();
+    delete _compactionThread;
+    _compactionThread = nullptr;
+  }
+}
+
+void ParametersCache::readLegacyFile(const QString & jsonFilename, bool loadFiltersParameters)
+{
+  QFile jsonFile(jsonFilename);
   if (jsonFile.open(QFile::ReadOnly)) {
 #ifdef _GMIC_QT_DEBUG_
     QJsonDocument jsonDoc;
@@ -87,6 +588,7 @@ void ParametersCache::load(bool loadFiltersParameters)
                 values.push_back(v.toString());
               }
               _parametersCache[hash] = values;
+              _modifiedHashes.insert(hash);
             }
             QJsonValue visibilityStates = filterObject.value("visibility_states");
             if (!visibilityStates.isUndefined()) {
@@ -96,6 +598,7 @@ void ParametersCache::load(bool loadFiltersParameters)
                 values.push_back(v.toInt());
               }
               _visibilityStates[hash] = values;
+              _modifiedHashes.insert(hash);
             }
           }
           QJsonValue state = filterObject.value("in_out_state");
@@ -103,6 +606,7 @@ void ParametersCache::load(bool loadFiltersParameters)
           if (!state.isUndefined()) {
             QJsonObject stateObject = state.toObject();
             _inOutPanelStates[hash] = GmicQt::InputOutputState::fromJSONObject(stateObject);
+            _modifiedHashes.insert(hash);
           }
           ++itFilter;
         }
@@ -114,125 +618,17 @@ void ParametersCache::load(bool loadFiltersParameters)
   }
 }
 
-void ParametersCache::save()
-{
-  // JSON Document format
-  //
-  // {
-  //  "51d288e6f1c6e531cc61289f17e34d8a": {
-  //      "parameters": [
-  //          "6",
-  //          "21.06",
-  //          "1.36",
-  //          "5",
-  //          "0"
-  //      ],
-  //      "in_out_state": {
-  //          "InputLayers": 1,
-  //          "OutputMessages": 5,
-  //          "OutputMode": 100,
-  //          "PreviewMode": 100
-  //      }
-  //      "visibility_states": [
-  //             0,
-  //             1,
-  //             2,
-  //             0
-  //      ]
-  //  }
-  // }
-
-  QJsonObject documentObject;
-
-  // Add Input/Output states
-  QHash<QString, GmicQt::InputOutputState>::iterator itState = _inOutPanelStates.begin();
-  while (itState != _inOutPanelStates.end()) {
-    QJsonObject filterObject;
-    QJsonObject jsonState;
-    itState.value().toJSONObject(jsonState);
-    filterObject.insert("in_out_state", jsonState);
-    documentObject.insert(itState.key(), filterObject);
-    ++itState;
-  }
-
-  // Add filters parameters
-
-  QHash<QString, QList<QString>>::iterator itParams = _parametersCache.begin();
-  while (itParams != _parametersCache.end()) {
-    QJsonObject filterObject;
-    QJsonObject::iterator entry = documentObject.find(itParams.key());
-    if (entry != documentObject.end()) {
-      filterObject = entry.value().toObject();
-    }
-    // Add the parameters list
-    QJsonArray array;
-    QStringList list = itParams.value();
-    for (const QString & str : list) {
-      array.push_back(str);
-    }
-    filterObject.insert("parameters", array);
-    documentObject.insert(itParams.key(), filterObject);
-    ++itParams;
-  }
-
-  // Add visibility states
-
-  QHash<QString, QList<int>>::iterator itVisibilities = _visibilityStates.begin();
-  while (itVisibilities != _visibilityStates.end()) {
-    QJsonObject filterObject;
-    QJsonObject::iterator entry = documentObject.find(itVisibilities.key());
-    if (entry != documentObject.end()) {
-      filterObject = entry.value().toObject();
-    }
-    // Add the parameters list
-    QJsonArray array;
-    QList<int> states = itVisibilities.value();
-    for (const int & state : states) {
-      array.push_back(state);
-    }
-    filterObject.insert("visibility_states", array);
-    documentObject.insert(itVisibilities.key(), filterObject);
-    ++itVisibilities;
-  }
-
-  QJsonDocument jsonDoc(documentObject);
-  QString jsonFilename = QString("%1%2").arg(GmicQt::path_rc(true), PARAMETERS_CACHE_FILENAME);
-  QFile jsonFile(jsonFilename);
-  if (QFile::exists(jsonFilename)) {
-    QString bakFilename = QString("%1%2").arg(GmicQt::path_rc(false), PARAMETERS_CACHE_FILENAME ".bak");
-    QFile::remove(bakFilename);
-    QFile::copy(jsonFilename, bakFilename);
-  }
-  if (jsonFile.open(QFile::WriteOnly | QFile::Truncate)) {
-#ifdef _GMIC_QT_DEBUG_
-    qint64 count = jsonFile.write(jsonDoc.toJson());
-#else
-    qint64 count = jsonFile.write(qCompress(jsonDoc.toJson(QJsonDocument::Compact)));
-#endif
-    // jsonFile.write(jsonDoc.toJson());
-    // jsonFile.write(qCompress(jsonDoc.toBinaryData()));
-    jsonFile.close();
-    if (count != -1) {
-      // Remove obsolete 2.0.0 pre-release files
-      const QString & path = GmicQt::path_rc(true);
-      QFile::remove(path + "gmic_qt_parameters.dat");
-      QFile::remove(path + "gmic_qt_parameters.json");
-      QFile::remove(path + "gmic_qt_parameters.json.bak");
-      QFile::remove(path + "gmic_qt_parameters_json.dat");
-    }
-  } else {
-    Logger::error("Cannot write " + jsonFilename);
-    Logger::error("Parameters cannot be saved");
-  }
-}
 
 void ParametersCache::setValues(const QString & hash, const QList<QString> & values)
 {
+  decode(hash);
+  _modifiedHashes.insert(hash);
   _parametersCache[hash] = values;
 }
 
 QList<QString> ParametersCache::getValues(const QString & hash)
 {
+  decode(hash);
   if (_parametersCache.contains(hash)) {
     return _parametersCache[hash];
   }
@@ -241,11 +637,14 @@ QList<QString> ParametersCache::getValues(const QString & hash)
 
 void ParametersCache::setVisibilityStates(const QString & hash, const QList<int> & states)
 {
+  decode(hash);
+  _modifiedHashes.insert(hash);
   _visibilityStates[hash] = states;
 }
 
 QList<int> ParametersCache::getVisibilityStates(const QString & hash)
 {
+  decode(hash);
   if (_visibilityStates.contains(hash)) {
     return _visibilityStates[hash];
   }
@@ -254,12 +653,15 @@ QList<int> ParametersCache::getVisibilityStates(const QString & hash)
 
 void ParametersCache::remove(const QString & hash)
 {
+  decode(hash);
+  _modifiedHashes.insert(hash);
   _parametersCache.remove(hash);
   _inOutPanelStates.remove(hash);
 }
 
 GmicQt::InputOutputState ParametersCache::getInputOutputState(const QString & hash)
 {
+  decode(hash);
   if (_inOutPanelStates.contains(hash)) {
     return _inOutPanelStates[hash];
   }
@@ -268,6 +670,8 @@ GmicQt::InputOutputState ParametersCache::getInputOutputState(const QString & ha
 
 void ParametersCache::setInputOutputState(const QString & hash, const GmicQt::InputOutputState & state, const GmicQt::InputMode defaultInputMode)
 {
+  decode(hash);
+  _modifiedHashes.insert(hash);
   if ((state == GmicQt::InputOutputState(defaultInputMode, GmicQt::DefaultOutputMode, GmicQt::DefaultPreviewMode)) //
       || (state == GmicQt::InputOutputState(GmicQt::UnspecifiedInputMode, GmicQt::DefaultOutputMode, GmicQt::DefaultPreviewMode))) {
     _inOutPanelStates.remove(hash);
@@ -278,6 +682,7 @@ void ParametersCache::setInputOutputState(const QString & hash, const GmicQt::In
 
 void ParametersCache::cleanup(const QSet<QString> & hashesToKeep)
 {
+  decodeAll();
   QSet<QString> obsoleteHashes;
 
   // Build set of no longer used parameters
@@ -290,6 +695,7 @@ void ParametersCache::cleanup(const QSet<QString> & hashesToKeep)
   }
   for (const QString & h : obsoleteHashes) {
     _parametersCache.remove(h);
+    _modifiedHashes.insert(h);
   }
   obsoleteHashes.clear();
 
@@ -303,6 +709,7 @@ void ParametersCache::cleanup(const QSet<QString> & hashesToKeep)
   }
   for (const QString & h : obsoleteHashes) {
     _inOutPanelStates.remove(h);
+    _modifiedHashes.insert(h);
   }
   obsoleteHashes.clear();
 }
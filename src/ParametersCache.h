@@ -25,11 +25,29 @@
 #ifndef GMIC_QT_PARAMETERSCACHE_H
 #define GMIC_QT_PARAMETERSCACHE_H
 
+#include <QByteArray>
 #include <QHash>
 #include <QList>
+#include <QSet>
 #include <QString>
 #include "InputOutputState.h"
 
+class QThread;
+
+/*
+ * Filters parameters, visibility states and in/out states are stored in an
+ * append-only journal in the rc directory. All integers are 32 bits, in native
+ * byte order, strings are stored as in FiltersModelBinaryReader.
+ *
+ * Header : magic[8], byteOrderMark, version, journalId
+ * Record : recordSize, kind, hash, [flags, [count, value*], [count, state*], [inputMode, outputMode, previewMode]]
+ *
+ * The last record of a hash wins. Loading only indexes the records, which are
+ * decoded on first access to their hash. Saving appends a record for each
+ * modified hash, and the journal is compacted in a background thread when it
+ * contains too many superseded records. Processes sharing the rc directory
+ * load and save the journal while holding a lock file.
+ */
 class ParametersCache {
 public:
   static void load(bool loadFiltersParameters);
@@ -46,9 +64,30 @@ public:
   static void cleanup(const QSet<QString> & hashesToKeep);
 
 private:
+  friend class ParametersCacheBenchmark;
+  static QString journalFilename();
+  static bool readJournal(const QString & filename);
+  static void readLegacyFile(const QString & filename, bool loadFiltersParameters);
+  static void decode(const QString & hash);
+  static void decodeAll();
+  static QByteArray encode(const QString & hash);
+  static bool writeJournal(const QString & filename);
+  static bool appendToJournal(const QString & filename, const QByteArray & records);
+  static void startCompaction();
+  static bool finishCompaction(const QString & filename, const QByteArray & records);
+  static void discardCompaction();
   static QHash<QString, QList<QString>> _parametersCache;
   static QHash<QString, GmicQt::InputOutputState> _inOutPanelStates;
   static QHash<QString, QList<int>> _visibilityStates;
+  static QByteArray _journal;
+  static qint64 _journalSize;                  // Size of the valid records in _journal
+  static qint64 _journalLiveBytes;             // Size of the records not superseded when loaded
+  static quint32 _journalId;                   // Changes each time the journal is rewritten
+  static QHash<QString, qint64> _journalIndex; // Offsets in _journal of the records not decoded yet
+  static QSet<QString> _modifiedHashes;
+  static bool _loadFiltersParameters;
+  static bool _rewriteJournal;
+  static QThread * _compactionThread;
 };
 
 #endif // GMIC_QT_PARAMETERSCACHE_H
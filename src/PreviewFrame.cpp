@@ -0,0 +1,81 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file PreviewFrame.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "PreviewFrame.h"
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include "Host/host.h"
+#include "ImageConverter.h"
+#include "ImageTools.h"
+#include "gmic.h"
+
+PreviewFrame::Settings::Settings() : enabled(false), previewMode(GmicQt::FirstOutput), previewWidth(0), previewHeight(0), xScale(1.0), yScale(1.0) {}
+
+PreviewFrame::PreviewFrame() : _buildDuration(0) {}
+
+std::shared_ptr<const PreviewFrame> PreviewFrame::build(cimg_library::CImgList<float> & outputs, const Settings & settings)
+{
+  QElapsedTimer timer;
+  timer.start();
+  std::shared_ptr<PreviewFrame> frame(new PreviewFrame);
+  for (unsigned int i = 0; i < outputs.size(); ++i) {
+    cimg_library::CImg<float> & image = outputs[i];
+    if (image.is_empty()) {
+      continue;
+    }
+    if ((settings.xScale != 1.0) || (settings.yScale != 1.0)) {
+      image.resize(std::max(1, static_cast<int>(std::round(image.width() * settings.xScale))), std::max(1, static_cast<int>(std::round(image.height() * settings.yScale))), -100, -100, 3);
+    }
+    gmic_qt_apply_color_profile(image);
+  }
+  cimg_library::CImg<float> composed;
+  GmicQt::buildPreviewImage(outputs, composed, settings.previewMode, settings.previewWidth, settings.previewHeight);
+  outputs.assign();
+  if (!composed.is_empty()) {
+    ImageConverter::convert(composed, frame->_image);
+  }
+  frame->_buildDuration = static_cast<int>(timer.elapsed());
+  return frame;
+}
+
+const QImage & PreviewFrame::image() const
+{
+  return _image;
+}
+
+QSize PreviewFrame::size() const
+{
+  return _image.size();
+}
+
+bool PreviewFrame::isNull() const
+{
+  return _image.isNull();
+}
+
+int PreviewFrame::buildDuration() const
+{
+  return _buildDuration;
+}
@@ -0,0 +1,73 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file PreviewFrame.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_PREVIEWFRAME_H
+#define GMIC_QT_PREVIEWFRAME_H
+
+#include <QImage>
+#include <QSize>
+#include <memory>
+#include "gmic_qt.h"
+
+namespace cimg_library
+{
+template <typename T> struct CImgList;
+} // namespace cimg_library
+
+/**
+ * @brief Preview result ready for display: the outputs selected by the preview
+ *        mode, with the color profile of the host applied, composed and converted.
+ *
+ * A frame is never modified once built, so that it may be built by a preview
+ * worker and then shared as is by the processor and the preview widget.
+ */
+class PreviewFrame {
+public:
+  struct Settings {
+    Settings();
+    bool enabled;
+    GmicQt::PreviewMode previewMode;
+    int previewWidth;
+    int previewHeight;
+    double xScale; // Outputs of a draft are scaled by the ratio between the preview and draft inputs
+    double yScale;
+  };
+
+  /**
+   * @brief Build a frame from filter outputs, which are consumed
+   */
+  static std::shared_ptr<const PreviewFrame> build(cimg_library::CImgList<float> & outputs, const Settings & settings);
+
+  const QImage & image() const;
+  QSize size() const;
+  bool isNull() const;
+  int buildDuration() const; // Time (ms) it took to compose and convert the outputs
+
+private:
+  PreviewFrame();
+  QImage _image;
+  int _buildDuration;
+};
+
+#endif // GMIC_QT_PREVIEWFRAME_H
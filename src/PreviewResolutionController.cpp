@@ -0,0 +1,78 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file PreviewResolutionController.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "PreviewResolutionController.h"
+#include <algorithm>
+#include <cmath>
+#include "Globals.h"
+
+PreviewResolutionController::PreviewResolutionController() : _targetFrameTime(PREVIEW_TARGET_FRAME_TIME_MS) {}
+
+void PreviewResolutionController::setTargetFrameTime(int ms)
+{
+  _targetFrameTime = std::max(1, ms);
+}
+
+int PreviewResolutionController::targetFrameTime() const
+{
+  return _targetFrameTime;
+}
+
+void PreviewResolutionController::recordDuration(const QString & filterHash, double pixels, int ms)
+{
+  if (pixels <= 0.0) {
+    return;
+  }
+  const double cost = ms / (pixels / 1e6);
+  QHash<QString, double>::iterator it = _msPerMegapixel.find(filterHash);
+  if (it == _msPerMegapixel.end()) {
+    _msPerMegapixel.insert(filterHash, cost);
+  } else {
+    // Smooth out the noise of timings, still following parameter changes quickly
+    *it = 0.5 * (*it + cost);
+  }
+}
+
+double PreviewResolutionController::downscaleFactor(const QString & filterHash, double pixels) const
+{
+  const int duration = estimatedDuration(filterHash, pixels);
+  if (duration <= _targetFrameTime) {
+    return 1.0;
+  }
+  // Durations are assumed proportional to the pixel count
+  const double factor = std::sqrt(duration / static_cast<double>(_targetFrameTime));
+  if (factor < PREVIEW_MIN_DOWNSCALE_FACTOR) {
+    return 1.0;
+  }
+  return std::ceil(4.0 * std::min(factor, PREVIEW_MAX_DOWNSCALE_FACTOR)) / 4.0;
+}
+
+int PreviewResolutionController::estimatedDuration(const QString & filterHash, double pixels) const
+{
+  QHash<QString, double>::const_iterator it = _msPerMegapixel.find(filterHash);
+  if (it == _msPerMegapixel.end()) {
+    return -1;
+  }
+  return static_cast<int>(std::round(*it * pixels / 1e6));
+}
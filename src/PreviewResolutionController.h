@@ -0,0 +1,64 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file PreviewResolutionController.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_PREVIEWRESOLUTIONCONTROLLER_H
+#define GMIC_QT_PREVIEWRESOLUTIONCONTROLLER_H
+
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief Picks, for each filter, how much preview inputs should be downscaled
+ *        so that a preview is rendered within a target frame time.
+ *
+ * Each filter's cost per pixel is estimated from the measured durations of its
+ * previews, whatever their resolution.
+ */
+class PreviewResolutionController {
+public:
+  PreviewResolutionController();
+  void setTargetFrameTime(int ms);
+  int targetFrameTime() const;
+
+  void recordDuration(const QString & filterHash, double pixels, int ms);
+
+  /**
+   * @return A factor (>= 1) by which both dimensions of an input of the given
+   *         pixel count should be divided. 1 if the filter is fast enough, or
+   *         if nothing is known about it yet.
+   */
+  double downscaleFactor(const QString & filterHash, double pixels) const;
+
+  /**
+   * @return The estimated duration (in ms) of a preview with inputs of the given
+   *         pixel count, -1 if unknown.
+   */
+  int estimatedDuration(const QString & filterHash, double pixels) const;
+
+private:
+  QHash<QString, double> _msPerMegapixel;
+  int _targetFrameTime;
+};
+
+#endif // GMIC_QT_PREVIEWRESOLUTIONCONTROLLER_H
@@ -0,0 +1,257 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file PreviewScheduler.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "PreviewScheduler.h"
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include "Common.h"
+#include "FilterSyncRunner.h"
+#include "gmic.h"
+
+struct PreviewScheduler::Job {
+  Job(PreviewScheduler * scheduler) : scheduler(scheduler), bytes(0), aborted(false) {}
+  ~Job() { scheduler->_heldBytes -= bytes; }
+  PreviewScheduler * scheduler;
+  std::unique_ptr<FilterSyncRunner> runner;
+  std::size_t bytes;
+  bool aborted;
+};
+
+class PreviewScheduler::Worker : public QThread {
+public:
+  Worker(PreviewScheduler * scheduler) : _scheduler(scheduler)
+  {
+#ifdef _IS_MACOS_
+    setStackSize(8 * 1024 * 1024);
+#endif
+  }
+
+protected:
+  void run() override
+  {
+    std::shared_ptr<Job> job;
+    while ((job = _scheduler->waitForJob())) {
+      job->runner->run();
+      _scheduler->jobDone(std::move(job));
+    }
+  }
+
+private:
+  PreviewScheduler * _scheduler;
+};
+
+PreviewScheduler::PreviewScheduler(QObject * parent, int workerCount) : QObject(parent), _quit(false), _heldBytes(0), _peakHeldBytes(0)
+{
+  _statistics.superseded = 0;
+  _statistics.aborted = 0;
+  _statistics.completed = 0;
+  _statistics.peakImageBytes = 0;
+  for (int i = 0; i < std::max(1, workerCount); ++i) {
+    _workers.push_back(new Worker(this));
+    _workers.back()->start();
+  }
+}
+
+PreviewScheduler::~PreviewScheduler()
+{
+  std::shared_ptr<Job> pending;
+  {
+    QMutexLocker locker(&_mutex);
+    _quit = true;
+    abortRunningJobs();
+    pending = std::move(_pendingJob);
+    _jobAvailable.wakeAll();
+  }
+  for (Worker * worker : _workers) {
+    worker->wait();
+    delete worker;
+  }
+  pending.reset();
+  _resultJob.reset();
+}
+
+void PreviewScheduler::submit(std::unique_ptr<FilterSyncRunner> runner, std::size_t inputBytes)
+{
+  std::shared_ptr<Job> job = std::make_shared<Job>(this);
+  job->runner = std::move(runner);
+  job->bytes = inputBytes;
+  holdBytes(inputBytes);
+  std::shared_ptr<Job> superseded;
+  std::shared_ptr<Job> staleResult;
+  {
+    QMutexLocker locker(&_mutex);
+    abortRunningJobs();
+    if (_pendingJob) {
+      ++_statistics.superseded;
+    }
+    superseded = std::move(_pendingJob);
+    staleResult = std::move(_resultJob);
+    _pendingJob = std::move(job);
+    _jobAvailable.wakeOne();
+  }
+}
+
+void PreviewScheduler::cancel()
+{
+  std::shared_ptr<Job> superseded;
+  std::shared_ptr<Job> staleResult;
+  bool nothingToUnwind;
+  {
+    QMutexLocker locker(&_mutex);
+    abortRunningJobs();
+    if (_pendingJob) {
+      ++_statistics.superseded;
+    }
+    superseded = std::move(_pendingJob);
+    staleResult = std::move(_resultJob);
+    nothingToUnwind = _runningJobs.empty() && (superseded || staleResult);
+  }
+  if (nothingToUnwind) {
+    // Callers waiting for the end of canceled work still expect the signal
+    QMetaObject::invokeMethod(this, "abortedRunsFinished", Qt::QueuedConnection);
+  }
+}
+
+std::unique_ptr<FilterSyncRunner> PreviewScheduler::takeResult()
+{
+  std::shared_ptr<Job> job;
+  {
+    QMutexLocker locker(&_mutex);
+    if (!_resultJob) {
+      return std::unique_ptr<FilterSyncRunner>();
+    }
+    job = std::move(_resultJob);
+    ++_statistics.completed;
+  }
+  return std::move(job->runner);
+}
+
+bool PreviewScheduler::isBusy() const
+{
+  QMutexLocker locker(&_mutex);
+  if (_pendingJob || _resultJob) {
+    return true;
+  }
+  return std::any_of(_runningJobs.begin(), _runningJobs.end(), [](const std::shared_ptr<Job> & job) { return !job->aborted; });
+}
+
+bool PreviewScheduler::hasAbortedRuns() const
+{
+  QMutexLocker locker(&_mutex);
+  return std::any_of(_runningJobs.begin(), _runningJobs.end(), [](const std::shared_ptr<Job> & job) { return job->aborted; });
+}
+
+float PreviewScheduler::progress() const
+{
+  QMutexLocker locker(&_mutex);
+  for (const std::shared_ptr<Job> & job : _runningJobs) {
+    if (!job->aborted) {
+      return job->runner->progress();
+    }
+  }
+  return 0.0f;
+}
+
+PreviewScheduler::Statistics PreviewScheduler::statistics() const
+{
+  QMutexLocker locker(&_mutex);
+  Statistics result = _statistics;
+  result.peakImageBytes = _peakHeldBytes;
+  return result;
+}
+
+std::size_t PreviewScheduler::imageBytes(const cimg_library::CImgList<float> & images)
+{
+  std::size_t result = 0;
+  for (unsigned int i = 0; i < images.size(); ++i) {
+    result += images[i].size() * sizeof(float);
+  }
+  return result;
+}
+
+std::shared_ptr<PreviewScheduler::Job> PreviewScheduler::waitForJob()
+{
+  QMutexLocker locker(&_mutex);
+  while (!_quit && !_pendingJob) {
+    _jobAvailable.wait(&_mutex);
+  }
+  if (_quit) {
+    return std::shared_ptr<Job>();
+  }
+  std::shared_ptr<Job> job = std::move(_pendingJob);
+  _runningJobs.push_back(job);
+  return job;
+}
+
+void PreviewScheduler::jobDone(std::shared_ptr<Job> job)
+{
+  const std::size_t outputBytes = imageBytes(job->runner->images());
+  std::shared_ptr<Job> released;
+  bool resultNow = false;
+  bool abortedRunsDone = false;
+  {
+    QMutexLocker locker(&_mutex);
+    _runningJobs.erase(std::find(_runningJobs.begin(), _runningJobs.end(), job));
+    if (job->aborted || _quit) {
+      abortedRunsDone = std::none_of(_runningJobs.begin(), _runningJobs.end(), [](const std::shared_ptr<Job> & other) { return other->aborted; });
+      released = std::move(job);
+    } else {
+      job->bytes += outputBytes;
+      holdBytes(outputBytes);
+      released = std::move(_resultJob);
+      _resultJob = std::move(job);
+      resultNow = true;
+    }
+  }
+  // Images of an aborted run are freed here, by the worker
+  released.reset();
+  if (resultNow) {
+    emit resultAvailable();
+  }
+  if (abortedRunsDone) {
+    emit abortedRunsFinished();
+  }
+}
+
+void PreviewScheduler::abortRunningJobs()
+{
+  // Mutex must be locked
+  for (const std::shared_ptr<Job> & job : _runningJobs) {
+    if (!job->aborted) {
+      job->aborted = true;
+      job->runner->abortGmic();
+      ++_statistics.aborted;
+    }
+  }
+}
+
+void PreviewScheduler::holdBytes(std::size_t bytes)
+{
+  const std::size_t held = (_heldBytes += bytes);
+  std::size_t peak = _peakHeldBytes;
+  while ((held > peak) && !_peakHeldBytes.compare_exchange_weak(peak, held)) {
+  }
+}
@@ -0,0 +1,105 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file PreviewScheduler.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_PREVIEWSCHEDULER_H
+#define GMIC_QT_PREVIEWSCHEDULER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class FilterSyncRunner;
+
+namespace cimg_library
+{
+template <typename T> struct CImgList;
+} // namespace cimg_library
+
+/**
+ * @brief Runs preview filters on a fixed set of persistent worker threads.
+ *
+ * Only the latest request matters: submitting a request aborts the running ones
+ * and supersedes the one still waiting for a worker, if any. Hence at most one
+ * request is queued, and at most one run per worker is in flight (all but one
+ * being aborted runs that are unwinding). Workers release the images of aborted
+ * runs as soon as G'MIC returns.
+ */
+class PreviewScheduler : public QObject {
+  Q_OBJECT
+public:
+  struct Statistics {
+    quint64 superseded;         // Requests dropped before a worker could start them
+    quint64 aborted;            // Runs aborted by a newer request or canceled
+    quint64 completed;          // Runs whose result has been taken
+    std::size_t peakImageBytes; // Peak of the image memory held by requests at once
+  };
+
+  PreviewScheduler(QObject * parent, int workerCount);
+  ~PreviewScheduler() override;
+
+  void submit(std::unique_ptr<FilterSyncRunner> runner, std::size_t inputBytes);
+  void cancel();
+
+  /**
+   * @brief Runner of the last request, once it has completed (and if it has
+   *        not been superseded since). Null otherwise.
+   */
+  std::unique_ptr<FilterSyncRunner> takeResult();
+
+  bool isBusy() const; // A request is queued, running, or its result was not taken
+  bool hasAbortedRuns() const;
+  float progress() const;
+  Statistics statistics() const;
+
+  static std::size_t imageBytes(const cimg_library::CImgList<float> & images);
+
+signals:
+  void resultAvailable();
+  void abortedRunsFinished();
+
+private:
+  class Worker;
+  struct Job;
+  std::shared_ptr<Job> waitForJob();
+  void jobDone(std::shared_ptr<Job> job);
+  void abortRunningJobs();
+  void holdBytes(std::size_t bytes);
+
+  mutable QMutex _mutex;
+  QWaitCondition _jobAvailable;
+  std::shared_ptr<Job> _pendingJob;
+  std::vector<std::shared_ptr<Job>> _runningJobs;
+  std::shared_ptr<Job> _resultJob;
+  std::vector<Worker *> _workers;
+  bool _quit;
+  Statistics _statistics;
+  std::atomic<std::size_t> _heldBytes;
+  std::atomic<std::size_t> _peakHeldBytes;
+};
+
+#endif // GMIC_QT_PREVIEWSCHEDULER_H
@@ -0,0 +1,85 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file PreviewTileCache.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "PreviewTileCache.h"
+#include <QDebug>
+#include <algorithm>
+#include "Common.h"
+#include "Globals.h"
+#include "gmic.h"
+
+PreviewTileCache::PreviewTileCache()
+{
+  setBudget(PREVIEW_TILE_CACHE_DEFAULT_SIZE);
+}
+
+PreviewTileCache::~PreviewTileCache() = default;
+
+void PreviewTileCache::setBudget(int megaBytes)
+{
+  _tiles.setMaxCost(megaBytes * 1024);
+}
+
+void PreviewTileCache::clear()
+{
+  _tiles.clear();
+}
+
+bool PreviewTileCache::contains(const QString & prefix, int column, int row) const
+{
+  return _tiles.contains(key(prefix, column, row));
+}
+
+const cimg_library::CImg<float> * PreviewTileCache::tile(const QString & prefix, int column, int row)
+{
+  return _tiles.object(key(prefix, column, row));
+}
+
+void PreviewTileCache::insert(const QString & prefix, int column, int row, cimg_library::CImg<float> & image)
+{
+  auto stored = new cimg_library::CImg<float>;
+  image.move_to(*stored);
+  const int cost = std::max(1, static_cast<int>((stored->size() * sizeof(float)) / 1024));
+  _tiles.insert(key(prefix, column, row), stored, cost); // Deletes the tile if it exceeds the whole budget
+}
+
+QString PreviewTileCache::keyPrefix(const QString & filterHash, const QString & arguments, double scale, int inputMode, int previewMode, int halo, const QSize & previewSize, unsigned int randomSeed)
+{
+  // Filters see the preview size through $_preview_width and $_preview_height
+  return QString("%1|%2|%3|%4|%5|%6x%7|%8|%9")
+      .arg(filterHash)
+      .arg(scale, 0, 'g', 10)
+      .arg(inputMode)
+      .arg(previewMode)
+      .arg(halo)
+      .arg(previewSize.width())
+      .arg(previewSize.height())
+      .arg(randomSeed)
+      .arg(arguments);
+}
+
+QString PreviewTileCache::key(const QString & prefix, int column, int row)
+{
+  return QString("%1,%2|%3").arg(column).arg(row).arg(prefix);
+}
@@ -0,0 +1,60 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file PreviewTileCache.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_PREVIEWTILECACHE_H
+#define GMIC_QT_PREVIEWTILECACHE_H
+
+#include <QCache>
+#include <QSize>
+#include <QString>
+
+namespace cimg_library
+{
+template <typename T> struct CImg;
+} // namespace cimg_library
+
+/**
+ * @brief Rendered preview tiles, least recently used ones being dropped first
+ *        when the memory budget is exceeded.
+ *
+ * Tiles are identified by a key prefix (see keyPrefix()) describing everything
+ * a rendering depends on, and by their column and row in the tile grid.
+ */
+class PreviewTileCache {
+public:
+  PreviewTileCache();
+  ~PreviewTileCache();
+  void setBudget(int megaBytes);
+  void clear();
+  bool contains(const QString & prefix, int column, int row) const;
+  const cimg_library::CImg<float> * tile(const QString & prefix, int column, int row);
+  void insert(const QString & prefix, int column, int row, cimg_library::CImg<float> & image); // image is moved into the cache
+  static QString keyPrefix(const QString & filterHash, const QString & arguments, double scale, int inputMode, int previewMode, int halo, const QSize & previewSize, unsigned int randomSeed);
+
+private:
+  static QString key(const QString & prefix, int column, int row);
+  QCache<QString, cimg_library::CImg<float>> _tiles; // Cost is in KiB
+};
+
+#endif // GMIC_QT_PREVIEWTILECACHE_H
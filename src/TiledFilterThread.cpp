@@ -0,0 +1,154 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file TiledFilterThread.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "TiledFilterThread.h"
+#include <QDebug>
+#include <QList>
+#include <algorithm>
+#include <memory>
+#include "Common.h"
+#include "CroppedImageListProxy.h"
+#include "gmic.h"
+
+TiledFilterThread::TiledFilterThread(QObject * parent, const QString & name, const QString & command, const QString & arguments, const QString & environment, GmicQt::OutputMessageMode mode,
+                                     int halo)
+    : FilterThread(parent, name, command, arguments, environment, mode), _halo(std::max(0, halo))
+{
+}
+
+TiledFilterThread::~TiledFilterThread() = default;
+
+void TiledFilterThread::run()
+{
+  _startTime.start();
+  _errorMessage.clear();
+  _failed = false;
+  _gmicAbort = false;
+  _gmicProgress = -1;
+  if (_inputImages) {
+    _copiedInputBytes = CroppedImageListProxy::detach(_inputImages, *_images);
+  }
+  const int threadCount = QThread::idealThreadCount();
+  if ((_images->size() != 1) || (threadCount < 2) || ((*_images)[0].width() * (*_images)[0].height() < MinimumTiledImageSize)) {
+    FilterThread::run();
+    return;
+  }
+
+  // Split the image in bands along its largest dimension
+  cimg_library::CImg<float> & image = (*_images)[0];
+  const bool horizontalBands = image.height() >= image.width();
+  const int length = horizontalBands ? image.height() : image.width();
+  const int bandCount = std::min(threadCount, length);
+  const int bandLength = (length + bandCount - 1) / bandCount;
+  QList<FilterThread *> workers;
+  QList<int> bandStarts;
+  QList<int> haloBefore;
+  for (int start = 0; start < length; start += bandLength) {
+    const int end = std::min(length, start + bandLength) - 1;
+    const int from = std::max(0, start - _halo);
+    const int to = std::min(length - 1, end + _halo);
+    std::shared_ptr<cimg_library::CImgList<float>> band(new cimg_library::CImgList<float>(1));
+    if (horizontalBands) {
+      image.get_crop(0, from, image.width() - 1, to).move_to((*band)[0]);
+    } else {
+      image.get_crop(from, 0, to, image.height() - 1).move_to((*band)[0]);
+    }
+    auto worker = new FilterThread(nullptr, _name, _command, _arguments, _environment, _messageMode);
+    worker->setInputImages(std::move(band));
+    worker->setImageNames(*_imageNames);
+    worker->setLogSuffix(_logSuffix);
+    workers.push_back(worker);
+    bandStarts.push_back(start);
+    haloBefore.push_back(start - from);
+  }
+  for (FilterThread * worker : workers) {
+    worker->start();
+  }
+
+  bool running = true;
+  while (running) {
+    running = false;
+    float progress = 0.0f;
+    for (FilterThread * worker : workers) {
+      if (_gmicAbort) {
+        worker->abortGmic();
+      }
+      running = !worker->wait(PollingDelay) || running;
+      progress += std::max(0.0f, worker->progress());
+    }
+    _gmicProgress = progress / workers.size();
+  }
+
+  // Stitch bands back, halos being discarded
+  bool bandsMatch = true;
+  int spectrum = 0;
+  for (int i = 0; i < workers.size(); ++i) {
+    const FilterThread * worker = workers[i];
+    if (worker->failed()) {
+      _failed = true;
+      _errorMessage = worker->errorMessage();
+      break;
+    }
+    const cimg_library::CImgList<float> & output = worker->images();
+    const int inputLength = std::min(length - 1, bandStarts[i] + bandLength - 1 + _halo) - (bandStarts[i] - haloBefore[i]) + 1;
+    bandsMatch = bandsMatch && (output.size() == 1) && (horizontalBands ? (output[0].width() == image.width() && output[0].height() == inputLength) //
+                                                                     : (output[0].height() == image.height() && output[0].width() == inputLength));
+    if (bandsMatch) {
+      bandsMatch = !i || (output[0].spectrum() == spectrum);
+      spectrum = output[0].spectrum();
+    }
+  }
+  if (_failed || _gmicAbort) {
+    _images->assign();
+    _imageNames->assign();
+    qDeleteAll(workers);
+    return;
+  }
+  if (!bandsMatch) {
+    qDeleteAll(workers);
+    qWarning() << QString("Filter '%1' is declared tile-safe but its output does not match its input bands").arg(_name);
+    FilterThread::run();
+    return;
+  }
+  if (spectrum != image.spectrum()) {
+    image.assign(image.width(), image.height(), 1, spectrum);
+  }
+  for (int i = 0; i < workers.size(); ++i) {
+    FilterThread * worker = workers[i];
+    cimg_library::CImgList<float> output;
+    worker->swapImages(output);
+    const cimg_library::CImg<float> & band = output[0];
+    const int bandEnd = std::min(length, bandStarts[i] + bandLength) - 1;
+    const int from = haloBefore[i];
+    const int to = from + bandEnd - bandStarts[i];
+    if (horizontalBands) {
+      image.draw_image(0, bandStarts[i], band.get_crop(0, from, band.width() - 1, to));
+    } else {
+      image.draw_image(bandStarts[i], 0, band.get_crop(from, 0, to, band.height() - 1));
+    }
+  }
+  _gmicStatus = workers.front()->_gmicStatus;
+  _imageNames->swap(*workers.front()->_imageNames);
+  qDeleteAll(workers);
+}
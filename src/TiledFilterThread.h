@@ -0,0 +1,52 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file TiledFilterThread.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_TILEDFILTERTHREAD_H
+#define GMIC_QT_TILEDFILTERTHREAD_H
+
+#include "FilterThread.h"
+
+/**
+ * @brief Runs a tile-safe filter (see the #@gui_tiles annotation) on bands of
+ *        the input image, in parallel, each band being extended by a halo.
+ *        Falls back to a single run when the input is not a single image
+ *        or when outputs do not match their input bands.
+ */
+class TiledFilterThread : public FilterThread {
+  Q_OBJECT
+
+public:
+  TiledFilterThread(QObject * parent, const QString & name, const QString & command, const QString & arguments, const QString & environment, GmicQt::OutputMessageMode mode, int halo);
+  ~TiledFilterThread() override;
+
+protected:
+  void run() override;
+
+private:
+  int _halo;
+  static const int MinimumTiledImageSize = 1024 * 1024; // Pixels
+  static const int PollingDelay = 50;                   // ms
+};
+
+#endif // GMIC_QT_TILEDFILTERTHREAD_H
@@ -23,19 +23,25 @@
  *
  */
 #include "Updater.h"
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDebug>
 #include <QNetworkRequest>
+#include <QSaveFile>
 #include <QTextStream>
 #include <QUrl>
 #include <iostream>
+#include "CimgzDecoder.h"
 #include "Common.h"
 #include "GmicStdlib.h"
+#include "Globals.h"
 #include "Logger.h"
 #include "Utils.h"
 #include "gmic.h"
 
 std::unique_ptr<Updater> Updater::_instance = std::unique_ptr<Updater>(nullptr);
 GmicQt::OutputMessageMode Updater::_outputMessageMode = GmicQt::Quiet;
+const quint32 Updater::StdlibCacheVersion = 1;
 
 Updater::Updater(QObject * parent) : QObject(parent)
 {
@@ -55,6 +61,12 @@ Updater::~Updater() = default;
 
 void Updater::updateSources(bool useNetwork)
 {
+  TIMING;
+  const QByteArray key = sourcesKey(useNetwork);
+  if (readCache(key)) {
+    TIMING;
+    return;
+  }
   _sources.clear();
   _sourceIsStdLib.clear();
   // Build sources map
@@ -94,6 +106,11 @@ void Updater::updateSources(bool useNetwork)
   //  _sourceIsStdLib["http://localhost:2222/update220.gmic"] = true;
 
   // SHOW(_sources);
+  _cachedSourcesKey = key;
+  _cachedStdlibKey.clear();
+  _cachedStdlib.clear();
+  writeCache();
+  TIMING;
 }
 
 void Updater::startUpdate(int ageLimit, int timeout, bool useNetwork)
@@ -129,7 +146,9 @@ void Updater::startUpdate(int ageLimit, int timeout, bool useNetwork)
           //
           // Note that this information may solely be used for purely anonymous
           // statistical purposes.
-          _pendingReplies.insert(_networkAccessManager->get(request));
+          QNetworkReply * reply = _networkAccessManager->get(request);
+          connect(reply, SIGNAL(readyRead()), this, SLOT(onNetworkReplyDataAvailable()));
+          _pendingReplies.insert(reply);
         }
       }
     }
@@ -187,18 +206,16 @@ bool Updater::allDownloadsOk() const
 void Updater::processReply(QNetworkReply * reply)
 {
   QString url = reply->request().url().toString();
-  if (!reply->bytesAvailable()) {
+  receiveReplyData(reply);
+  const Download download = _downloads.take(reply);
+  if (!download.decoder && download.data.isEmpty()) {
     return;
   }
-  QByteArray array = reply->readAll();
-  if (array.isNull()) {
-    _errorMessages << QString(tr("Error downloading %1 (empty file?)")).arg(url);
-    return;
-  }
-  if (!array.startsWith("#@gmic")) {
-    TRACE << QString("Decompressing reply from") << url;
-    QByteArray tmp = cimgzDecompress(array);
-    array = tmp;
+  QByteArray array;
+  if (download.decoder) {
+    array = download.decoder->takeResult();
+  } else {
+    array = download.data;
   }
   if (array.isNull() || !array.startsWith("#@gmic")) {
     _errorMessages << QString(tr("Could not read/decompress %1")).arg(url);
@@ -235,6 +252,7 @@ void Updater::onNetworkReplyFinished(QNetworkReply * reply)
     Logger::note(reply->readAll());
     Logger::note(QString("******** HTTP Status: %1").arg(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()));
   }
+  _downloads.remove(reply);
   _pendingReplies.remove(reply);
   if (_pendingReplies.isEmpty()) {
     if (_errorMessages.isEmpty()) {
@@ -273,39 +291,55 @@ void Updater::onUpdateNotNecessary()
 
 QByteArray Updater::cimgzDecompress(const QByteArray & array)
 {
-  QTemporaryFile tmpZ(QDir::tempPath() + QDir::separator() + "gmic_qt_update_XXXXXX_cimgz");
-  if (!tmpZ.open()) {
-    qWarning() << "Updater::cimgzDecompress(): Error creating" << tmpZ.fileName();
+  return CimgzDecoder::decompress(array);
+}
+
+QByteArray Updater::cimgzDecompressFile(const QString & filename)
+{
+  QFile file(filename);
+  if (!file.open(QFile::ReadOnly)) {
+    qWarning() << "Updater::cimgzDecompressFile(): Error opening file " << filename;
     return QByteArray();
   }
-  tmpZ.write(array);
-  tmpZ.flush();
-  tmpZ.close();
-  std::FILE * file = fopen(tmpZ.fileName().toLocal8Bit().constData(), "rb");
-  if (!file) {
-    qWarning() << "Updater::cimgzDecompress(): Error opening" << tmpZ.fileName();
-    return QByteArray();
+  CimgzDecoder decoder;
+  const qint64 size = file.size();
+  uchar * data = (size > 0) ? file.map(0, size) : nullptr;
+  if (data) {
+    decoder.feed(reinterpret_cast<const char *>(data), size);
+    file.unmap(data);
+  } else {
+    decoder.feed(file.readAll());
   }
-  cimg_library::CImg<unsigned char> buffer;
-  try {
-    buffer.load_cimg(file);
-  } catch (...) {
-    qWarning() << "Updater::cimgzDecompress(): CImg<>::load_cimg error for file " << tmpZ.fileName();
-    return QByteArray();
+  if (!decoder.isFinished()) {
+    qWarning() << "Updater::cimgzDecompressFile(): Cannot decompress file " << filename;
   }
-  return QByteArray((char *)buffer.data(), buffer.size());
+  return decoder.takeResult();
 }
 
-QByteArray Updater::cimgzDecompressFile(const QString & filename)
+void Updater::receiveReplyData(QNetworkReply * reply)
 {
-  cimg_library::CImg<unsigned char> buffer;
-  try {
-    buffer.load_cimg(filename.toLocal8Bit().constData());
-  } catch (...) {
-    qWarning() << "Updater::cimgzDecompressFile(): CImg<>::load_cimg error for file " << filename;
-    return QByteArray();
+  Download & download = _downloads[reply];
+  const QByteArray chunk = reply->readAll();
+  if (download.decoder) {
+    download.decoder->feed(chunk);
+    return;
+  }
+  // Plain files start with "#@gmic", anything else is decompressed as data arrives
+  download.data.append(chunk);
+  if ((download.data.size() >= 6) && !download.data.startsWith("#@gmic")) {
+    TRACE << QString("Decompressing reply from") << reply->request().url().toString();
+    download.decoder = std::make_shared<CimgzDecoder>();
+    download.decoder->feed(download.data);
+    download.data.clear();
+  }
+}
+
+void Updater::onNetworkReplyDataAvailable()
+{
+  auto reply = qobject_cast<QNetworkReply *>(sender());
+  if (reply) {
+    receiveReplyData(reply);
   }
-  return QByteArray((char *)buffer.data(), buffer.size());
 }
 
 QString Updater::localFilename(QString url)
@@ -331,15 +365,23 @@ QList<QString> Updater::sources() const
   return _sources;
 }
 
-QByteArray Updater::buildFullStdlib() const
+QByteArray Updater::buildFullStdlib(QByteArray * key)
 {
+  TIMING;
+  const QByteArray currentKey = stdlibKey();
+  if (key) {
+    *key = currentKey;
+  }
+  if (!_cachedStdlib.isEmpty() && (currentKey == _cachedStdlibKey)) {
+    TIMING;
+    return _cachedStdlib;
+  }
   QByteArray result;
   if (_sources.isEmpty()) {
     gmic_image<char> stdlib_h = gmic::decompress_stdlib();
     QByteArray tmp = QByteArray::fromRawData(stdlib_h, stdlib_h.size());
     tmp[tmp.size() - 1] = '\n';
     result.append(tmp);
-    return result;
   }
   for (const QString & source : _sources) {
     QString filename = localFilename(source);
@@ -374,9 +416,126 @@ QByteArray Updater::buildFullStdlib() const
     }
     result.append(QString("#@gui ") + QString("_").repeated(80) + QString("\n"));
   }
+  _cachedStdlib = result;
+  _cachedStdlibKey = currentKey;
+  writeCache();
+  TIMING;
   return result;
 }
 
+QByteArray Updater::lastKnownStdlib(QByteArray * key)
+{
+  TIMING;
+  QFile file(cacheFilename());
+  if (!file.open(QFile::ReadOnly)) {
+    return QByteArray();
+  }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+  quint32 version = 0;
+  QByteArray sourcesKey;
+  QList<QString> sources;
+  QMap<QString, bool> sourceIsStdLib;
+  QByteArray stdlibKey;
+  QByteArray stdlib;
+  stream >> version;
+  if (version != StdlibCacheVersion) {
+    return QByteArray();
+  }
+  stream >> sourcesKey >> sources >> sourceIsStdLib >> stdlibKey >> stdlib;
+  if (stream.status() != QDataStream::Ok) {
+    return QByteArray();
+  }
+  if (key) {
+    *key = stdlibKey;
+  }
+  TIMING;
+  return stdlib;
+}
+
+QByteArray Updater::sourcesKey(bool useNetwork)
+{
+  // The list of sources only depends on the G'MIC version, on network access,
+  // and on the user file where custom sources may be declared.
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  hash.addData(QByteArray::number(gmic_version));
+  hash.addData(QByteArray::number(useNetwork));
+  QFileInfo info(QString::fromLocal8Bit(gmic::path_user()));
+  if (info.exists()) {
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+  }
+  return hash.result();
+}
+
+QByteArray Updater::stdlibKey() const
+{
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  hash.addData(QByteArray::number(gmic_version));
+  for (const QString & source : _sources) {
+    hash.addData(source.toUtf8());
+    hash.addData(QByteArray::number(isStdlib(source)));
+    QFileInfo info(localFilename(source));
+    if (info.exists()) {
+      hash.addData(QByteArray::number(info.size()));
+      hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    }
+  }
+  return hash.result();
+}
+
+QString Updater::cacheFilename()
+{
+  return QString("%1%2").arg(GmicQt::path_rc(true), STDLIB_CACHE_FILENAME);
+}
+
+bool Updater::readCache(const QByteArray & sourcesKey)
+{
+  if (sourcesKey == _cachedSourcesKey) {
+    return true;
+  }
+  QFile file(cacheFilename());
+  if (!file.open(QFile::ReadOnly)) {
+    return false;
+  }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+  quint32 version = 0;
+  QByteArray key;
+  stream >> version >> key;
+  if ((version != StdlibCacheVersion) || (key != sourcesKey)) {
+    return false;
+  }
+  QList<QString> sources;
+  QMap<QString, bool> sourceIsStdLib;
+  QByteArray stdlibKey;
+  QByteArray stdlib;
+  stream >> sources >> sourceIsStdLib >> stdlibKey >> stdlib;
+  if (stream.status() != QDataStream::Ok) {
+    return false;
+  }
+  _sources = sources;
+  _sourceIsStdLib = sourceIsStdLib;
+  _cachedSourcesKey = key;
+  _cachedStdlibKey = stdlibKey;
+  _cachedStdlib = stdlib;
+  return true;
+}
+
+void Updater::writeCache() const
+{
+  QSaveFile file(cacheFilename());
+  if (!file.open(QFile::WriteOnly)) {
+    return;
+  }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_0);
+  stream << StdlibCacheVersion << _cachedSourcesKey << _sources << _sourceIsStdLib << _cachedStdlibKey << _cachedStdlib;
+  if (!file.commit()) {
+    Logger::warning("Cannot write filters sources cache " + file.fileName());
+  }
+}
+
 bool Updater::someNetworkUpdateAchieved() const
 {
   return _someNetworkUpdatesAchieved;
@@ -38,11 +38,12 @@
 #include <QSet>
 #include <QSettings>
 #include <QString>
-#include <QTemporaryFile>
 #include <QTimer>
 #include <memory>
 
 #include "gmic_qt.h"
+class CimgzDecoder;
+
 class Updater : public QObject {
   Q_OBJECT
 
@@ -74,7 +75,23 @@ public:
   bool someUpdatesNeeded(int ageLimit) const;
   bool allDownloadsOk() const;
   QList<QString> sources() const;
-  QByteArray buildFullStdlib() const;
+
+  /**
+   * @brief Build (or get from the cache) the stdlib from the sources
+   *
+   * @param[out] key If not null, the key which identifies the returned stdlib,
+   *                 computed from the G'MIC version and the sizes and dates of the sources
+   */
+  QByteArray buildFullStdlib(QByteArray * key = nullptr);
+
+  /**
+   * @brief The stdlib built during the last session, read from the cache
+   *        without checking whether sources changed since then.
+   *
+   * @param[out] key If not null, the key of the returned stdlib (see buildFullStdlib())
+   * @return An empty array if no cache is available
+   */
+  static QByteArray lastKnownStdlib(QByteArray * key = nullptr);
 
   bool someNetworkUpdateAchieved() const;
 
@@ -88,9 +105,11 @@ public slots:
   void notifyAllDownloadsOK();
   void cancelAllPendingDownloads();
   void onUpdateNotNecessary();
+  void onNetworkReplyDataAvailable();
 
 protected:
   void processReply(QNetworkReply * reply);
+  void receiveReplyData(QNetworkReply * reply);
 
 private:
   static QString localFilename(QString url);
@@ -99,6 +118,12 @@ private:
   explicit Updater(QObject * parent);
   static QByteArray cimgzDecompress(const QByteArray & array);
   static QByteArray cimgzDecompressFile(const QString & filename);
+  static QByteArray sourcesKey(bool useNetwork);
+  QByteArray stdlibKey() const;
+  static QString cacheFilename();
+  bool readCache(const QByteArray & sourcesKey);
+  void writeCache() const;
+  static const quint32 StdlibCacheVersion;
   static std::unique_ptr<Updater> _instance;
   static GmicQt::OutputMessageMode _outputMessageMode;
 
@@ -106,8 +131,17 @@ private:
   QList<QString> _sources;
   QMap<QString, bool> _sourceIsStdLib;
   QSet<QNetworkReply *> _pendingReplies;
+  struct Download {
+    QByteArray data; // Plain file, or first bytes of a compressed one
+    std::shared_ptr<CimgzDecoder> decoder;
+  };
+  QMap<QNetworkReply *, Download> _downloads;
   QList<QString> _errorMessages;
   bool _someNetworkUpdatesAchieved;
+  // Sources list and merged stdlib, also saved in the rc directory
+  QByteArray _cachedSourcesKey;
+  QByteArray _cachedStdlibKey;
+  QByteArray _cachedStdlib;
 };
 
 #endif // GMIC_QT_UPDATER_H
@@ -24,11 +24,18 @@
  */
 
 #include "Utils.h"
+#include <QCoreApplication>
 #include <QDebug>
 #include <QFileInfo>
 #include <QRegExp>
+#include <QRunnable>
+#include <QSemaphore>
 #include <QString>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
 #include "Common.h"
+#include "Globals.h"
 #include "Host/host.h"
 #include "gmic.h"
 
@@ -180,4 +187,68 @@ void appendWithSpace(QString & str, const QString & other)
   str += other;
 }
 
+void setupApplication()
+{
+  QCoreApplication::setOrganizationName(GMIC_QT_ORGANISATION_NAME);
+  QCoreApplication::setOrganizationDomain(GMIC_QT_ORGANISATION_DOMAIN);
+  QCoreApplication::setApplicationName(GMIC_QT_APPLICATION_NAME);
+  QCoreApplication::setAttribute(Qt::AA_DontUseNativeMenuBar);
+}
+
+namespace
+{
+class RowRangeTask : public QRunnable {
+public:
+  RowRangeTask(const std::function<void(int, int)> & function, int firstRow, int lastRow, QSemaphore & done) : _function(function), _firstRow(firstRow), _lastRow(lastRow), _done(done) {}
+  void run() override
+  {
+    _function(_firstRow, _lastRow);
+    _done.release();
+  }
+
+private:
+  const std::function<void(int, int)> & _function;
+  int _firstRow;
+  int _lastRow;
+  QSemaphore & _done;
+};
+
+int ParallelRowsThreadCount = 0;
+
+QThreadPool & rowsThreadPool()
+{
+  // Not the global instance, which may be busy with unrelated tasks
+  static QThreadPool pool;
+  return pool;
+}
+} // namespace
+
+void parallelForRows(int rows, int rowLength, const std::function<void(int, int)> & function)
+{
+  if (rows <= 0) {
+    return;
+  }
+  const int threads = (ParallelRowsThreadCount > 0) ? ParallelRowsThreadCount : QThread::idealThreadCount();
+  const int chunks = std::min(threads, rows);
+  if ((chunks < 2) || (static_cast<qint64>(rows) * rowLength < PARALLEL_ROWS_MINIMUM_PIXELS)) {
+    function(0, rows - 1);
+    return;
+  }
+  const int chunkRows = (rows + chunks - 1) / chunks;
+  QSemaphore done;
+  int tasks = 0;
+  for (int first = chunkRows; first < rows; first += chunkRows) {
+    rowsThreadPool().start(new RowRangeTask(function, first, std::min(rows, first + chunkRows) - 1, done));
+    ++tasks;
+  }
+  function(0, chunkRows - 1);
+  done.acquire(tasks);
+}
+
+void setParallelRowsThreadCount(int count)
+{
+  ParallelRowsThreadCount = count;
+  rowsThreadPool().setMaxThreadCount((count > 0) ? count : QThread::idealThreadCount());
+}
+
 } // namespace GmicQt
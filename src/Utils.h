@@ -25,6 +25,7 @@
 #ifndef GMIC_QT_UTILS_H
 #define GMIC_QT_UTILS_H
 
+#include <functional>
 #include "gmic_qt.h"
 class QString;
 
@@ -37,6 +38,20 @@ const QString & pluginCodeName();
 const char * commandFromOutputMessageMode(OutputMessageMode mode);
 void downcaseCommandTitle(QString & title);
 void appendWithSpace(QString & str, const QString & other);
+
+/**
+ * @brief Set the organization and application names (which locate the settings)
+ *        and the attributes of the application, once the application object exists
+ */
+void setupApplication();
+
+/**
+ * @brief Call function(firstRow, lastRow) on consecutive ranges of rows, in parallel.
+ *        Images with less than PARALLEL_ROWS_MINIMUM_PIXELS pixels are processed serially,
+ *        in the calling thread.
+ */
+void parallelForRows(int rows, int rowLength, const std::function<void(int, int)> & function);
+void setParallelRowsThreadCount(int count); // 0 means QThread::idealThreadCount()
 } // namespace GmicQt
 
 #endif // GMIC_QT_UTILS_H
@@ -50,10 +50,6 @@ const PreviewWidget::PreviewRect PreviewWidget::PreviewRect::Full{0.0, 0.0, 1.0,
 PreviewWidget::PreviewWidget(QWidget * parent) : QWidget(parent)
 {
   setAutoFillBackground(false);
-  _image = new cimg_library::CImg<float>;
-  _image->assign();
-  _savedPreview = new cimg_library::CImg<float>;
-  _savedPreview->assign();
   _transparency.load(":resources/transparency.png");
 
   _visibleRect = PreviewRect::Full;
@@ -74,25 +70,23 @@ PreviewWidget::PreviewWidget(QWidget * parent) : QWidget(parent)
   setMouseTracking(false);
 }
 
-PreviewWidget::~PreviewWidget()
-{
-  delete _image;
-  delete _savedPreview;
-}
+PreviewWidget::~PreviewWidget() {}
 
-const cimg_library::CImg<float> & PreviewWidget::image() const
+std::shared_ptr<const PreviewFrame> PreviewWidget::previewFrame() const
 {
-  return *_image;
+  return _frame;
 }
 
-void PreviewWidget::setPreviewImage(const cimg_library::CImg<float> & image)
+void PreviewWidget::setPreviewFrame(std::shared_ptr<const PreviewFrame> frame)
 {
   _errorMessage.clear();
   _errorImage = QImage();
   _overlayMessage.clear();
-  *_image = image;
-  *_savedPreview = image;
+  // Frames are immutable, so the saved preview is the same one
+  _frame = std::move(frame);
+  _savedPreview = _frame;
   _savedPreviewIsValid = true;
+  _cachedPreview = QPixmap();
   updateOriginalImagePosition();
   _paintOriginalImage = false;
   if (isAtFullZoom()) {
@@ -113,6 +107,12 @@ void PreviewWidget::setOverlayMessage(const QString & message)
   update();
 }
 
+void PreviewWidget::setDebugOverlay(const QString & text)
+{
+  _debugOverlay = text;
+  update();
+}
+
 void PreviewWidget::clearOverlayMessage()
 {
   _overlayMessage.clear();
@@ -133,6 +133,7 @@ void PreviewWidget::setFullImageSize(const QSize & size)
 {
   _fullImageSize = size;
   CroppedActiveLayerProxy::clear();
+  _cachedOriginalImage = QPixmap();
   updateVisibleRect();
   saveVisibleCenter();
 }
@@ -143,6 +144,7 @@ void PreviewWidget::updateFullImageSizeIfDifferent(const QSize & size)
     setFullImageSize(size);
   } else {
     CroppedActiveLayerProxy::clear();
+    _cachedOriginalImage = QPixmap();
   }
 }
 
@@ -341,7 +343,7 @@ void PreviewWidget::paintPreview(QPainter & painter)
     return;
   }
 
-  if (!_image->width() && !_image->height()) {
+  if (!_frame || _frame->isNull()) {
     painter.fillRect(rect(), QBrush(_transparency));
     paintKeypoints(painter);
     return;
@@ -350,7 +352,7 @@ void PreviewWidget::paintPreview(QPainter & painter)
    *  we are at "full image" zoom of an image smaller than the widget,
    *  then the image should fit the widget size.
    */
-  const QSize previewImageSize(_image->width(), _image->height());
+  const QSize previewImageSize = _frame->size();
   if ((previewImageSize != _originalImageScaledSize) || (isAtFullZoom() && _currentZoomFactor > 1.0)) {
     QSize imageSize;
     if (previewImageSize != _originalImageScaledSize) {
@@ -366,30 +368,58 @@ void PreviewWidget::paintPreview(QPainter & painter)
    *  Otherwise : Preview size == Original scaled size and image position is therefore unchanged
    */
 
-  if (hasAlphaChannel(*_image)) {
+  // Converted image is kept as long as neither the preview nor its displayed size change
+  if (_cachedPreview.isNull() || (_cachedPreview.size() != _imagePosition.size())) {
+    // Frames are already converted, only scaling may be left
+    const QImage & image = _frame->image();
+    if (image.size() == _imagePosition.size()) {
+      _cachedPreview = QPixmap::fromImage(image);
+    } else {
+      _cachedPreview = QPixmap::fromImage(image.scaled(_imagePosition.size(), Qt::IgnoreAspectRatio, Qt::FastTransformation));
+    }
+  }
+  if (_cachedPreview.hasAlphaChannel()) {
     painter.fillRect(_imagePosition, QBrush(_transparency));
   }
-  QImage qimage;
-  ImageConverter::convert(_image->get_resize(_imagePosition.width(), _imagePosition.height(), 1, -100, 1), qimage);
-  painter.drawImage(_imagePosition, qimage);
+  painter.drawPixmap(_imagePosition, _cachedPreview);
   paintKeypoints(painter);
+  paintDebugOverlay(painter);
+}
+
+void PreviewWidget::paintDebugOverlay(QPainter & painter)
+{
+  if (_debugOverlay.isEmpty()) {
+    return;
+  }
+  const QRect textRect = painter.fontMetrics().boundingRect(rect().adjusted(5, 5, -5, -5), Qt::AlignLeft | Qt::AlignTop, _debugOverlay);
+  painter.fillRect(textRect.adjusted(-3, -3, 3, 3), QColor(0, 0, 0, 160));
+  painter.setPen(Qt::yellow);
+  painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop, _debugOverlay);
 }
 
 void PreviewWidget::paintOriginalImage(QPainter & painter)
 {
-  gmic_image<float> image;
-  getOriginalImageCrop(image);
   updateOriginalImagePosition();
-  if (!image.width() && !image.height()) {
+  if (_cachedOriginalImage.isNull() || (_cachedOriginalImageRect != _visibleRect) || (_cachedOriginalImage.size() != _imagePosition.size())) {
+    gmic_image<float> image;
+    getOriginalImageCrop(image);
+    if (!image.width() && !image.height()) {
+      _cachedOriginalImage = QPixmap();
+    } else {
+      image.resize(_imagePosition.width(), _imagePosition.height(), 1, -100, 1);
+      QImage qimage;
+      ImageConverter::convert(image, qimage);
+      _cachedOriginalImage = QPixmap::fromImage(qimage);
+    }
+    _cachedOriginalImageRect = _visibleRect;
+  }
+  if (_cachedOriginalImage.isNull()) {
     painter.fillRect(rect(), QBrush(_transparency));
   } else {
-    image.resize(_imagePosition.width(), _imagePosition.height(), 1, -100, 1);
-    if (hasAlphaChannel(image)) {
+    if (_cachedOriginalImage.hasAlphaChannel()) {
       painter.fillRect(_imagePosition, QBrush(_transparency));
     }
-    QImage qimage;
-    ImageConverter::convert(image, qimage);
-    painter.drawImage(_imagePosition, qimage);
+    painter.drawPixmap(_imagePosition, _cachedOriginalImage);
     paintKeypoints(painter);
   }
 }
@@ -927,7 +957,8 @@ void PreviewWidget::invalidateSavedPreview()
 
 void PreviewWidget::restorePreview()
 {
-  *_image = *_savedPreview;
+  _frame = _savedPreview;
+  _cachedPreview = QPixmap();
 }
 
 void PreviewWidget::enableRightClick()
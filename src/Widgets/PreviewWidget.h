@@ -37,6 +37,7 @@
 #include <memory>
 #include "Host/host.h"
 #include "KeypointList.h"
+#include "PreviewFrame.h"
 #include "ZoomConstraint.h"
 
 namespace cimg_library
@@ -61,11 +62,12 @@ public:
   double defaultZoomFactor() const;
   void updateVisibleRect();
   void centerVisibleRect();
-  void setPreviewImage(const cimg_library::CImg<float> & image);
+  void setPreviewFrame(std::shared_ptr<const PreviewFrame> frame);
   void setOverlayMessage(const QString &);
   void clearOverlayMessage();
+  void setDebugOverlay(const QString &);
   void setPreviewErrorMessage(const QString &);
-  const cimg_library::CImg<float> & image() const;
+  std::shared_ptr<const PreviewFrame> previewFrame() const;
   void translateNormalized(double dx, double dy);
   void translateFullImage(double dx, double dy);
   void setPreviewEnabled(bool on);
@@ -128,6 +130,7 @@ public slots:
 private:
   void paintPreview(QPainter &);
   void paintOriginalImage(QPainter &);
+  void paintDebugOverlay(QPainter &);
   void getOriginalImageCrop(cimg_library::CImg<float> & image);
   void updateOriginalImagePosition();
   void updateErrorImage();
@@ -140,8 +143,8 @@ private:
 
   QSize originalImageCropSize();
   void saveVisibleCenter();
-  cimg_library::CImg<float> * _image;
-  cimg_library::CImg<float> * _savedPreview;
+  std::shared_ptr<const PreviewFrame> _frame;
+  std::shared_ptr<const PreviewFrame> _savedPreview;
   QSize _fullImageSize;
   double _currentZoomFactor;
   ZoomConstraint _zoomConstraint;
@@ -197,7 +200,11 @@ private:
   bool _rightClickEnabled;
   QString _errorMessage;
   QString _overlayMessage;
+  QString _debugOverlay; // Drawn in a corner of the preview, if not empty
   QImage _errorImage;
+  QPixmap _cachedPreview;       // Image of _frame, scaled to _imagePosition if needed
+  QPixmap _cachedOriginalImage; // Original crop, resized and converted for display
+  PreviewRect _cachedOriginalImageRect;
   KeypointList _keypoints;
   int _movedKeypointIndex;
   QPoint _movedKeypointOrigin;
@@ -0,0 +1,357 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file WorkerPool.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "WorkerPool.h"
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QProcessEnvironment>
+#include <QSharedMemory>
+#include <QStringList>
+#include <QThread>
+#include <QUuid>
+#include <algorithm>
+#include <ostream>
+#include "Common.h"
+#include "Globals.h"
+#include "WorkerProcess.h"
+#include "gmic.h"
+
+struct WorkerPool::Job {
+  int id;
+  QString command;
+  QString environment;
+  std::shared_ptr<const cimg_library::CImgList<float>> input;
+  double megaPixels;
+  std::shared_ptr<cimg_library::CImgList<float>> output;
+  QString errorMessage;
+  int attempts;
+  bool finished;
+};
+
+struct WorkerPool::Worker {
+  QProcess * process;
+  bool ready;
+  std::shared_ptr<Job> job;
+  std::unique_ptr<QSharedMemory> input;
+  QElapsedTimer jobTimer;
+  WorkerStatistics statistics;
+};
+
+WorkerPool::WorkerPool(QObject * parent, int workerCount) : QObject(parent), _nextJobId(0), _quitting(false)
+{
+  workerCount = std::max(1, workerCount);
+  // Workers share the cores instead of each one starting a thread per core
+  _ompThreadsPerWorker = std::max(1, QThread::idealThreadCount() / workerCount);
+  for (int i = 0; i < workerCount; ++i) {
+    std::unique_ptr<Worker> worker(new Worker);
+    worker->process = nullptr;
+    worker->ready = false;
+    worker->statistics = WorkerStatistics{0, 0, 0, 0.0, 0};
+    _workers.push_back(std::move(worker));
+    startWorker(*_workers.back());
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  _quitting = true;
+  for (const std::unique_ptr<Worker> & worker : _workers) {
+    if (worker->process) {
+      worker->process->write("quit\n");
+    }
+  }
+  for (const std::unique_ptr<Worker> & worker : _workers) {
+    if (worker->process && !worker->process->waitForFinished(WORKER_QUIT_TIMEOUT_MS)) {
+      worker->process->kill();
+      worker->process->waitForFinished();
+    }
+    delete worker->process;
+    worker->process = nullptr;
+  }
+}
+
+int WorkerPool::workerCount() const
+{
+  return static_cast<int>(_workers.size());
+}
+
+int WorkerPool::submit(const QString & command, const QString & environment, std::shared_ptr<const cimg_library::CImgList<float>> images)
+{
+  std::shared_ptr<Job> job = std::make_shared<Job>();
+  job->id = _nextJobId++;
+  job->command = command;
+  job->environment = environment;
+  job->megaPixels = 0.0;
+  for (unsigned int i = 0; i < images->size(); ++i) {
+    job->megaPixels += (*images)[i].width() * static_cast<double>((*images)[i].height()) / 1e6;
+  }
+  job->input = std::move(images);
+  job->attempts = 0;
+  job->finished = false;
+  _jobs.insert(job->id, job);
+  _queue.push_back(job);
+  dispatch();
+  return job->id;
+}
+
+void WorkerPool::waitForDone()
+{
+  QEventLoop loop;
+  QMetaObject::Connection connection = connect(this, &WorkerPool::jobFinished, &loop, [this, &loop]() {
+    if (!hasUnfinishedJobs()) {
+      loop.quit();
+    }
+  });
+  if (hasUnfinishedJobs()) {
+    loop.exec();
+  }
+  disconnect(connection);
+}
+
+std::shared_ptr<cimg_library::CImgList<float>> WorkerPool::takeOutput(int job)
+{
+  std::shared_ptr<Job> taken = _jobs.take(job);
+  return taken ? taken->output : std::shared_ptr<cimg_library::CImgList<float>>();
+}
+
+QString WorkerPool::errorMessage(int job) const
+{
+  std::shared_ptr<Job> found = _jobs.value(job);
+  return found ? found->errorMessage : QString();
+}
+
+bool WorkerPool::runTiled(const QString & command, const QString & environment, cimg_library::CImg<float> & image, int halo, QString & errorMessage)
+{
+  struct Band {
+    int job;
+    int start;
+    int end;
+    int from;
+    int to;
+  };
+  errorMessage.clear();
+  halo = std::max(0, halo);
+  const bool horizontalBands = image.height() >= image.width();
+  const int length = horizontalBands ? image.height() : image.width();
+  // More bands than workers, so that a slow band does not leave the others idle
+  const int bandCount = std::max(1, std::min(length, workerCount() * WORKER_BANDS_PER_WORKER));
+  const int bandLength = (length + bandCount - 1) / bandCount;
+  QList<Band> bands;
+  for (int start = 0; start < length; start += bandLength) {
+    Band band;
+    band.start = start;
+    band.end = std::min(length, start + bandLength) - 1;
+    band.from = std::max(0, start - halo);
+    band.to = std::min(length - 1, band.end + halo);
+    std::shared_ptr<cimg_library::CImgList<float>> input(new cimg_library::CImgList<float>(1));
+    if (horizontalBands) {
+      image.get_crop(0, band.from, image.width() - 1, band.to).move_to((*input)[0]);
+    } else {
+      image.get_crop(band.from, 0, band.to, image.height() - 1).move_to((*input)[0]);
+    }
+    band.job = submit(command, environment, std::move(input));
+    bands.push_back(band);
+  }
+  waitForDone();
+
+  cimg_library::CImg<float> result;
+  for (const Band & band : bands) {
+    const QString message = this->errorMessage(band.job);
+    std::shared_ptr<cimg_library::CImgList<float>> output = takeOutput(band.job);
+    if (!errorMessage.isEmpty()) {
+      continue;
+    }
+    if (!output) {
+      errorMessage = message;
+      continue;
+    }
+    const int inputLength = band.to - band.from + 1;
+    if ((output->size() != 1) || (horizontalBands ? ((*output)[0].width() != image.width() || (*output)[0].height() != inputLength) //
+                                                  : ((*output)[0].height() != image.height() || (*output)[0].width() != inputLength)) ||
+        (!result.is_empty() && ((*output)[0].spectrum() != result.spectrum()))) {
+      errorMessage = QString("Output of command '%1' does not match its input bands").arg(command);
+      continue;
+    }
+    const cimg_library::CImg<float> & output0 = (*output)[0];
+    if (result.is_empty()) {
+      result.assign(image.width(), image.height(), 1, output0.spectrum());
+    }
+    const int from = band.start - band.from;
+    const int to = from + band.end - band.start;
+    if (horizontalBands) {
+      result.draw_image(0, band.start, output0.get_crop(0, from, output0.width() - 1, to));
+    } else {
+      result.draw_image(band.start, 0, output0.get_crop(from, 0, to, output0.height() - 1));
+    }
+  }
+  if (!errorMessage.isEmpty()) {
+    return false;
+  }
+  image.swap(result);
+  return true;
+}
+
+QList<WorkerPool::WorkerStatistics> WorkerPool::statistics() const
+{
+  QList<WorkerStatistics> result;
+  for (const std::unique_ptr<Worker> & worker : _workers) {
+    result.push_back(worker->statistics);
+  }
+  return result;
+}
+
+void WorkerPool::report(std::ostream & out) const
+{
+  out << "Worker processes: " << _workers.size() << " (" << _ompThreadsPerWorker << " OpenMP threads each)\n";
+  for (size_t i = 0; i < _workers.size(); ++i) {
+    const WorkerStatistics & statistics = _workers[i]->statistics;
+    out << "  worker " << i + 1 << ": " << statistics.jobs << " jobs, " << statistics.failures << " failed, " << statistics.restarts << " restarts, " << statistics.megaPixels << " MPix, "
+        << statistics.megaPixels / std::max<qint64>(1, statistics.busyTime) * 1000.0 << " MPix/s\n";
+  }
+}
+
+void WorkerPool::startWorker(Worker & worker)
+{
+  Worker * w = &worker;
+  worker.ready = false;
+  worker.process = new QProcess(this);
+  QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+  environment.insert("OMP_NUM_THREADS", QString::number(_ompThreadsPerWorker));
+  worker.process->setProcessEnvironment(environment);
+  worker.process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+  connect(worker.process, &QProcess::readyReadStandardOutput, this, [this, w]() { onReadyRead(*w); });
+  connect(worker.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), this, [this, w]() { onWorkerFinished(*w); });
+  connect(worker.process, &QProcess::errorOccurred, this, [this, w](QProcess::ProcessError error) {
+    if (error == QProcess::FailedToStart) {
+      onWorkerFinished(*w);
+    }
+  });
+  worker.process->start(QCoreApplication::applicationFilePath(), QStringList() << "--worker");
+}
+
+void WorkerPool::dispatch()
+{
+  for (const std::unique_ptr<Worker> & worker : _workers) {
+    while (!_queue.empty() && worker->process && worker->ready && !worker->job) {
+      std::shared_ptr<Job> job = _queue.front();
+      _queue.pop_front();
+      if (!WorkerProcess::fitsInSharedMemory(WorkerProcess::sharedSize(*job->input))) {
+        completeJob(*job, QString("Input images are too large to be shared"));
+        continue;
+      }
+      worker->input.reset(new QSharedMemory(QString("gmic_qt_job_%1").arg(QUuid::createUuid().toString())));
+      if (!WorkerProcess::writeImages(*job->input, *worker->input)) {
+        completeJob(*job, QString("Cannot share input images: %1").arg(worker->input->errorString()));
+        worker->input.reset();
+        continue;
+      }
+      ++job->attempts;
+      worker->job = job;
+      worker->jobTimer.start();
+      worker->process->write("run " + QByteArray::number(job->id) + " " + worker->input->key().toLatin1() + " " + WorkerProcess::encode(job->command) + " " + WorkerProcess::encode(job->environment) +
+                             "\n");
+    }
+  }
+}
+
+void WorkerPool::onReadyRead(Worker & worker)
+{
+  while (worker.process && worker.process->canReadLine()) {
+    const QList<QByteArray> words = worker.process->readLine().trimmed().split(' ');
+    const bool aboutCurrentJob = (words.size() >= 3) && worker.job && (words[1].toInt() == worker.job->id);
+    if (words.front() == "ready") {
+      worker.ready = true;
+    } else if ((words.front() == "done") && aboutCurrentJob) {
+      std::shared_ptr<cimg_library::CImgList<float>> output(new cimg_library::CImgList<float>);
+      const bool ok = WorkerProcess::readImages(QString::fromLatin1(words[2]), *output);
+      worker.process->write("release\n");
+      std::shared_ptr<Job> job = releaseJob(worker, ok);
+      job->output = ok ? output : std::shared_ptr<cimg_library::CImgList<float>>();
+      completeJob(*job, ok ? QString() : QString("Cannot read output images"));
+    } else if ((words.front() == "error") && aboutCurrentJob) {
+      std::shared_ptr<Job> job = releaseJob(worker, false);
+      completeJob(*job, WorkerProcess::decode(words[2]));
+    }
+    // Other lines are messages of the interpreter
+  }
+  dispatch();
+}
+
+void WorkerPool::onWorkerFinished(Worker & worker)
+{
+  if (_quitting || !worker.process) {
+    return;
+  }
+  worker.process->deleteLater();
+  worker.process = nullptr;
+  worker.ready = false;
+  if (worker.job) {
+    std::shared_ptr<Job> job = releaseJob(worker, false);
+    if (job->attempts < WORKER_MAX_ATTEMPTS) {
+      _queue.push_front(job);
+    } else {
+      completeJob(*job, QString("Worker process died while running command '%1'").arg(job->command));
+    }
+  }
+  if (worker.statistics.restarts < WORKER_MAX_RESTARTS) {
+    ++worker.statistics.restarts;
+    startWorker(worker);
+  }
+  const bool someWorkerAlive = std::any_of(_workers.begin(), _workers.end(), [](const std::unique_ptr<Worker> & other) { return other->process != nullptr; });
+  if (!someWorkerAlive) {
+    while (!_queue.empty()) {
+      std::shared_ptr<Job> job = _queue.front();
+      _queue.pop_front();
+      completeJob(*job, QString("No worker process could be started"));
+    }
+  }
+  dispatch();
+}
+
+std::shared_ptr<WorkerPool::Job> WorkerPool::releaseJob(Worker & worker, bool succeeded)
+{
+  std::shared_ptr<Job> job = std::move(worker.job);
+  worker.input.reset();
+  worker.statistics.busyTime += worker.jobTimer.elapsed();
+  if (succeeded) {
+    ++worker.statistics.jobs;
+    worker.statistics.megaPixels += job->megaPixels;
+  } else {
+    ++worker.statistics.failures;
+  }
+  return job;
+}
+
+void WorkerPool::completeJob(Job & job, const QString & errorMessage)
+{
+  job.errorMessage = errorMessage;
+  job.finished = true;
+  job.input.reset();
+  emit jobFinished(job.id);
+}
+
+bool WorkerPool::hasUnfinishedJobs() const
+{
+  return std::any_of(_jobs.begin(), _jobs.end(), [](const std::shared_ptr<Job> & job) { return !job->finished; });
+}
@@ -0,0 +1,120 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file WorkerPool.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_WORKERPOOL_H
+#define GMIC_QT_WORKERPOOL_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <deque>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+class QSharedMemory;
+
+namespace cimg_library
+{
+template <typename T> struct CImgList;
+template <typename T> struct CImg;
+} // namespace cimg_library
+
+/**
+ * @brief Runs G'MIC jobs in worker processes (see WorkerProcess), for batches
+ *        of images or for the tiles of a single one.
+ *
+ * Each worker has its own allocator and OpenMP thread pool (sized so that workers
+ * do not oversubscribe the CPU), and a crashing worker only loses its current job,
+ * which is given to another worker while the dead one is respawned.
+ * Everything stays on the local machine: images go through shared memory.
+ */
+class WorkerPool : public QObject {
+  Q_OBJECT
+public:
+  struct WorkerStatistics {
+    int jobs;
+    int failures;
+    int restarts;
+    double megaPixels; // Processed input pixels
+    qint64 busyTime;   // ms, including the transfer of images
+  };
+
+  WorkerPool(QObject * parent, int workerCount);
+  ~WorkerPool() override;
+
+  int workerCount() const;
+
+  /**
+   * @brief Queue a job. Its input is kept until it completes, so that it can be
+   *        given to another worker if its worker dies.
+   * @return The job id
+   */
+  int submit(const QString & command, const QString & environment, std::shared_ptr<const cimg_library::CImgList<float>> images);
+
+  /**
+   * @brief Process events until every submitted job has either completed or failed
+   */
+  void waitForDone();
+
+  /**
+   * @brief Output of a completed job (null if it failed), the job being forgotten
+   */
+  std::shared_ptr<cimg_library::CImgList<float>> takeOutput(int job);
+  QString errorMessage(int job) const; // Empty if the job did not fail
+
+  /**
+   * @brief Run a tile-safe command on bands of an image, each band being extended by a halo
+   */
+  bool runTiled(const QString & command, const QString & environment, cimg_library::CImg<float> & image, int halo, QString & errorMessage);
+
+  QList<WorkerStatistics> statistics() const;
+  void report(std::ostream & out) const;
+
+signals:
+  void jobFinished(int job);
+
+private:
+  struct Job;
+  struct Worker;
+  void startWorker(Worker & worker);
+  void dispatch();
+  void onReadyRead(Worker & worker);
+  void onWorkerFinished(Worker & worker);
+  std::shared_ptr<Job> releaseJob(Worker & worker, bool succeeded);
+  void completeJob(Job & job, const QString & errorMessage);
+  bool hasUnfinishedJobs() const;
+
+  std::vector<std::unique_ptr<Worker>> _workers;
+  std::deque<std::shared_ptr<Job>> _queue;
+  QMap<int, std::shared_ptr<Job>> _jobs;
+  int _nextJobId;
+  int _ompThreadsPerWorker;
+  bool _quitting;
+};
+
+#endif // GMIC_QT_WORKERPOOL_H
@@ -0,0 +1,213 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file WorkerProcess.cpp
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "WorkerProcess.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QSharedMemory>
+#include <QUuid>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include "Common.h"
+#include "FilterSyncRunner.h"
+#include "GmicInterpreterPool.h"
+#include "GmicStdlib.h"
+#include "Updater.h"
+#include "gmic.h"
+
+namespace
+{
+const quint32 SharedImagesMagic = 0x676d6963; // "gmic"
+
+void reply(QFile & out, const QByteArray & line)
+{
+  out.write(line);
+  out.write("\n");
+  out.flush();
+}
+
+// Number of values of an image, which must not exceed the available ones
+bool imageValueCount(const qint32 * dimensions, std::size_t available, std::size_t & count)
+{
+  count = 1;
+  for (int k = 0; k < 4; ++k) {
+    if (dimensions[k] < 0) {
+      return false;
+    }
+    const std::size_t dimension = static_cast<std::size_t>(dimensions[k]);
+    if (dimension && (count > available / dimension)) {
+      return false;
+    }
+    count *= dimension;
+  }
+  return true;
+}
+} // namespace
+
+int WorkerProcess::exec()
+{
+  // Same setup as the headless processor, done once for all the jobs
+  Updater::getInstance()->updateSources(false);
+  GmicStdLib::Array = Updater::getInstance()->buildFullStdlib(&GmicStdLib::Key);
+  GmicInterpreterPool::clear();
+
+  QFile in;
+  QFile out;
+  if (!in.open(stdin, QIODevice::ReadOnly) || !out.open(stdout, QIODevice::WriteOnly)) {
+    return 1;
+  }
+  reply(out, "ready");
+  std::unique_ptr<QSharedMemory> output;
+  while (true) {
+    const QByteArray line = in.readLine().trimmed();
+    // The coordinator has read the last output (or does not care anymore)
+    output.reset();
+    if (line.isEmpty() && in.atEnd()) {
+      return 0;
+    }
+    const QList<QByteArray> words = line.split(' ');
+    if (words.front() == "quit") {
+      return 0;
+    }
+    if ((words.front() != "run") || (words.size() < 4)) {
+      continue;
+    }
+    const QByteArray & id = words[1];
+    std::shared_ptr<cimg_library::CImgList<float>> images(new cimg_library::CImgList<float>);
+    if (!readImages(QString::fromLatin1(words[2]), *images)) {
+      reply(out, "error " + id + " " + encode(QString("Cannot read input images")));
+      continue;
+    }
+    cimg_library::CImgList<char> imageNames(images->size());
+    for (unsigned int i = 0; i < imageNames.size(); ++i) {
+      imageNames[i].assign("image", 6);
+    }
+    FilterSyncRunner runner(nullptr, QString("Worker job %1").arg(QString::fromLatin1(id)), decode(words[3]), QString(), (words.size() > 4) ? decode(words[4]) : QString(), GmicQt::Quiet);
+    runner.setInputImages(std::move(images));
+    runner.setImageNames(imageNames);
+    QElapsedTimer timer;
+    timer.start();
+    runner.run();
+    if (runner.failed()) {
+      reply(out, "error " + id + " " + encode(runner.errorMessage()));
+      continue;
+    }
+    const std::size_t size = sharedSize(runner.images());
+    if (!fitsInSharedMemory(size)) {
+      reply(out, "error " + id + " " + encode(QString("Output images are too large to be shared (%1 MiB)").arg(size / (1024 * 1024))));
+      continue;
+    }
+    output.reset(new QSharedMemory(QString("gmic_qt_worker_%1").arg(QUuid::createUuid().toString())));
+    if (!writeImages(runner.images(), *output)) {
+      reply(out, "error " + id + " " + encode(QString("Cannot share output images: %1").arg(output->errorString())));
+      continue;
+    }
+    reply(out, "done " + id + " " + output->key().toLatin1() + " " + QByteArray::number(timer.elapsed()));
+  }
+}
+
+std::size_t WorkerProcess::sharedSize(const cimg_library::CImgList<float> & images)
+{
+  std::size_t size = 2 * sizeof(quint32) + images.size() * 4 * sizeof(qint32);
+  for (unsigned int i = 0; i < images.size(); ++i) {
+    size += images[i].size() * sizeof(float);
+  }
+  return size;
+}
+
+bool WorkerProcess::fitsInSharedMemory(std::size_t size)
+{
+  return size <= static_cast<std::size_t>(std::numeric_limits<int>::max());
+}
+
+bool WorkerProcess::writeImages(const cimg_library::CImgList<float> & images, QSharedMemory & memory)
+{
+  const std::size_t size = sharedSize(images);
+  if (!fitsInSharedMemory(size) || !memory.create(static_cast<int>(size))) {
+    return false;
+  }
+  memory.lock();
+  auto header = static_cast<quint32 *>(memory.data());
+  header[0] = SharedImagesMagic;
+  header[1] = images.size();
+  auto dimensions = reinterpret_cast<qint32 *>(header + 2);
+  auto data = reinterpret_cast<float *>(dimensions + 4 * images.size());
+  for (unsigned int i = 0; i < images.size(); ++i) {
+    const cimg_library::CImg<float> & image = images[i];
+    *dimensions++ = image.width();
+    *dimensions++ = image.height();
+    *dimensions++ = image.depth();
+    *dimensions++ = image.spectrum();
+    std::memcpy(data, image.data(), image.size() * sizeof(float));
+    data += image.size();
+  }
+  memory.unlock();
+  return true;
+}
+
+bool WorkerProcess::readImages(const QString & key, cimg_library::CImgList<float> & images)
+{
+  QSharedMemory memory(key);
+  if (!memory.attach(QSharedMemory::ReadOnly)) {
+    return false;
+  }
+  memory.lock();
+  const std::size_t size = static_cast<std::size_t>(memory.size());
+  auto header = static_cast<const quint32 *>(memory.constData());
+  // The count and dimensions are validated before being multiplied, the segment may come from anywhere
+  bool ok = (size >= 2 * sizeof(quint32)) && (header[0] == SharedImagesMagic) && (header[1] <= (size - 2 * sizeof(quint32)) / (4 * sizeof(qint32)));
+  if (ok) {
+    images.assign(header[1]);
+    auto dimensions = reinterpret_cast<const qint32 *>(header + 2);
+    auto data = reinterpret_cast<const float *>(dimensions + 4 * images.size());
+    std::size_t offset = 2 * sizeof(quint32) + images.size() * 4 * sizeof(qint32);
+    for (unsigned int i = 0; ok && (i < images.size()); ++i, dimensions += 4) {
+      std::size_t count = 0;
+      ok = imageValueCount(dimensions, (size - offset) / sizeof(float), count);
+      offset += count * sizeof(float);
+      if (ok && count) {
+        images[i].assign(data, dimensions[0], dimensions[1], dimensions[2], dimensions[3]);
+        data += count;
+      }
+    }
+  }
+  memory.unlock();
+  memory.detach();
+  if (!ok) {
+    images.assign();
+  }
+  return ok;
+}
+
+QByteArray WorkerProcess::encode(const QString & text)
+{
+  return text.isEmpty() ? QByteArray("-") : text.toUtf8().toHex();
+}
+
+QString WorkerProcess::decode(const QByteArray & hex)
+{
+  return (hex == "-") ? QString() : QString::fromUtf8(QByteArray::fromHex(hex));
+}
@@ -0,0 +1,75 @@
+/** -*- mode: c++ ; c-basic-offset: 2 -*-
+ *
+ *  @file WorkerProcess.h
+ *
+ *  Copyright 2017 Sebastien Fourey
+ *
+ *  This file is part of G'MIC-Qt, a generic plug-in for raster graphics
+ *  editors, offering hundreds of filters thanks to the underlying G'MIC
+ *  image processing framework.
+ *
+ *  gmic_qt is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  gmic_qt is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with gmic_qt.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GMIC_QT_WORKERPROCESS_H
+#define GMIC_QT_WORKERPROCESS_H
+
+#include <QByteArray>
+#include <QString>
+#include <cstddef>
+
+class QSharedMemory;
+
+namespace cimg_library
+{
+template <typename T> struct CImgList;
+} // namespace cimg_library
+
+/**
+ * @brief Entry point of a worker process (gmic_qt --worker), supervised by a WorkerPool.
+ *
+ * Workers run one job at a time, as a headless processor would, but stay alive
+ * between jobs so that the stdlib is loaded and the interpreters are set up once.
+ * Requests are read from the standard input and replies written to the standard
+ * output, one per line:
+ *
+ *   run <id> <input key> <command (hex)> <environment (hex)>
+ *       -> done <id> <output key> <duration (ms)> | error <id> <message (hex)>
+ *   release   (the output of the last job has been read)
+ *   quit
+ *
+ * Images are exchanged through shared memory segments (see writeImages()), the
+ * one holding the output of a job being kept by the worker until it is released.
+ */
+class WorkerProcess {
+public:
+  static int exec();
+
+  /**
+   * @brief Layout of the shared memory segments: image count, then the
+   *        width, height, depth and spectrum of each image, then their data.
+   */
+  static std::size_t sharedSize(const cimg_library::CImgList<float> & images);
+  static bool fitsInSharedMemory(std::size_t size); // The size of a segment is an int, hence less than 2 GiB
+  static bool writeImages(const cimg_library::CImgList<float> & images, QSharedMemory & memory); // Creates the segment
+  static bool readImages(const QString & key, cimg_library::CImgList<float> & images);           // Attaches to the segment
+
+  static QByteArray encode(const QString & text);
+  static QString decode(const QByteArray & hex);
+
+private:
+  WorkerProcess() = delete;
+};
+
+#endif // GMIC_QT_WORKERPROCESS_H
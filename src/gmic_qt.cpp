@@ -40,6 +40,7 @@
 #include "Logger.h"
 #include "MainWindow.h"
 #include "Updater.h"
+#include "Utils.h"
 #include "Widgets/InOutPanel.h"
 #include "Widgets/ProgressInfoWindow.h"
 #include "gmic.h"
@@ -115,10 +116,7 @@ int launchPlugin()
 
   QApplication app(dummy_argc, dummy_argv);
   QApplication::setWindowIcon(QIcon(":resources/gmic_hat.png"));
-  QCoreApplication::setOrganizationName(GMIC_QT_ORGANISATION_NAME);
-  QCoreApplication::setOrganizationDomain(GMIC_QT_ORGANISATION_DOMAIN);
-  QCoreApplication::setApplicationName(GMIC_QT_APPLICATION_NAME);
-  QCoreApplication::setAttribute(Qt::AA_DontUseNativeMenuBar);
+  GmicQt::setupApplication();
   DialogSettings::loadSettings(GmicQt::GuiApplication);
   LanguageSettings::installTranslators();
   TIMING;
@@ -146,10 +144,7 @@ int launchPluginHeadlessUsingLastParameters()
 #endif
   QApplication app(dummy_argc, dummy_argv);
   QApplication::setWindowIcon(QIcon(":resources/gmic_hat.png"));
-  QCoreApplication::setOrganizationName(GMIC_QT_ORGANISATION_NAME);
-  QCoreApplication::setOrganizationDomain(GMIC_QT_ORGANISATION_DOMAIN);
-  QCoreApplication::setApplicationName(GMIC_QT_APPLICATION_NAME);
-  QCoreApplication::setAttribute(Qt::AA_DontUseNativeMenuBar);
+  GmicQt::setupApplication();
 
   DialogSettings::loadSettings(GmicQt::GuiApplication);
   Logger::setMode(DialogSettings::outputMessageMode());
@@ -177,10 +172,7 @@ int launchPluginHeadless(const char * command, GmicQt::InputMode input, GmicQt::
   SetErrorMode(SEM_FAILCRITICALERRORS | SEM_NOGPFAULTERRORBOX | SEM_NOOPENFILEERRORBOX);
 #endif
   QCoreApplication app(dummy_argc, dummy_argv);
-  QCoreApplication::setOrganizationName(GMIC_QT_ORGANISATION_NAME);
-  QCoreApplication::setOrganizationDomain(GMIC_QT_ORGANISATION_DOMAIN);
-  QCoreApplication::setApplicationName(GMIC_QT_APPLICATION_NAME);
-  QCoreApplication::setAttribute(Qt::AA_DontUseNativeMenuBar);
+  GmicQt::setupApplication();
 
   DialogSettings::loadSettings(GmicQt::NonGuiApplication);
   Logger::setMode(DialogSettings::outputMessageMode());